@@ -0,0 +1,125 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Benchmark helpers
+ *
+ * @file     bench.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ *
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+// Prototypes -------------------------------------------------------------
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t nmemb, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void __wrap_free(void *ptr);
+
+// Variables --------------------------------------------------------------
+
+volatile size_t bench_sink;
+
+static bench_alloc alloc;
+static uint64_t start_ns;
+
+// Code -------------------------------------------------------------------
+
+void *__wrap_malloc(size_t size) {
+    alloc.mallocs++;
+    alloc.bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    alloc.mallocs++;
+    alloc.bytes += nmemb * size;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    alloc.reallocs++;
+    alloc.bytes += size;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr != NULL) alloc.frees++;
+    __real_free(ptr);
+}
+
+uint64_t bench_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+long bench_rss_kb(void) {
+    FILE *f;
+    long size, resident;
+
+    f = fopen("/proc/self/statm", "r");
+    if (f == NULL) return -1;
+
+    if (fscanf(f, "%ld %ld", &size, &resident) != 2) resident = 0;
+    fclose(f);
+
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+bench_alloc bench_alloc_get(void) {
+    return alloc;
+}
+
+void bench_header(char *title) {
+    printf("\n%s\n", title);
+    printf("  %-36s %12s %10s %10s\n", "Case", "ns/op", "allocs/op", "GB/s");
+}
+
+void bench_start(void) {
+    alloc.mallocs = 0;
+    alloc.reallocs = 0;
+    alloc.frees = 0;
+    alloc.bytes = 0;
+    start_ns = bench_ns();
+}
+
+static uint64_t bench_print(char *name, size_t ops, size_t bytes) {
+    uint64_t ns = bench_ns() - start_ns;
+    double per_op = ops ? (double)ns / ops : 0.0;
+    double allocs = ops ? (double)(alloc.mallocs + alloc.reallocs) / ops : 0.0;
+
+    if (bytes)
+        printf("  %-36s %12.2f %10.3f %10.3f\n", name, per_op, allocs, ns ? (double)bytes / ns : 0.0);
+    else
+        printf("  %-36s %12.2f %10.3f %10s\n", name, per_op, allocs, "-");
+
+    return ns;
+}
+
+uint64_t bench_stop(char *name, size_t ops) {
+    return bench_print(name, ops, 0);
+}
+
+uint64_t bench_stop_bytes(char *name, size_t ops, size_t bytes) {
+    return bench_print(name, ops, bytes);
+}
@@ -0,0 +1,113 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Benchmark helpers
+ *
+ * @file     bench.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Timing, allocation counting and result printing shared by all
+ * benchmarks. Allocation counters rely on the linker wrapping malloc,
+ * calloc, realloc and free (see LDFLAGS in Makefile).
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    uint64_t mallocs;   // malloc and calloc calls
+    uint64_t reallocs;  // realloc calls
+    uint64_t frees;     // free calls
+    uint64_t bytes;     // bytes requested by malloc/calloc/realloc
+} bench_alloc;
+
+// Variables --------------------------------------------------------------
+
+extern volatile size_t bench_sink;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Monotonic time.
+ * @return nanoseconds
+ */
+uint64_t bench_ns(void);
+
+/**
+ * Current resident set size.
+ * @return RSS in kB
+ */
+long bench_rss_kb(void);
+
+/**
+ * Allocation counters since last bench_start().
+ * @return counters
+ */
+bench_alloc bench_alloc_get(void);
+
+/**
+ * Print a benchmark group header.
+ * @param title group title
+ */
+void bench_header(char *title);
+
+/**
+ * Reset allocation counters and start the timer.
+ */
+void bench_start(void);
+
+/**
+ * Stop the timer and print ns/op and allocations/op.
+ * @param name name of the measured case
+ * @param ops number of operations performed
+ * @return elapsed nanoseconds
+ */
+uint64_t bench_stop(char *name, size_t ops);
+
+/**
+ * Stop the timer and print ns/op and throughput.
+ * @param name name of the measured case
+ * @param ops number of operations performed
+ * @param bytes number of bytes processed
+ * @return elapsed nanoseconds
+ */
+uint64_t bench_stop_bytes(char *name, size_t ops, size_t bytes);
+
+// Benchmarks -------------------------------------------------------------
+
+void bench_mstr_alloc(void);
+void bench_mstr_sso(void);
+void bench_mstr_growth(void);
+void bench_mstr_insert(void);
+void bench_mstr_class(void);
+void bench_mstr_strip(void);
+void bench_mstr_search(void);
+void bench_mstr_format(void);
+void bench_mstr_utf8(void);
+void bench_mview_split(void);
+void bench_marena_request(void);
+void bench_mrope_edit(void);
+void bench_mintern_tags(void);
+void bench_i2i_lookup(void);
+void bench_i2i_small(void);
+void bench_table_len(void);
+void bench_table_freeze(void);
+void bench_table_phash(void);
+void bench_table_compact(void);
+void bench_table_reverse(void);
+void bench_shared_read(void);
+void bench_table_matrix(void);
+void bench_table_file(void);
+void bench_table_batch(void);
+void bench_table_churn(void);
+
+#endif // _BENCH_H_
@@ -0,0 +1,139 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Benchmarks of bulk build and bulk lookup
+ *
+ * @file     bench_batch.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ * Tables of 256k entries, larger than the caches, built from arrays by
+ * _build() against _new() and a _setKeyValue() per element followed by
+ * _freeze(). Batches of 1k and 64k random keys, most of them present,
+ * looked up by _getValues() against a _getValue() per key on the same
+ * frozen table.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "i2i.h"
+#include "i2s.h"
+#include "s2s.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define BATCH_ENTRIES 262144
+#define BATCH_LOOKUPS 1048576  // Keys looked up per case, in batches
+#define BATCH_SMALL 1024
+#define BATCH_LARGE 65536
+
+// Prototypes -------------------------------------------------------------
+
+static void batch_i2i(void);
+static void batch_I2S(void);
+static void batch_S2S(void);
+
+// Variables --------------------------------------------------------------
+
+static int ints[BATCH_ENTRIES];
+static char strs[BATCH_ENTRIES][16];
+static char *strp[BATCH_ENTRIES];
+static int order[BATCH_LOOKUPS];  // Entry of each key looked up
+
+static int intKeys[BATCH_LARGE];
+static char *strKeys[BATCH_LARGE];
+static int intOut[BATCH_LARGE];
+static char *strOut[BATCH_LARGE];
+
+// Code -------------------------------------------------------------------
+
+// Build both ways, then lookups one at a time and in batches. KEYS and
+// OUT are the batch arrays, KEY(i) the key of entry i.
+#define BATCH_RUN(P, T, KEYS, OUT, KEY, VAL)                                              \
+    do {                                                                                  \
+        size_t sum = 0;                                                                   \
+        T *db;                                                                            \
+                                                                                          \
+        bench_start();                                                                    \
+        db = P##_new(BATCH_ENTRIES);                                                      \
+        for (int i = 0; i < BATCH_ENTRIES; i++) P##_setKeyValue(db, i, KEY(i), VAL(i));   \
+        P##_freeze(db);                                                                   \
+        bench_stop(#P "_setKeyValue + freeze", BATCH_ENTRIES);                            \
+        P##_free(db);                                                                     \
+                                                                                          \
+        bench_start();                                                                    \
+        db = P##_build(KEYS##All, VALS##P, BATCH_ENTRIES);                                \
+        bench_stop(#P "_build", BATCH_ENTRIES);                                           \
+                                                                                          \
+        for (int size = BATCH_SMALL; size <= BATCH_LARGE; size *= 64) {                   \
+            char name[64];                                                                \
+                                                                                          \
+            bench_start();                                                                \
+            for (int b = 0; b < BATCH_LOOKUPS; b += size) {                               \
+                for (int i = 0; i < size; i++) KEYS[i] = KEY(order[b + i]);               \
+                for (int i = 0; i < size; i++) OUT[i] = P##_getValue(db, KEYS[i]);        \
+                sum += (size_t)OUT[size - 1];                                             \
+            }                                                                             \
+            snprintf(name, sizeof(name), "%s_getValue x %dk", #P, size / 1024);           \
+            bench_stop(name, BATCH_LOOKUPS);                                              \
+                                                                                          \
+            bench_start();                                                                \
+            for (int b = 0; b < BATCH_LOOKUPS; b += size) {                               \
+                for (int i = 0; i < size; i++) KEYS[i] = KEY(order[b + i]);               \
+                sum += (size_t)P##_getValues(db, KEYS, size, OUT);                        \
+            }                                                                             \
+            snprintf(name, sizeof(name), "%s_getValues %dk", #P, size / 1024);            \
+            bench_stop(name, BATCH_LOOKUPS);                                              \
+        }                                                                                 \
+                                                                                          \
+        bench_sink += sum;                                                                \
+        P##_free(db);                                                                     \
+    } while (0)
+
+#define INT_KEY(i) ints[i]
+#define STR_KEY(i) strp[i]
+#define intKeysAll ints
+#define strKeysAll strp
+#define VALSi2i ints
+#define VALSI2S strp
+#define VALSS2S strp
+
+static void batch_i2i(void) {
+    BATCH_RUN(i2i, i2i, intKeys, intOut, INT_KEY, INT_KEY);
+}
+
+static void batch_I2S(void) {
+    BATCH_RUN(I2S, I2S, intKeys, strOut, INT_KEY, STR_KEY);
+}
+
+static void batch_S2S(void) {
+    BATCH_RUN(S2S, S2S, strKeys, strOut, STR_KEY, STR_KEY);
+}
+
+void bench_table_batch(void) {
+    uint32_t r = 1;
+
+    bench_header("Bulk build and lookup, 256k entries, 1k and 64k key batches");
+
+    // Keys in random order, so neither build nor lookup sees them sorted
+    for (int i = 0; i < BATCH_ENTRIES; i++) {
+        ints[i] = (int)((uint32_t)i * 2654435761u >> 1);
+        snprintf(strs[i], sizeof(strs[i]), "k%08x", (unsigned int)ints[i]);
+        strp[i] = strs[i];
+    }
+    for (int i = 0; i < BATCH_LOOKUPS; i++) {
+        r = r * 1664525u + 1013904223u;
+        order[i] = (int)(r >> 14) % BATCH_ENTRIES;
+    }
+
+    batch_i2i();
+    batch_I2S();
+    batch_S2S();
+}
@@ -0,0 +1,148 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Soak benchmark of tables with churn
+ *
+ * @file     bench_churn.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * A table of 4k live entries where a key is retired and a new one
+ * appended again and again, like a daemon's session table. Retiring by
+ * overwriting the key with a dummy, the way it was done before removal
+ * existed, leaves the table to grow and scans to slow down with every
+ * round. i2i_removeKey() and S2S_removeKey() compact the table as they
+ * go, so lookups cost the same round after round.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "i2i.h"
+#include "s2s.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define CHURN_LIVE 4096
+#define CHURN_ROUND 4096      // Retirements per round
+#define CHURN_ROUNDS 4
+#define CHURN_LOOKUPS 2000    // Lookups measured after each round
+#define CHURN_DUMMY -2        // Key of retired i2i entries
+#define CHURN_DUMMY_S "-"     // Key of retired S2S entries
+
+// Prototypes -------------------------------------------------------------
+
+static char *churn_name(int key);
+static void churn_i2i(bool remove);
+static void churn_S2S(bool remove);
+
+// Variables --------------------------------------------------------------
+
+static int live[CHURN_LIVE];  // Keys live in the table
+static char name[32];
+
+// Code -------------------------------------------------------------------
+
+static char *churn_name(int key) {
+    snprintf(name, sizeof(name), "session-%08d", key);
+    return name;
+}
+
+static void churn_i2i(bool remove) {
+    char label[64];
+    uint32_t r = 7;
+    size_t sum = 0;
+    int next = 0;
+    i2i *db = i2i_new(0);
+    int j;
+
+    for (int i = 0; i < CHURN_LIVE; i++) {
+        live[i] = next++;
+        db = i2i_append(db, live[i], live[i]);
+    }
+
+    for (int round = 1; round <= CHURN_ROUNDS; round++) {
+        bench_start();
+        for (int i = 0; i < CHURN_ROUND; i++) {
+            r = r * 1664525u + 1013904223u;
+            j = (int)(r >> 8) % CHURN_LIVE;
+            if (remove) {
+                i2i_removeKey(db, live[j]);
+            } else {
+                i2i_setKeyValue(db, i2i_findKey(db, live[j]), CHURN_DUMMY, 0);
+            }
+            live[j] = next++;
+            db = i2i_append(db, live[j], live[j]);
+        }
+        snprintf(label, sizeof(label), "i2i %s round %d", remove ? "removeKey" : "dummy key", round);
+        bench_stop(label, CHURN_ROUND);
+
+        bench_start();
+        for (int i = 0; i < CHURN_LOOKUPS; i++) {
+            sum += (size_t)i2i_findKey(db, live[(i * 7919) % CHURN_LIVE]);
+        }
+        snprintf(label, sizeof(label), "  findKey, %d entries", i2i_len(db));
+        bench_stop(label, CHURN_LOOKUPS);
+    }
+
+    bench_sink += sum;
+    i2i_free(db);
+}
+
+static void churn_S2S(bool remove) {
+    char label[64];
+    uint32_t r = 7;
+    size_t sum = 0;
+    int next = 0;
+    S2S *db = S2S_new(0);
+    int j;
+
+    for (int i = 0; i < CHURN_LIVE; i++) {
+        live[i] = next++;
+        db = S2S_append(db, churn_name(live[i]), name);
+    }
+
+    for (int round = 1; round <= CHURN_ROUNDS; round++) {
+        bench_start();
+        for (int i = 0; i < CHURN_ROUND; i++) {
+            r = r * 1664525u + 1013904223u;
+            j = (int)(r >> 8) % CHURN_LIVE;
+            if (remove) {
+                S2S_removeKey(db, churn_name(live[j]));
+            } else {
+                S2S_setKeyValue(db, S2S_findKey(db, churn_name(live[j])), CHURN_DUMMY_S, "");
+            }
+            live[j] = next++;
+            db = S2S_append(db, churn_name(live[j]), name);
+        }
+        snprintf(label, sizeof(label), "S2S %s round %d", remove ? "removeKey" : "dummy key", round);
+        bench_stop(label, CHURN_ROUND);
+
+        bench_start();
+        for (int i = 0; i < CHURN_LOOKUPS; i++) {
+            sum += (size_t)S2S_findKey(db, churn_name(live[(i * 7919) % CHURN_LIVE]));
+        }
+        snprintf(label, sizeof(label), "  findKey, %d entries", S2S_len(db));
+        bench_stop(label, CHURN_LOOKUPS);
+    }
+
+    bench_sink += sum;
+    S2S_free(db);
+}
+
+void bench_table_churn(void) {
+    bench_header("Churn soak, 4k live entries, 4k retirements per round");
+
+    churn_i2i(false);
+    churn_i2i(true);
+    churn_S2S(false);
+    churn_S2S(true);
+}
@@ -0,0 +1,145 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Benchmarks of memory mapped table files
+ *
+ * @file     bench_dbfile.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Startup of a 100k entry S2S table the way a daemon loads it from a
+ * text file, a line at a time into S2S_setKeyValue(), against mapping
+ * the same table written by dbfile_writeS2S(). Lookups in the mapped
+ * file against a frozen S2S table in memory.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "def.h"
+#include "s2s.h"
+#include "dbinfo.h"
+#include "dbfile.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define FILE_ENTRIES 100000
+#define FILE_LOADS 5           // Startups timed
+#define FILE_LOOKUPS 1000000   // Lookups per case
+
+// Prototypes -------------------------------------------------------------
+
+static S2S *file_load(const char *path);
+
+// Variables --------------------------------------------------------------
+
+static char keys[FILE_ENTRIES][16];
+
+// Code -------------------------------------------------------------------
+
+// Text table, one "key value" per line
+static S2S *file_load(const char *path) {
+    char line[128];
+    char *value;
+    S2S *db;
+    FILE *fp;
+    int i = 0;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) return NULL;
+
+    db = S2S_new(FILE_ENTRIES);
+    while ((i < FILE_ENTRIES) && (fgets(line, sizeof(line), fp) != NULL)) {
+        line[strcspn(line, "\n")] = '\0';
+        value = strchr(line, ' ');
+        if (value == NULL) continue;
+        *value++ = '\0';
+        S2S_setKeyValue(db, i++, line, value);
+    }
+    fclose(fp);
+
+    return db;
+}
+
+void bench_table_file(void) {
+    char text[64];
+    char path[64];
+    size_t sum = 0;
+    dbfile *f = NULL;
+    S2S *db = NULL;
+    FILE *fp;
+
+    bench_header("Table file, 100k entry S2S, text load vs mapped file");
+
+    snprintf(text, sizeof(text), "/tmp/defbench-%d.txt", (int)getpid());
+    snprintf(path, sizeof(path), "/tmp/defbench-%d.db", (int)getpid());
+
+    fp = fopen(text, "w");
+    for (int i = 0; i < FILE_ENTRIES; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "key%d", i);
+        fprintf(fp, "%s value%d\n", keys[i], i % 5000);
+    }
+    fclose(fp);
+
+    bench_start();
+    for (int l = 0; l < FILE_LOADS; l++) {
+        if (db != NULL) S2S_free(db);
+        db = file_load(text);
+    }
+    bench_stop("text load + S2S_setKeyValue", FILE_LOADS);
+
+    bench_start();
+    S2S_freeze(db);
+    bench_stop("S2S_freeze", 1);
+
+    bench_start();
+    dbfile_writeS2S(path, db);
+    bench_stop("dbfile_writeS2S", 1);
+
+    bench_start();
+    for (int l = 0; l < FILE_LOADS; l++) {
+        dbfile_close(f);
+        f = dbfile_open(path);
+    }
+    bench_stop("dbfile_open", FILE_LOADS);
+
+    // First lookups fault in the pages they touch
+    bench_start();
+    for (int i = 0; i < 1000; i++) {
+        sum += (size_t)dbfile_getS2S(f, keys[(i * 7919) % FILE_ENTRIES]);
+    }
+    bench_stop("dbfile_getS2S first 1k", 1000);
+
+    bench_start();
+    for (size_t i = 0; i < FILE_LOOKUPS; i++) {
+        sum += (size_t)S2S_getValue(db, keys[(i * 7919) % FILE_ENTRIES]);
+    }
+    bench_stop("S2S_getValue frozen", FILE_LOOKUPS);
+
+    bench_start();
+    for (size_t i = 0; i < FILE_LOOKUPS; i++) {
+        sum += (size_t)dbfile_getS2S(f, keys[(i * 7919) % FILE_ENTRIES]);
+    }
+    bench_stop("dbfile_getS2S", FILE_LOOKUPS);
+
+    bench_start();
+    for (size_t i = 0; i < FILE_LOOKUPS; i++) sum += (size_t)dbfile_getS2S(f, "missing");
+    bench_stop("dbfile_getS2S missing", FILE_LOOKUPS);
+
+    printf("  %-36s %12zu kB\n", "S2S memory", (size_t)dbinfo_get(db)->capacity * sizeof(S2S) / 1024);
+    printf("  %-36s %12zu kB\n", "table file, shared", f->size / 1024);
+
+    bench_sink += sum;
+    dbfile_close(f);
+    S2S_free(db);
+    unlink(text);
+    unlink(path);
+}
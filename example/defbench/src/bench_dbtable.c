@@ -0,0 +1,220 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Benchmarks of table types generated from dbtable.h
+ *
+ * @file     bench_dbtable.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * The same operations on tables of 1k entries for each key/value type:
+ * the library's i2i, I2S and S2S plus u2d (64 bit key to double) and
+ * s2i (string key to int) generated here. A scan through a comparison
+ * callback, the way a table written once for void pointers would have
+ * to do it, shows what the inlined comparisons are worth.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "i2i.h"
+#include "i2s.h"
+#include "s2s.h"
+#include "dbinfo.h"
+#include "dbvalue.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define MATRIX_ENTRIES 1000
+#define MATRIX_BUILDS 200      // Tables built by append
+#define MATRIX_LOOKUPS 200000  // Lookups per operation
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    uint64_t key;
+    double value;
+} u2d;
+
+typedef struct {
+    char key[S2S_STRLEN];
+    int value;
+} s2i;
+
+// Prototypes -------------------------------------------------------------
+
+static int matrix_callbackFind(void *db, size_t size, const void *key, int (*cmp)(const void *, const void *));
+static int matrix_intCmp(const void *a, const void *b);
+static void matrix_i2i(void);
+static void matrix_I2S(void);
+static void matrix_S2S(void);
+static void matrix_u2d(void);
+static void matrix_s2i(void);
+
+// Variables --------------------------------------------------------------
+
+static char names[MATRIX_ENTRIES][16];
+
+// Code -------------------------------------------------------------------
+
+#define U2D_LAST UINT64_MAX
+
+#define DBT_SCOPE static __attribute__((unused))
+#define DBT_PREFIX u2d
+#define DBT_TYPE u2d
+#define DBT_KEY uint64_t
+#define DBT_VAL double
+#define DBT_GET double
+#define DBT_NONE 0.0
+#define DBT_IS_LAST(e) ((e)->key == U2D_LAST)
+#define DBT_SET_LAST(e) ((e)->key = U2D_LAST)
+#define DBT_KEY_EQ(e, k) ((e)->key == (k))
+#define DBT_VAL_EQ(e, v) ((e)->value == (v))
+#define DBT_KEY_SET(e, k) ((e)->key = (k))
+#define DBT_VAL_SET(e, v) ((e)->value = (v))
+#define DBT_VAL_HASH(v) dbvalue_hash((const char *)&(v), sizeof(double))
+#define DBT_PRINT(e) printf("%20lu   %f\n", (unsigned long)(e)->key, (e)->value)
+#include "dbtable.h"
+
+#define DBT_SCOPE static __attribute__((unused))
+#define DBT_PREFIX s2i
+#define DBT_TYPE s2i
+#define DBT_KEY const char *
+#define DBT_VAL int
+#define DBT_GET int
+#define DBT_NONE 0
+#define DBT_IS_LAST(e) !strncmp((e)->key, S2S_LAST, 6)
+#define DBT_SET_LAST(e) strcpy((e)->key, S2S_LAST)
+#define DBT_KEY_EQ(e, k) !strncmp((e)->key, (k), S2S_STRLEN)
+#define DBT_VAL_EQ(e, v) ((e)->value == (v))
+#define DBT_KEY_SET(e, k) (strncpy((e)->key, (k), S2S_STRLEN - 1), (e)->key[S2S_STRLEN - 1] = '\0')
+#define DBT_VAL_SET(e, v) ((e)->value = (v))
+#define DBT_VAL_HASH(v) dbvalue_hashInt(v)
+#define DBT_PRINT(e) printf("%20s   %d\n", (e)->key, (e)->value)
+#include "dbtable.h"
+
+// Linear search of a table of any type, one call per comparison
+static int matrix_callbackFind(void *db, size_t size, const void *key, int (*cmp)(const void *, const void *)) {
+    char *e = db;
+
+    for (int i = 0; i < MATRIX_ENTRIES; i++, e += size) {
+        if (!cmp(e, key)) return i;
+    }
+    return -1;
+}
+
+static int matrix_intCmp(const void *a, const void *b) {
+    return *(const int *)a != *(const int *)b;
+}
+
+// Build, key lookups, value lookups by scan and by index and a lookup
+// of a missing key, for one table type. KEY(i) and VAL(i) give the
+// key and value of entry i, MISS a key not in the table.
+#define MATRIX_RUN(P, T, KEY, VAL, MISS)                                              \
+    do {                                                                              \
+        size_t sum = 0;                                                               \
+        T *db = NULL;                                                                 \
+                                                                                      \
+        bench_start();                                                                \
+        for (int b = 0; b < MATRIX_BUILDS; b++) {                                     \
+            if (db != NULL) P##_free(db);                                             \
+            db = P##_new(0);                                                          \
+            for (int i = 0; i < MATRIX_ENTRIES; i++) db = P##_append(db, KEY(i), VAL(i)); \
+        }                                                                             \
+        bench_stop(#P "_append", (size_t)MATRIX_BUILDS * MATRIX_ENTRIES);             \
+                                                                                      \
+        bench_start();                                                                \
+        for (size_t i = 0; i < MATRIX_LOOKUPS; i++) {                                 \
+            sum += (size_t)P##_findKey(db, KEY((i * 7919) % MATRIX_ENTRIES));         \
+        }                                                                             \
+        bench_stop(#P "_findKey", MATRIX_LOOKUPS);                                    \
+                                                                                      \
+        bench_start();                                                                \
+        for (size_t i = 0; i < MATRIX_LOOKUPS; i++) sum += (size_t)P##_findKey(db, MISS); \
+        bench_stop(#P "_findKey missing", MATRIX_LOOKUPS);                            \
+                                                                                      \
+        bench_start();                                                                \
+        for (size_t i = 0; i < MATRIX_LOOKUPS; i++) {                                 \
+            sum += (size_t)P##_findValue(db, VAL((i * 7919) % MATRIX_ENTRIES));       \
+        }                                                                             \
+        bench_stop(#P "_findValue scan", MATRIX_LOOKUPS);                             \
+                                                                                      \
+        P##_indexValues(db);                                                          \
+        bench_start();                                                                \
+        for (size_t i = 0; i < MATRIX_LOOKUPS; i++) {                                 \
+            sum += (size_t)P##_findValue(db, VAL((i * 7919) % MATRIX_ENTRIES));       \
+        }                                                                             \
+        bench_stop(#P "_findValue indexed", MATRIX_LOOKUPS);                          \
+                                                                                      \
+        bench_sink += sum;                                                            \
+        P##_free(db);                                                                 \
+    } while (0)
+
+#define INT_KEY(i) ((int)(i))
+#define INT_VAL(i) ((int)(i) * 3)
+#define NAME(i) names[i]
+#define U64_KEY(i) ((uint64_t)(i) << 33)
+#define DBL_VAL(i) ((double)(i) / 8)
+
+static void matrix_i2i(void) {
+    MATRIX_RUN(i2i, i2i, INT_KEY, INT_VAL, -5);
+}
+
+static void matrix_I2S(void) {
+    MATRIX_RUN(I2S, I2S, INT_KEY, NAME, -5);
+}
+
+static void matrix_S2S(void) {
+    MATRIX_RUN(S2S, S2S, NAME, NAME, "missing");
+}
+
+static void matrix_u2d(void) {
+    MATRIX_RUN(u2d, u2d, U64_KEY, DBL_VAL, 5);
+}
+
+static void matrix_s2i(void) {
+    MATRIX_RUN(s2i, s2i, NAME, INT_VAL, "missing");
+}
+
+void bench_table_matrix(void) {
+    // Called through a pointer the compiler can not see through, as it
+    // would be from a library compiled on its own
+    int (*volatile cmp)(const void *, const void *) = matrix_intCmp;
+    size_t sum = 0;
+    i2i *db;
+    int key;
+
+    bench_header("Tables from dbtable.h, 1k entries, key/value type matrix");
+
+    for (int i = 0; i < MATRIX_ENTRIES; i++) {
+        snprintf(names[i], sizeof(names[i]), "name%d", i);
+    }
+
+    matrix_i2i();
+    matrix_I2S();
+    matrix_S2S();
+    matrix_u2d();
+    matrix_s2i();
+
+    db = i2i_new(MATRIX_ENTRIES);
+    for (int i = 0; i < MATRIX_ENTRIES; i++) i2i_setKeyValue(db, i, i, i);
+
+    bench_start();
+    for (size_t i = 0; i < MATRIX_LOOKUPS; i++) {
+        key = (int)((i * 7919) % MATRIX_ENTRIES);
+        sum += (size_t)matrix_callbackFind(db, sizeof(i2i), &key, cmp);
+    }
+    bench_stop("i2i find by callback", MATRIX_LOOKUPS);
+
+    bench_sink += sum;
+    i2i_free(db);
+}
@@ -0,0 +1,159 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    i2i benchmarks
+ *
+ * @file     bench_i2i.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * id -> slot maps of 10 to 1M entries with scattered ids, looked up in
+ * random order through i2i_findKey() and through an i2i_index. The scan
+ * is given a fixed budget of compared entries per size so the large
+ * tables finish in reasonable time.
+ *
+ * Small i2i and I2S tables of 8, 32 and 128 entries, scanned as they
+ * are and frozen, with each implementation of the packed key scan.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "def.h"
+#include "i2i.h"
+#include "i2i_index.h"
+#include "i2s.h"
+#include "dbkeys.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define I2I_LOOKUPS 2000000
+#define I2I_SCAN_BUDGET 400000000ull  // Entries compared by the scan per size
+#define I2I_SMALL_LOOKUPS 10000000
+#define I2I_QUERIES 4096              // Keys looked up, a power of 2
+
+// Code -------------------------------------------------------------------
+
+static I2I_KEY i2i_id(int i) {
+    return (I2I_KEY)((uint32_t)i * 2654435761u + 12345u);
+}
+
+void bench_i2i_lookup(void) {
+    static const int sizes[] = {10, 100, 1000, 10000, 100000, 1000000};
+    char name[64];
+    uint64_t ns_scan, ns_index;
+    i2i_index *ix;
+    size_t sum;
+    size_t n;
+    i2i *db;
+
+    bench_header("i2i lookup, random hits, scan vs hash index");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        n = (size_t)sizes[s];
+        db = i2i_new((int)n);
+        for (size_t i = 0; i < n; i++) {
+            db[i].key = i2i_id((int)i);
+            db[i].value = (int)i;
+        }
+
+        size_t scans = I2I_SCAN_BUDGET / n;
+        if (scans > I2I_LOOKUPS) scans = I2I_LOOKUPS;
+
+        snprintf(name, sizeof(name), "i2i_findKey n=%zu", n);
+        sum = 0;
+        bench_start();
+        for (size_t i = 0; i < scans; i++) {
+            sum += (size_t)i2i_findKey(db, i2i_id((int)((i * 7919) % n)));
+        }
+        ns_scan = bench_stop(name, scans);
+        bench_sink += sum;
+
+        snprintf(name, sizeof(name), "i2i_index build n=%zu", n);
+        bench_start();
+        ix = i2i_index_new(db);
+        bench_stop(name, n);
+
+        snprintf(name, sizeof(name), "i2i_index_findKey n=%zu", n);
+        sum = 0;
+        bench_start();
+        for (size_t i = 0; i < I2I_LOOKUPS; i++) {
+            sum += (size_t)i2i_index_findKey(ix, i2i_id((int)((i * 7919) % n)));
+        }
+        ns_index = bench_stop(name, I2I_LOOKUPS);
+        bench_sink += sum;
+
+        printf("  %-36s %12.2f M/s scan %10.2f M/s index\n", "lookups",
+               scans * 1e3 / ns_scan, I2I_LOOKUPS * 1e3 / ns_index);
+
+        i2i_index_free(ix);
+        i2i_free(db);
+    }
+}
+
+void bench_i2i_small(void) {
+    static const int sizes[] = {8, 32, 128};
+    static const char *levels[] = {"scalar", "sse2", "avx2"};
+    static I2I_KEY queries[I2I_QUERIES];
+    int level = dbkeys_simd_level();
+    char name[64];
+    size_t sum = 0;
+    size_t n;
+    I2S *is;
+    i2i *db;
+
+    bench_header("i2i/I2S findKey, small tables, scan vs frozen packed keys");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        n = (size_t)sizes[s];
+        db = i2i_new((int)n);
+        is = I2S_new((int)n);
+        for (size_t i = 0; i < n; i++) {
+            i2i_setKeyValue(db, (int)i, i2i_id((int)i), (int)i);
+            I2S_setKeyValue(is, (int)i, i2i_id((int)i), "value");
+        }
+        for (size_t i = 0; i < I2I_QUERIES; i++) {
+            queries[i] = i2i_id((int)((i * 7919) % n));
+        }
+
+        snprintf(name, sizeof(name), "i2i_findKey n=%zu", n);
+        bench_start();
+        for (size_t i = 0; i < I2I_SMALL_LOOKUPS; i++) sum += (size_t)i2i_findKey(db, queries[i % I2I_QUERIES]);
+        bench_stop(name, I2I_SMALL_LOOKUPS);
+
+        snprintf(name, sizeof(name), "I2S_findKey n=%zu", n);
+        bench_start();
+        for (size_t i = 0; i < I2I_SMALL_LOOKUPS; i++) sum += (size_t)I2S_findKey(is, queries[i % I2I_QUERIES]);
+        bench_stop(name, I2I_SMALL_LOOKUPS);
+
+        i2i_freeze(db);
+        I2S_freeze(is);
+        for (int l = DBKEYS_SIMD_SCALAR; l <= DBKEYS_SIMD_AVX2; l++) {
+            if (dbkeys_simd_set(l) != l) continue;
+
+            snprintf(name, sizeof(name), "i2i frozen %s n=%zu%s", levels[l], n, (n > DBKEYS_PACKED) ? " sorted" : "");
+            bench_start();
+            for (size_t i = 0; i < I2I_SMALL_LOOKUPS; i++) sum += (size_t)i2i_findKey(db, queries[i % I2I_QUERIES]);
+            bench_stop(name, I2I_SMALL_LOOKUPS);
+
+            snprintf(name, sizeof(name), "I2S frozen %s n=%zu%s", levels[l], n, (n > DBKEYS_PACKED) ? " sorted" : "");
+            bench_start();
+            for (size_t i = 0; i < I2I_SMALL_LOOKUPS; i++) sum += (size_t)I2S_findKey(is, queries[i % I2I_QUERIES]);
+            bench_stop(name, I2I_SMALL_LOOKUPS);
+
+            // Sorted keys do not depend on the scan
+            if (n > DBKEYS_PACKED) break;
+        }
+        dbkeys_simd_set(level);
+
+        i2i_free(db);
+        I2S_free(is);
+    }
+    bench_sink += sum;
+}
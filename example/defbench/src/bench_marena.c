@@ -0,0 +1,68 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    marena benchmarks
+ *
+ * @file     bench_marena.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Simulates a request handler that builds a few hundred strings and drops
+ * them all when the request is done, with the strings on the heap and in
+ * an arena that is reset per request.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+
+#include "def.h"
+#include "mstr.h"
+#include "marena.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define REQUESTS 20000
+#define REQUEST_STRINGS 300
+
+// Code -------------------------------------------------------------------
+
+static void build_request(mstr **strs, marena *a) {
+    for (int i = 0; i < REQUEST_STRINGS; i++) {
+        mstr *s = (a != NULL) ? mstr_new_a(a, 0, "X-Header-") : mstr_new("X-Header-");
+
+        mstr_append(s, "Content-Type: ");
+        if (i & 1) mstr_append(s, "application/json; charset=utf-8, with some padding to grow");
+        mstr_append(s, "\r\n");
+        bench_sink += s->len;
+        strs[i] = s;
+    }
+}
+
+void bench_marena_request(void) {
+    mstr *strs[REQUEST_STRINGS];
+    marena *a = marena_new(0);
+
+    bench_header("marena, request with 300 strings");
+
+    bench_start();
+    for (int r = 0; r < REQUESTS; r++) {
+        build_request(strs, NULL);
+        for (int i = 0; i < REQUEST_STRINGS; i++) mstr_free(strs[i]);
+    }
+    bench_stop("heap mstr_new + mstr_free", REQUESTS);
+
+    bench_start();
+    for (int r = 0; r < REQUESTS; r++) {
+        build_request(strs, a);
+        marena_reset(a);
+    }
+    bench_stop("arena mstr_new_a + reset", REQUESTS);
+
+    marena_free(a);
+}
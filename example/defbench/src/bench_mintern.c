@@ -0,0 +1,112 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    mintern benchmarks
+ *
+ * @file     bench_mintern.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Telemetry tags, 4000 distinct strings repeated over 4M records. Each
+ * record keeps its tag either as an own mstr copy or as an interned
+ * pointer, then the records are grouped by comparing tags.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "mstr.h"
+#include "mintern.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define TAG_DISTINCT 4000
+#define TAG_RECORDS 4000000
+#define TAG_THREADS 4
+
+// Variables --------------------------------------------------------------
+
+static char tag_names[TAG_DISTINCT][48];
+
+// Code -------------------------------------------------------------------
+
+static void tag_init(void) {
+    for (int i = 0; i < TAG_DISTINCT; i++) {
+        snprintf(tag_names[i], sizeof(tag_names[i]), "service=checkout,region=eu-%d,pod=%d", i % 7, i);
+    }
+}
+
+static const char *tag_of(int i) {
+    return tag_names[(i * 2654435761u) % TAG_DISTINCT];
+}
+
+static void *tag_thread(void *arg) {
+    mintern_pool *p = (mintern_pool *)arg;
+
+    for (int i = 0; i < TAG_RECORDS / TAG_THREADS; i++) bench_sink += (size_t)mintern_c(p, tag_of(i));
+    return NULL;
+}
+
+void bench_mintern_tags(void) {
+    mstr **copies = (mstr **)malloc(TAG_RECORDS * sizeof(mstr *));
+    const char **interned = (const char **)malloc(TAG_RECORDS * sizeof(char *));
+    pthread_t threads[TAG_THREADS];
+    mintern_pool *p;
+    mintern_stats st;
+    long rss;
+    size_t same;
+
+    tag_init();
+    bench_header("mintern, 4M records with 4000 distinct tags");
+
+    rss = bench_rss_kb();
+    bench_start();
+    for (int i = 0; i < TAG_RECORDS; i++) copies[i] = mstr_newc((char *)tag_of(i));
+    bench_stop("mstr copy per record", TAG_RECORDS);
+    printf("  %ld kB RSS\n", bench_rss_kb() - rss);
+
+    bench_start();
+    same = 0;
+    for (int i = 1; i < TAG_RECORDS; i++) same += !strcmp(copies[i]->str, copies[0]->str);
+    bench_stop("strcmp group", TAG_RECORDS);
+    bench_sink += same;
+
+    for (int i = 0; i < TAG_RECORDS; i++) mstr_free(copies[i]);
+
+    p = mintern_new();
+    rss = bench_rss_kb();
+    bench_start();
+    for (int i = 0; i < TAG_RECORDS; i++) interned[i] = mintern_c(p, tag_of(i));
+    bench_stop("mintern per record", TAG_RECORDS);
+    printf("  %ld kB RSS\n", bench_rss_kb() - rss);
+
+    bench_start();
+    same = 0;
+    for (int i = 1; i < TAG_RECORDS; i++) same += (interned[i] == interned[0]);
+    bench_stop("pointer group", TAG_RECORDS);
+    bench_sink += same;
+
+    mintern_get_stats(p, &st);
+    printf("  %lu strings, hit rate %.4f, %lu bytes stored, %lu bytes saved\n",
+           (unsigned long)st.strings, (double)st.hits / st.lookups,
+           (unsigned long)st.bytes, (unsigned long)st.bytes_saved);
+
+    // Concurrent lookups of strings already interned, shared lock only
+    bench_start();
+    for (int i = 0; i < TAG_THREADS; i++) pthread_create(&threads[i], NULL, tag_thread, p);
+    for (int i = 0; i < TAG_THREADS; i++) pthread_join(threads[i], NULL);
+    bench_stop("mintern, 4 threads", TAG_RECORDS);
+
+    mintern_free(p);
+    free(interned);
+    free(copies);
+}
@@ -0,0 +1,102 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    mrope benchmarks
+ *
+ * @file     bench_mrope.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Random inserts and deletes of short snippets in a 10 MB document. mstr
+ * and mgap move megabytes per edit so they only run a fraction of the
+ * edits, compare ns/op.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "mstr.h"
+#include "mgap.h"
+#include "mrope.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define ROPE_BYTES (10 * 1024 * 1024)
+#define ROPE_EDITS 100000
+#define ROPE_SLOW_EDITS 2000
+
+// Code -------------------------------------------------------------------
+
+static mstr *rope_text(void) {
+    mstr *s = mstr_newl(ROPE_BYTES);
+
+    while (s->len < ROPE_BYTES) mstr_append(s, "option.value = 42 # generated config line\n");
+    return s;
+}
+
+static size_t rope_pos(size_t len) {
+    return (((size_t)rand() << 16) ^ (size_t)rand()) % (len + 1);
+}
+
+void bench_mrope_edit(void) {
+    char *snippet = "inserted = 1;\n";
+    size_t snippet_len = strlen(snippet);
+    mstr *text = rope_text();
+    mstr *s;
+    mgap *g;
+    mrope *r;
+    struct iovec iov[64];
+    size_t pos, n;
+
+    bench_header("mrope, random edits in 10 MB");
+
+    s = mstr_news(text);
+    srand(1);
+    bench_start();
+    for (int i = 0; i < ROPE_SLOW_EDITS; i++) mstr_insert_g(s, snippet, snippet_len, rope_pos(s->len));
+    bench_stop("mstr_insert", ROPE_SLOW_EDITS);
+    mstr_free(s);
+
+    g = mgap_news(text);
+    srand(1);
+    bench_start();
+    for (int i = 0; i < ROPE_SLOW_EDITS; i++) mgap_insert(g, snippet, snippet_len, rope_pos(mgap_len(g)));
+    bench_stop("mgap_insert", ROPE_SLOW_EDITS);
+    mgap_free(g);
+
+    bench_start();
+    r = mrope_news(text);
+    bench_stop_bytes("mrope_news", 1, text->len);
+
+    srand(1);
+    bench_start();
+    for (int i = 0; i < ROPE_EDITS; i++) mrope_insert(r, snippet, snippet_len, rope_pos(mrope_len(r)));
+    bench_stop("mrope_insert", ROPE_EDITS);
+
+    srand(2);
+    bench_start();
+    for (int i = 0; i < ROPE_EDITS; i++) mrope_delete(r, rope_pos(mrope_len(r)), snippet_len);
+    bench_stop("mrope_delete", ROPE_EDITS);
+
+    bench_start();
+    pos = 0;
+    while ((n = mrope_iovec(r, &pos, iov, 64)) > 0) bench_sink += n;
+    bench_stop_bytes("mrope_iovec walk", 1, mrope_len(r));
+
+    bench_start();
+    s = mrope_to_mstr(r);
+    bench_stop_bytes("mrope_to_mstr", 1, s->len);
+    printf("  %lu bytes in rope\n", (unsigned long)s->len);
+
+    mstr_free(s);
+    mrope_free(r);
+    mstr_free(text);
+}
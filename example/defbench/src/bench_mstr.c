@@ -0,0 +1,577 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    mstr benchmarks
+ *
+ * @file     bench_mstr.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ *
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "mstr.h"
+#include "mgap.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define ALLOC_LOOPS 1000000
+#define SSO_STRINGS 10000000
+#define GROWTH_BYTES 1000000
+#define INSERT_LOOPS 1000
+#define CLASS_BYTES (256 * 1024 * 1024)
+#define STRIP_LOOPS 100000
+#define SEARCH_BYTES (4 * 1024 * 1024)
+#define SEARCH_LOOPS 20
+#define FORMAT_LINES 1000000
+#define UTF8_BYTES (32 * 1024 * 1024)
+#define UTF8_LOOPS 4
+
+// Typedefs ---------------------------------------------------------------
+
+// Layout of mstr before the header and the characters were merged into one
+// allocation, kept here as reference.
+typedef struct {
+    char *str;
+    size_t capacity;
+    size_t len;
+} legacy_mstr;
+
+// Code -------------------------------------------------------------------
+
+static void legacy_reserve(legacy_mstr *s, size_t required) {
+    size_t capacity = ((required / MSTR_BLOCK) + 1) * MSTR_BLOCK;
+    char *str;
+
+    if ((capacity - required) <= MSTR_EXTRA) capacity += MSTR_BLOCK;
+    if (capacity <= s->capacity) return;
+
+    str = malloc(capacity);
+    if (s->str != NULL) {
+        memcpy(str, s->str, s->len + 1);
+        free(s->str);
+    }
+    s->str = str;
+    s->capacity = capacity;
+}
+
+static void legacy_append(legacy_mstr *s, char *src) {
+    size_t len = strlen(src);
+
+    legacy_reserve(s, s->len + len);
+    memcpy(s->str + s->len, src, len + 1);
+    s->len += len;
+}
+
+// Byte by byte move and copy, as mstr_insert_g() did before using memmove
+static void legacy_insert(legacy_mstr *s, char *src, size_t len, size_t pos) {
+    legacy_reserve(s, s->len + len);
+    for (size_t i = s->len; i-- > pos;) s->str[i + len] = s->str[i];
+    for (size_t i = 0; i < len; i++) s->str[pos + i] = src[i];
+    s->len += len;
+    s->str[s->len] = '\0';
+}
+
+// Strip of leading characters as done before character sets were added
+static bool legacy_instr(char ch, char *str) {
+    for (size_t i = 0; i < strlen(str); i++) {
+        if (ch == str[i]) return true;
+    }
+    return false;
+}
+
+static void legacy_strip(legacy_mstr *s, char *st) {
+    size_t anchor = 0;
+
+    for (size_t i = 0; i < s->len; i++) {
+        if (legacy_instr(s->str[i], st))
+            anchor++;
+        else
+            break;
+    }
+    for (size_t i = 0; i + anchor <= s->len; i++) s->str[i] = s->str[i + anchor];
+    s->len -= anchor;
+
+    for (int i = s->len - 1; i > 0; i--) {
+        if (legacy_instr(s->str[i], st))
+            s->len--;
+        else
+            break;
+    }
+    s->str[s->len] = '\0';
+}
+
+static legacy_mstr *legacy_new(char *src) {
+    legacy_mstr *s = malloc(sizeof(legacy_mstr));
+
+    s->str = NULL;
+    s->capacity = 0;
+    s->len = 0;
+    legacy_reserve(s, strlen(src));
+    s->str[0] = '\0';
+    legacy_append(s, src);
+    return s;
+}
+
+static void legacy_free(legacy_mstr *s) {
+    free(s->str);
+    free(s);
+}
+
+void bench_mstr_alloc(void) {
+    char *fields[] = {"level=info", " tag=http", " status=200"};
+
+    bench_header("mstr allocation, new + free of short strings");
+
+    bench_start();
+    for (int i = 0; i < ALLOC_LOOPS; i++) {
+        legacy_mstr *s = legacy_new("request.id");
+        bench_sink += s->len;
+        legacy_free(s);
+    }
+    bench_stop("two blocks, new/free", ALLOC_LOOPS);
+
+    bench_start();
+    for (int i = 0; i < ALLOC_LOOPS; i++) {
+        mstr *s = mstr_new("request.id");
+        bench_sink += s->len;
+        mstr_free(s);
+    }
+    bench_stop("single block, new/free", ALLOC_LOOPS);
+
+    bench_start();
+    for (int i = 0; i < ALLOC_LOOPS; i++) {
+        legacy_mstr *s = legacy_new("");
+        for (int j = 0; j < 3; j++) legacy_append(s, fields[j]);
+        bench_sink += s->len;
+        legacy_free(s);
+    }
+    bench_stop("two blocks, new/3x append/free", ALLOC_LOOPS);
+
+    bench_start();
+    for (int i = 0; i < ALLOC_LOOPS; i++) {
+        mstr *s = mstr_newl(32);
+        for (int j = 0; j < 3; j++) mstr_append(s, fields[j]);
+        bench_sink += s->len;
+        mstr_free(s);
+    }
+    bench_stop("single block, new/3x append/free", ALLOC_LOOPS);
+}
+
+void bench_mstr_sso(void) {
+    char key[MSTR_SSO];
+    mstr **heap;
+    mstr_sso *local;
+    long rss;
+    bench_alloc a;
+
+    bench_header("mstr small strings, 10M short keys kept alive");
+
+    local = malloc(SSO_STRINGS * sizeof(mstr_sso));
+    rss = bench_rss_kb();
+    bench_start();
+    for (int i = 0; i < SSO_STRINGS; i++) {
+        snprintf(key, sizeof(key), "tag.%07d", i);
+        mstr_init(&local[i], key);
+    }
+    bench_stop("mstr_sso, init", SSO_STRINGS);
+    a = bench_alloc_get();
+    printf("  %-36s %12lu mallocs %8ld kB RSS\n", "", (unsigned long)a.mallocs, bench_rss_kb() - rss);
+    for (int i = 0; i < SSO_STRINGS; i++) mstr_release(&local[i].s);
+    free(local);
+
+    heap = malloc(SSO_STRINGS * sizeof(mstr *));
+    rss = bench_rss_kb();
+    bench_start();
+    for (int i = 0; i < SSO_STRINGS; i++) {
+        snprintf(key, sizeof(key), "tag.%07d", i);
+        heap[i] = mstr_new(key);
+    }
+    bench_stop("mstr, new", SSO_STRINGS);
+    a = bench_alloc_get();
+    printf("  %-36s %12lu mallocs %8ld kB RSS\n", "", (unsigned long)a.mallocs, bench_rss_kb() - rss);
+    for (int i = 0; i < SSO_STRINGS; i++) mstr_free(heap[i]);
+    free(heap);
+}
+
+void bench_mstr_growth(void) {
+    static char chunk[256];
+    size_t sizes[] = {1, 16, 256};
+    char name[64];
+
+    memset(chunk, 'x', sizeof(chunk));
+    bench_header("mstr growth, append 1e6 bytes");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t n = GROWTH_BYTES / sizes[i];
+        legacy_mstr *ls;
+        mstr *s;
+
+        chunk[sizes[i]] = '\0';
+
+        ls = legacy_new("");
+        bench_start();
+        for (size_t j = 0; j < n; j++) legacy_append(ls, chunk);
+        snprintf(name, sizeof(name), "block growth, %3lu byte chunks", (unsigned long)sizes[i]);
+        bench_stop_bytes(name, n, n * sizes[i]);
+        legacy_free(ls);
+
+        s = mstr_new("");
+        bench_start();
+        for (size_t j = 0; j < n; j++) mstr_append_g(s, chunk, sizes[i]);
+        snprintf(name, sizeof(name), "geometric, %3lu byte chunks", (unsigned long)sizes[i]);
+        bench_stop_bytes(name, n, n * sizes[i]);
+        mstr_free(s);
+
+        chunk[sizes[i]] = 'x';
+    }
+}
+
+void bench_mstr_insert(void) {
+    size_t sizes[] = {1024, 64 * 1024, 1024 * 1024};
+    char name[64];
+    char *text;
+
+    bench_header("mstr insert, 1000 x 8 bytes near the front");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        legacy_mstr *ls;
+        mstr *s;
+        mgap *g;
+
+        text = malloc(sizes[i] + 1);
+        memset(text, 'x', sizes[i]);
+        text[sizes[i]] = '\0';
+
+        ls = legacy_new(text);
+        bench_start();
+        for (int j = 0; j < INSERT_LOOPS; j++) legacy_insert(ls, "inserted", 8, 16);
+        snprintf(name, sizeof(name), "byte loops, %7lu bytes", (unsigned long)sizes[i]);
+        bench_stop(name, INSERT_LOOPS);
+        legacy_free(ls);
+
+        s = mstr_new(text);
+        bench_start();
+        for (int j = 0; j < INSERT_LOOPS; j++) mstr_insert_g(s, "inserted", 8, 16);
+        snprintf(name, sizeof(name), "mstr memmove, %7lu bytes", (unsigned long)sizes[i]);
+        bench_stop(name, INSERT_LOOPS);
+        mstr_free(s);
+
+        g = mgap_new(text, 0);
+        bench_start();
+        for (int j = 0; j < INSERT_LOOPS; j++) mgap_insert(g, "inserted", 8, 16);
+        snprintf(name, sizeof(name), "mgap, %7lu bytes", (unsigned long)sizes[i]);
+        bench_stop(name, INSERT_LOOPS);
+        mgap_free(g);
+
+        free(text);
+    }
+}
+
+void bench_mstr_class(void) {
+    char *levels[] = {"ctype", "ascii", "sse2", "avx2"};
+    size_t sizes[] = {64, 4096};
+    char name[64];
+
+    bench_header("mstr classification and case conversion");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        size_t n = CLASS_BYTES / sizes[i];
+        mstr *alpha = mstr_newl(sizes[i]);
+        mstr *space = mstr_newl(sizes[i]);
+
+        for (size_t j = 0; j < sizes[i]; j++) {
+            mstr_append_g(alpha, &"RecordFieldValue"[j % 16], 1);
+            mstr_append_g(space, &" \t"[j % 2], 1);
+        }
+
+        for (int level = MSTR_SIMD_NONE; level <= MSTR_SIMD_AVX2; level++) {
+            if (mstr_simd_set(level) != level) continue;
+
+            bench_start();
+            for (size_t j = 0; j < n; j++) bench_sink += mstr_is_alpha(alpha);
+            snprintf(name, sizeof(name), "is_alpha %-5s %4lu bytes", levels[level], (unsigned long)sizes[i]);
+            bench_stop_bytes(name, n, n * sizes[i]);
+
+            bench_start();
+            for (size_t j = 0; j < n; j++) bench_sink += mstr_is_alnum(alpha);
+            snprintf(name, sizeof(name), "is_alnum %-5s %4lu bytes", levels[level], (unsigned long)sizes[i]);
+            bench_stop_bytes(name, n, n * sizes[i]);
+
+            bench_start();
+            for (size_t j = 0; j < n; j++) bench_sink += mstr_is_space(space);
+            snprintf(name, sizeof(name), "is_space %-5s %4lu bytes", levels[level], (unsigned long)sizes[i]);
+            bench_stop_bytes(name, n, n * sizes[i]);
+
+            bench_start();
+            for (size_t j = 0; j < n; j += 2) {
+                mstr_upper(alpha);
+                mstr_lower(alpha);
+            }
+            snprintf(name, sizeof(name), "upper/lower %-5s %4lu bytes", levels[level], (unsigned long)sizes[i]);
+            bench_stop_bytes(name, n, n * sizes[i]);
+        }
+        mstr_free(alpha);
+        mstr_free(space);
+    }
+    mstr_simd_set(-1);
+}
+
+void bench_mstr_strip(void) {
+    char *set = " \t\r\n,;";
+    char record[2048];
+    mstr_charset cs;
+    legacy_mstr *ls;
+    mstr *s;
+    size_t len;
+
+    // 1000 byte record padded with 400 bytes of mixed whitespace on each side
+    len = 0;
+    for (int i = 0; i < 400; i++) record[len++] = " \t\r\n"[i % 4];
+    for (int i = 0; i < 1000; i++) record[len++] = "record;field,value "[i % 19];
+    for (int i = 0; i < 400; i++) record[len++] = " \t\r\n"[i % 4];
+    record[len] = '\0';
+
+    bench_header("mstr strip, 1800 byte whitespace padded records");
+
+    ls = legacy_new(record);
+    bench_start();
+    for (int i = 0; i < STRIP_LOOPS; i++) {
+        ls->len = 0;
+        legacy_append(ls, record);
+        legacy_strip(ls, set);
+    }
+    bench_stop_bytes("strlen per char + byte shift", STRIP_LOOPS, STRIP_LOOPS * len);
+    legacy_free(ls);
+
+    s = mstr_newl(len);
+    bench_start();
+    for (int i = 0; i < STRIP_LOOPS; i++) {
+        mstr_clear(s);
+        mstr_append_g(s, record, len);
+    }
+    bench_stop_bytes("copy only (baseline)", STRIP_LOOPS, STRIP_LOOPS * len);
+
+    bench_start();
+    for (int i = 0; i < STRIP_LOOPS; i++) {
+        mstr_clear(s);
+        mstr_append_g(s, record, len);
+        mstr_strip(s, set);
+    }
+    bench_stop_bytes("mstr_strip", STRIP_LOOPS, STRIP_LOOPS * len);
+
+    mstr_charset_init(&cs, set);
+    bench_start();
+    for (int i = 0; i < STRIP_LOOPS; i++) {
+        mstr_clear(s);
+        mstr_append_g(s, record, len);
+        mstr_strip_set(s, &cs);
+    }
+    bench_stop_bytes("mstr_strip_set, prebuilt set", STRIP_LOOPS, STRIP_LOOPS * len);
+    mstr_free(s);
+}
+
+static mstr *search_text(void) {
+    mstr *s = mstr_newl(SEARCH_BYTES);
+    int line = 0;
+
+    while (s->len < SEARCH_BYTES) {
+        mstr_append(s, "2026-10-18 12:00:00 INFO request path=/api/v1/items ");
+        mstr_append(s, (line++ % 100) ? "status=200 time=12ms\n" : "status=503 time=97ms\n");
+    }
+    return s;
+}
+
+void bench_mstr_search(void) {
+    char *levels[] = {"ctype", "memchr", "sse2", "avx2"};
+    char *needle = "status=503";
+    size_t needle_len = strlen(needle);
+    char name[64];
+    mstr *text = search_text();
+    mstr *s;
+    size_t count = 0;
+
+    bench_header("mstr search, 4 MB log text");
+
+    bench_start();
+    for (int i = 0; i < SEARCH_LOOPS; i++) {
+        char *p = text->str;
+        count = 0;
+        while ((p = strstr(p, needle)) != NULL) {
+            count++;
+            p += needle_len;
+        }
+    }
+    bench_stop_bytes("strstr loop, find all", SEARCH_LOOPS, SEARCH_LOOPS * text->len);
+
+    for (int level = MSTR_SIMD_SCALAR; level <= MSTR_SIMD_AVX2; level++) {
+        if (mstr_simd_set(level) != level) continue;
+
+        bench_start();
+        for (int i = 0; i < SEARCH_LOOPS; i++) bench_sink += mstr_find_all(text, needle, NULL, 0);
+        snprintf(name, sizeof(name), "mstr_find_all %s", levels[level]);
+        bench_stop_bytes(name, SEARCH_LOOPS, SEARCH_LOOPS * text->len);
+    }
+    mstr_simd_set(-1);
+    printf("  %lu matches\n", (unsigned long)count);
+
+    // Replace by finding and editing one match at a time
+    s = mstr_news(text);
+    bench_start();
+    {
+        char *p = s->str;
+        while ((p = strstr(p, needle)) != NULL) {
+            size_t pos = p - s->str;
+            memmove(p, p + needle_len, s->len - pos - needle_len + 1);
+            s->len -= needle_len;
+            mstr_insert_g(s, "status=503 (service unavailable)", 32, pos);
+            p = s->str + pos + 32;
+        }
+    }
+    bench_stop_bytes("strstr + mstr_insert, replace all", 1, text->len);
+    mstr_free(s);
+
+    s = mstr_news(text);
+    bench_start();
+    mstr_replace(s, needle, "status=503 (service unavailable)");
+    bench_stop_bytes("mstr_replace", 1, text->len);
+    mstr_free(s);
+
+    mstr_free(text);
+}
+
+// Metrics exporter line: name{labels} value timestamp
+void bench_mstr_format(void) {
+    char buf[128];
+    mstr *s = mstr_newl(64);
+
+    bench_header("mstr formatted append, 1M metric lines");
+
+    bench_start();
+    for (int i = 0; i < FORMAT_LINES; i++) {
+        mstr_clear(s);
+        snprintf(buf, sizeof(buf), "http_requests_total{code=\"%d\",id=\"%x\"} %.3f %lld\n",
+                 200 + (i & 3), i, i * 0.125, 1760000000000LL + i);
+        mstr_append_c(s, buf);
+        bench_sink += s->len;
+    }
+    bench_stop("snprintf + mstr_append_c", FORMAT_LINES);
+
+    bench_start();
+    for (int i = 0; i < FORMAT_LINES; i++) {
+        mstr_clear(s);
+        mstr_appendf(s, "http_requests_total{code=\"%d\",id=\"%x\"} %.3f %lld\n",
+                     200 + (i & 3), i, i * 0.125, 1760000000000LL + i);
+        bench_sink += s->len;
+    }
+    bench_stop("mstr_appendf", FORMAT_LINES);
+
+    bench_start();
+    for (int i = 0; i < FORMAT_LINES; i++) {
+        mstr_clear(s);
+        mstr_append(s, "http_requests_total{code=\"");
+        mstr_append_int(s, 200 + (i & 3));
+        mstr_append(s, "\",id=\"");
+        mstr_append_hex(s, i, 0);
+        mstr_append(s, "\"} ");
+        mstr_append_fixed(s, i * 0.125, 3);
+        mstr_append(s, " ");
+        mstr_append_int(s, 1760000000000LL + i);
+        mstr_append(s, "\n");
+        bench_sink += s->len;
+    }
+    bench_stop("mstr_append_int/hex/fixed", FORMAT_LINES);
+
+    bench_start();
+    for (int i = 0; i < FORMAT_LINES; i++) {
+        snprintf(buf, sizeof(buf), "%lld", 1760000000000LL + i);
+        bench_sink += buf[0];
+    }
+    bench_stop("snprintf %lld", FORMAT_LINES);
+
+    bench_start();
+    for (int i = 0; i < FORMAT_LINES; i++) {
+        mstr_clear(s);
+        mstr_append_int(s, 1760000000000LL + i);
+        bench_sink += s->len;
+    }
+    bench_stop("mstr_append_int", FORMAT_LINES);
+
+    bench_start();
+    for (int i = 0; i < FORMAT_LINES; i++) {
+        snprintf(buf, sizeof(buf), "%.3f", i * 0.125);
+        bench_sink += buf[0];
+    }
+    bench_stop("snprintf %.3f", FORMAT_LINES);
+
+    bench_start();
+    for (int i = 0; i < FORMAT_LINES; i++) {
+        mstr_clear(s);
+        mstr_append_fixed(s, i * 0.125, 3);
+        bench_sink += s->len;
+    }
+    bench_stop("mstr_append_fixed", FORMAT_LINES);
+
+    mstr_free(s);
+}
+
+static mstr *utf8_text(char **words, int nwords) {
+    mstr *s = mstr_newl(UTF8_BYTES);
+    unsigned int r = 1;
+
+    while (s->len < UTF8_BYTES) {
+        r = r * 1103515245 + 12345;
+        mstr_append(s, words[(r >> 16) % nwords]);
+    }
+    return s;
+}
+
+void bench_mstr_utf8(void) {
+    char *levels[] = {"byte", "swar", "sse2", "avx2"};
+    char *ascii[] = {"plain ", "ascii ", "log ", "text, ", "status=200 ", "\n"};
+    char *mixed[] = {"plain ", "ascii ", "gr\xc3\xb6n ", "caf\xc3\xa9 ", "\xe2\x82\xac" "42 ",
+                     "\xe4\xb8\xad\xe6\x96\x87 ", "\xf0\x9f\x98\x80 ", "status=200 ", "\n"};
+    char *cjk[] = {"\xe4\xb8\xad\xe6\x96\x87", "\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", "\xed\x95\x9c\xea\xb8\x80", " "};
+    char **corpora[] = {ascii, mixed, cjk};
+    int sizes[] = {6, 9, 4};
+    char *names[] = {"ascii", "mixed", "cjk"};
+    char name[64];
+
+    bench_header("mstr UTF-8, 32 MB corpora");
+
+    for (int c = 0; c < 3; c++) {
+        mstr *text = utf8_text(corpora[c], sizes[c]);
+
+        for (int level = MSTR_SIMD_NONE; level <= MSTR_SIMD_AVX2; level++) {
+            if (mstr_simd_set(level) != level) continue;
+
+            bench_start();
+            for (int i = 0; i < UTF8_LOOPS; i++) bench_sink += mstr_utf8_valid(text);
+            snprintf(name, sizeof(name), "%s valid %s", names[c], levels[level]);
+            bench_stop_bytes(name, UTF8_LOOPS, UTF8_LOOPS * text->len);
+
+            bench_start();
+            for (int i = 0; i < UTF8_LOOPS; i++) bench_sink += mstr_utf8_len(text);
+            snprintf(name, sizeof(name), "%s len %s", names[c], levels[level]);
+            bench_stop_bytes(name, UTF8_LOOPS, UTF8_LOOPS * text->len);
+
+            bench_start();
+            for (int i = 0; i < UTF8_LOOPS; i++) bench_sink += mstr_utf8_width(text);
+            snprintf(name, sizeof(name), "%s width %s", names[c], levels[level]);
+            bench_stop_bytes(name, UTF8_LOOPS, UTF8_LOOPS * text->len);
+        }
+        mstr_free(text);
+    }
+    mstr_simd_set(-1);
+}
@@ -0,0 +1,128 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    mview benchmarks
+ *
+ * @file     bench_mview.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Parses a CSV like buffer into lines and trimmed fields, once by copying
+ * every field into a mstr and once with views into the buffer.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+
+#include "def.h"
+#include "mstr.h"
+#include "mview.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define SPLIT_BYTES (64 * 1024 * 1024)
+
+// Code -------------------------------------------------------------------
+
+static mstr *split_text(void) {
+    mstr *s = mstr_newl(SPLIT_BYTES);
+    int line = 0;
+
+    while (s->len < SPLIT_BYTES) {
+        mstr_append(s, "1042, sensor-a ,  21.5 ,ok,2026-10-18\n");
+        mstr_append(s, (line++ % 10) ? "1043,sensor-b,19.0, ok ,2026-10-18\n" : "1044,,,fail,\n");
+    }
+    return s;
+}
+
+void bench_mview_split(void) {
+    mstr *text = split_text();
+    mstr_charset ws;
+    size_t fields = 0;
+
+    mstr_charset_init(&ws, " \t");
+    bench_header("mview split, 64 MB CSV text");
+
+    // Copy every line and field, then trim the copy
+    bench_start();
+    {
+        mstr *line = mstr_newl(128);
+        mstr *field = mstr_newl(64);
+        char *p = text->str;
+        char *end;
+
+        while (*p != '\0') {
+            end = strchr(p, '\n');
+            line->len = 0;
+            mstr_append_g(line, p, end - p);
+            p = end + 1;
+
+            char *f = line->str;
+            char *comma;
+            do {
+                comma = strchr(f, ',');
+                size_t len = (comma != NULL) ? (size_t)(comma - f) : strlen(f);
+                field->len = 0;
+                mstr_append_g(field, f, len);
+                mstr_strip_set(field, &ws);
+                bench_sink += field->len;
+                fields++;
+                f = comma + 1;
+            } while (comma != NULL);
+        }
+        mstr_free(field);
+        mstr_free(line);
+    }
+    bench_stop_bytes("mstr copies + strip", fields, text->len);
+
+    // Same with a new mstr per field
+    fields = 0;
+    bench_start();
+    {
+        char *p = text->str;
+        char *end;
+
+        while (*p != '\0') {
+            end = strchr(p, '\n');
+            char *f = p;
+            char *comma;
+            do {
+                comma = memchr(f, ',', end - f);
+                size_t len = (comma != NULL) ? (size_t)(comma - f) : (size_t)(end - f);
+                mstr *field = mstr_new_g(len, NULL);
+                mstr_append_g(field, f, len);
+                mstr_strip_set(field, &ws);
+                bench_sink += field->len;
+                mstr_free(field);
+                fields++;
+                f = comma + 1;
+            } while (comma != NULL);
+            p = end + 1;
+        }
+    }
+    bench_stop_bytes("mstr per field", fields, text->len);
+
+    fields = 0;
+    bench_start();
+    {
+        mview rest = mview_new(text);
+        mview line, field;
+
+        while (mview_split(&rest, '\n', &line)) {
+            if (line.len == 0) continue;
+            while (mview_split(&line, ',', &field)) {
+                bench_sink += mview_trim(field, &ws).len;
+                fields++;
+            }
+        }
+    }
+    bench_stop_bytes("mview split + trim", fields, text->len);
+
+    mstr_free(text);
+}
@@ -0,0 +1,151 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Shared S2S benchmarks
+ *
+ * @file     bench_shared.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * A configuration table of 1k entries read by 1 to 8 threads while one
+ * writer changes a value every SHARED_PERIOD us. s2s_shared against a
+ * frozen S2S behind a pthread rwlock, changed in place by the writer.
+ * ns/op is wall time per lookup over all readers, it goes down as long
+ * as there are cores for the readers to run on.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "def.h"
+#include "s2s.h"
+#include "s2s_shared.h"
+#include "bench.h"
+
+// Macros -----------------------------------------------------------------
+
+#define SHARED_ENTRIES 1000
+#define SHARED_LOOKUPS 400000  // Per reader thread
+#define SHARED_PERIOD 1000     // us between writes
+#define SHARED_THREADS 8
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    bool rwlock;           // Use the rwlock table instead of s2s_shared
+    int done;              // Readers finished, writer stops
+    size_t writes;
+} shared_run;
+
+// Prototypes -------------------------------------------------------------
+
+static void *shared_reader(void *arg);
+static void *shared_writer(void *arg);
+
+// Variables --------------------------------------------------------------
+
+static char keys[SHARED_ENTRIES][S2S_STRLEN];
+static s2s_shared *sh;
+static S2S *locked;
+static pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+
+// Code -------------------------------------------------------------------
+
+static void *shared_reader(void *arg) {
+    shared_run *run = arg;
+    char value[S2S_STRLEN];
+    size_t sum = 0;
+    char *v;
+
+    for (size_t i = 0; i < SHARED_LOOKUPS; i++) {
+        char *key = keys[(i * 7919) % SHARED_ENTRIES];
+
+        if (run->rwlock) {
+            pthread_rwlock_rdlock(&lock);
+            v = S2S_getValue(locked, key);
+            sum += (v != NULL) ? (size_t)v[0] : 0;
+            pthread_rwlock_unlock(&lock);
+        } else {
+            sum += s2s_shared_getValue(sh, key, value, sizeof(value)) ? (size_t)value[0] : 0;
+        }
+    }
+
+    bench_sink += sum;
+    return NULL;
+}
+
+static void *shared_writer(void *arg) {
+    shared_run *run = arg;
+    char value[S2S_STRLEN];
+
+    while (!__atomic_load_n(&run->done, __ATOMIC_ACQUIRE)) {
+        snprintf(value, sizeof(value), "%zu", run->writes);
+        if (run->rwlock) {
+            pthread_rwlock_wrlock(&lock);
+            S2S_setValue(locked, keys[run->writes % SHARED_ENTRIES], value);
+            pthread_rwlock_unlock(&lock);
+        } else {
+            s2s_shared_setValue(sh, keys[run->writes % SHARED_ENTRIES], value);
+        }
+        run->writes++;
+        usleep(SHARED_PERIOD);
+    }
+    return NULL;
+}
+
+void bench_shared_read(void) {
+    pthread_t readers[SHARED_THREADS];
+    pthread_t writer;
+    shared_run run;
+    char name[80];
+    S2S *db;
+
+    snprintf(name, sizeof(name), "S2S read by 1-8 threads during writes, s2s_shared vs rwlock, %ld cores",
+             sysconf(_SC_NPROCESSORS_ONLN));
+    bench_header(name);
+
+    db = S2S_new(SHARED_ENTRIES);
+    for (int i = 0; i < SHARED_ENTRIES; i++) {
+        snprintf(keys[i], S2S_STRLEN, "daemon.option.%d", i);
+        S2S_setKeyValue(db, i, keys[i], "on");
+    }
+
+    for (int r = 0; r < 2; r++) {
+        for (int n = 1; n <= SHARED_THREADS; n *= 2) {
+            memset(&run, 0, sizeof(run));
+            run.rwlock = (r == 1);
+            if (run.rwlock) {
+                locked = S2S_copy(db);
+                S2S_freeze(locked);
+            } else {
+                sh = s2s_shared_new(db);
+            }
+
+            snprintf(name, sizeof(name), "%s %d readers", run.rwlock ? "rwlock" : "s2s_shared", n);
+            pthread_create(&writer, NULL, shared_writer, &run);
+            bench_start();
+            for (int i = 0; i < n; i++) pthread_create(&readers[i], NULL, shared_reader, &run);
+            for (int i = 0; i < n; i++) pthread_join(readers[i], NULL);
+            bench_stop(name, (size_t)n * SHARED_LOOKUPS);
+            __atomic_store_n(&run.done, 1, __ATOMIC_RELEASE);
+            pthread_join(writer, NULL);
+
+            printf("  %-36s %12zu\n", "writes", run.writes);
+            if (run.rwlock) {
+                S2S_free(locked);
+            } else {
+                s2s_shared_free(sh);
+            }
+        }
+    }
+
+    S2S_free(db);
+}
@@ -0,0 +1,367 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    I2S and S2S table benchmarks
+ *
+ * @file     bench_table.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Tables of 100k entries. Unregistered tables are plain malloc'ed arrays
+ * terminated by the sentinel, the same thing a static initializer list
+ * is to the library.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "i2i.h"
+#include "i2s.h"
+#include "s2s.h"
+#include "i2sc.h"
+#include "s2sc.h"
+#include "dbinfo.h"
+#include "bench.h"
+#include "errnames_ph.h"
+#include "errcodes_ph.h"
+
+// Macros -----------------------------------------------------------------
+
+#define TABLE_ENTRIES 100000
+#define TABLE_LEN_CALLS 20000
+#define TABLE_LOOKUPS 1000000
+#define TABLE_SCAN_BUDGET 200000000ull  // Entries compared by a scan per size
+#define TABLE_COMPACT 500000
+#define TABLE_REVERSE_SCANS 2000
+#define TABLE_COMPACT_SCANS 20
+
+// Code -------------------------------------------------------------------
+
+void bench_table_len(void) {
+    I2S *plain;
+    I2S *db;
+    size_t sum;
+
+    bench_header("I2S length and growth, 100k entries");
+
+    plain = malloc((TABLE_ENTRIES + 1) * sizeof(I2S));
+    for (int i = 0; i < TABLE_ENTRIES; i++) {
+        plain[i].key = i;
+        snprintf(plain[i].value, I2S_STRLEN, "name%d", i);
+    }
+    plain[TABLE_ENTRIES].key = I2S_LAST;
+
+    sum = 0;
+    bench_start();
+    for (int i = 0; i < TABLE_LEN_CALLS; i++) sum += (size_t)I2S_len(plain);
+    bench_stop("I2S_len unregistered", TABLE_LEN_CALLS);
+    bench_sink += sum;
+
+    db = I2S_copy(plain);
+    sum = 0;
+    bench_start();
+    for (int i = 0; i < TABLE_LEN_CALLS; i++) sum += (size_t)I2S_len(db);
+    bench_stop("I2S_len registered", TABLE_LEN_CALLS);
+    bench_sink += sum;
+    I2S_free(db);
+
+    bench_start();
+    db = I2S_new(0);
+    for (int i = 0; i < TABLE_ENTRIES; i++) db = I2S_append(db, i, plain[i].value);
+    bench_stop("I2S_append", TABLE_ENTRIES);
+    bench_sink += (size_t)I2S_len(db);
+
+    bench_start();
+    while (I2S_len(db) > 0) I2S_remove(db, I2S_last(db));
+    bench_stop("I2S_remove from end", TABLE_ENTRIES);
+    I2S_free(db);
+
+    free(plain);
+}
+
+static int table_key(int i) {
+    return (int)(((uint32_t)i * 2654435761u) >> 1);
+}
+
+void bench_table_freeze(void) {
+    static const int sizes[] = {16, 1000, 100000};
+    char name[64];
+    size_t sum;
+    size_t scans;
+    S2S *ss;
+    I2S *is;
+    int n;
+
+    bench_header("I2S/S2S findKey, random hits, scan vs frozen");
+
+    for (size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); z++) {
+        n = sizes[z];
+        is = I2S_new(n);
+        ss = S2S_new(n);
+        for (int i = 0; i < n; i++) {
+            snprintf(name, sizeof(name), "sensor.%d.value", table_key(i) % 1000000);
+            I2S_setKeyValue(is, i, table_key(i), name);
+            S2S_setKeyValue(ss, i, name, "v");
+        }
+
+        scans = TABLE_SCAN_BUDGET / n;
+        if (scans > TABLE_LOOKUPS) scans = TABLE_LOOKUPS;
+
+        snprintf(name, sizeof(name), "I2S_findKey scan n=%d", n);
+        sum = 0;
+        bench_start();
+        for (size_t i = 0; i < scans; i++) sum += (size_t)I2S_findKey(is, table_key((int)((i * 7919) % n)));
+        bench_stop(name, scans);
+
+        snprintf(name, sizeof(name), "I2S_freeze n=%d", n);
+        bench_start();
+        I2S_freeze(is);
+        bench_stop(name, n);
+
+        snprintf(name, sizeof(name), "I2S_findKey frozen n=%d", n);
+        bench_start();
+        for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)I2S_findKey(is, table_key((int)((i * 7919) % n)));
+        bench_stop(name, TABLE_LOOKUPS);
+
+        snprintf(name, sizeof(name), "S2S_findKey scan n=%d", n);
+        bench_start();
+        for (size_t i = 0; i < scans; i++) sum += (size_t)S2S_findKey(ss, ss[(i * 7919) % n].key);
+        bench_stop(name, scans);
+
+        snprintf(name, sizeof(name), "S2S_freeze n=%d", n);
+        bench_start();
+        S2S_freeze(ss);
+        bench_stop(name, n);
+
+        snprintf(name, sizeof(name), "S2S_findKey frozen n=%d", n);
+        bench_start();
+        for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)S2S_findKey(ss, ss[(i * 7919) % n].key);
+        bench_stop(name, TABLE_LOOKUPS);
+
+        bench_sink += sum;
+        I2S_free(is);
+        S2S_free(ss);
+    }
+}
+
+// errno tables of ~130 entries, generated perfect hash against the same
+// entries in a runtime table, scanned and frozen
+void bench_table_phash(void) {
+    S2S *ss = S2S_new(ERRMSG_LEN);
+    I2S *is = I2S_new(ERRNAME_LEN);
+    size_t sum = 0;
+    int n;
+
+    bench_header("Constant errno tables, findKey, scan vs frozen vs perfect hash");
+
+    for (int i = 0; i < ERRMSG_LEN; i++) S2S_setKeyValue(ss, i, (char *)errMsg_key(i), (char *)errMsg_value(i));
+    for (int i = 0; i < ERRNAME_LEN; i++) I2S_setKeyValue(is, i, errName_key(i), (char *)errName_value(i));
+
+    n = ERRMSG_LEN;
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)S2S_findKey(ss, (char *)errMsg_key((int)((i * 7919) % n)));
+    bench_stop("S2S_findKey scan", TABLE_LOOKUPS);
+
+    S2S_freeze(ss);
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)S2S_findKey(ss, (char *)errMsg_key((int)((i * 7919) % n)));
+    bench_stop("S2S_findKey frozen", TABLE_LOOKUPS);
+
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)errMsg_findKey(errMsg_key((int)((i * 7919) % n)));
+    bench_stop("errMsg_findKey perfect hash", TABLE_LOOKUPS);
+
+    n = ERRNAME_LEN;
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)I2S_findKey(is, errName_key((int)((i * 7919) % n)));
+    bench_stop("I2S_findKey scan", TABLE_LOOKUPS);
+
+    I2S_freeze(is);
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)I2S_findKey(is, errName_key((int)((i * 7919) % n)));
+    bench_stop("I2S_findKey frozen", TABLE_LOOKUPS);
+
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)errName_findKey(errName_key((int)((i * 7919) % n)));
+    bench_stop("errName_findKey perfect hash", TABLE_LOOKUPS);
+
+    bench_sink += sum;
+    S2S_free(ss);
+    I2S_free(is);
+}
+
+// 500k entries of short keys and values, fixed size elements against
+// compact elements with a string heap. Scans look for missing keys and
+// values, so they run through the whole table. Memory is what is
+// allocated, both kinds of table grow by doubling.
+void bench_table_compact(void) {
+    char key[64];
+    char value[64];
+    size_t sum = 0;
+    S2S *ss;
+    S2SC *sc;
+    I2S *is;
+    I2SC *ic;
+
+    bench_header("I2S/S2S vs compact I2SC/S2SC, 500k entries");
+
+    bench_start();
+    ss = S2S_new(0);
+    for (int i = 0; i < TABLE_COMPACT; i++) {
+        snprintf(key, sizeof(key), "sensor.%d.value", i);
+        snprintf(value, sizeof(value), "%d", i % 1000);
+        ss = S2S_append(ss, key, value);
+    }
+    bench_stop("S2S_append", TABLE_COMPACT);
+
+    bench_start();
+    sc = S2SC_new(0);
+    for (int i = 0; i < TABLE_COMPACT; i++) {
+        snprintf(key, sizeof(key), "sensor.%d.value", i);
+        snprintf(value, sizeof(value), "%d", i % 1000);
+        S2SC_append(sc, key, value);
+    }
+    bench_stop("S2SC_append", TABLE_COMPACT);
+
+    bench_start();
+    for (int i = 0; i < TABLE_COMPACT_SCANS; i++) sum += (size_t)S2S_findKey(ss, "sensor.missing");
+    bench_stop_bytes("S2S_findKey scan", TABLE_COMPACT_SCANS, (size_t)TABLE_COMPACT_SCANS * TABLE_COMPACT * sizeof(S2S));
+
+    bench_start();
+    for (int i = 0; i < TABLE_COMPACT_SCANS; i++) sum += (size_t)S2SC_findKey(sc, "sensor.missing");
+    bench_stop_bytes("S2SC_findKey scan", TABLE_COMPACT_SCANS, (size_t)TABLE_COMPACT_SCANS * TABLE_COMPACT * sizeof(S2SC_entry));
+
+    bench_start();
+    for (int i = 0; i < TABLE_COMPACT_SCANS; i++) sum += (size_t)S2S_findValue(ss, "missing");
+    bench_stop("S2S_findValue scan", TABLE_COMPACT_SCANS);
+
+    bench_start();
+    for (int i = 0; i < TABLE_COMPACT_SCANS; i++) sum += (size_t)S2SC_findValue(sc, "missing");
+    bench_stop("S2SC_findValue scan", TABLE_COMPACT_SCANS);
+
+    printf("  %-36s %12zu kB\n", "S2S memory", (size_t)dbinfo_get(ss)->capacity * sizeof(S2S) / 1024);
+    printf("  %-36s %12zu kB\n", "S2SC memory", S2SC_size(sc) / 1024);
+    S2S_free(ss);
+    S2SC_free(sc);
+
+    bench_start();
+    is = I2S_new(0);
+    for (int i = 0; i < TABLE_COMPACT; i++) {
+        snprintf(value, sizeof(value), "name%d", i);
+        is = I2S_append(is, i, value);
+    }
+    bench_stop("I2S_append", TABLE_COMPACT);
+
+    bench_start();
+    ic = I2SC_new(0);
+    for (int i = 0; i < TABLE_COMPACT; i++) {
+        snprintf(value, sizeof(value), "name%d", i);
+        I2SC_append(ic, i, value);
+    }
+    bench_stop("I2SC_append", TABLE_COMPACT);
+
+    bench_start();
+    for (int i = 0; i < TABLE_COMPACT_SCANS; i++) sum += (size_t)I2S_findKey(is, -2);
+    bench_stop_bytes("I2S_findKey scan", TABLE_COMPACT_SCANS, (size_t)TABLE_COMPACT_SCANS * TABLE_COMPACT * sizeof(I2S));
+
+    bench_start();
+    for (int i = 0; i < TABLE_COMPACT_SCANS; i++) sum += (size_t)I2SC_findKey(ic, -2);
+    bench_stop_bytes("I2SC_findKey scan", TABLE_COMPACT_SCANS, (size_t)TABLE_COMPACT_SCANS * TABLE_COMPACT * sizeof(I2SC_entry));
+
+    printf("  %-36s %12zu kB\n", "I2S memory", (size_t)dbinfo_get(is)->capacity * sizeof(I2S) / 1024);
+    printf("  %-36s %12zu kB\n", "I2SC memory", I2SC_size(ic) / 1024);
+    I2S_free(is);
+    I2SC_free(ic);
+
+    bench_sink += sum;
+}
+
+// Reverse lookups in 100k entries, scan against value index. Every
+// value is unique, hits are spread over the table.
+void bench_table_reverse(void) {
+    char (*names)[16] = malloc(TABLE_ENTRIES * sizeof(*names));
+    size_t sum = 0;
+    size_t bytes;
+    I2S *is;
+    S2S *ss;
+    i2i *ii;
+
+    bench_header("I2S/S2S/i2i findValue, 100k entries, scan vs value index");
+
+    is = I2S_new(TABLE_ENTRIES);
+    ss = S2S_new(TABLE_ENTRIES);
+    ii = i2i_new(TABLE_ENTRIES);
+    for (int i = 0; i < TABLE_ENTRIES; i++) {
+        snprintf(names[i], sizeof(names[i]), "name%d", i);
+        I2S_setKeyValue(is, i, i, names[i]);
+        S2S_setKeyValue(ss, i, names[i], names[i]);
+        i2i_setKeyValue(ii, i, i, table_key(i));
+    }
+
+    bench_start();
+    for (int i = 0; i < TABLE_REVERSE_SCANS; i++) sum += (size_t)I2S_findValue(is, names[(i * 7919) % TABLE_ENTRIES]);
+    bench_stop("I2S_findValue scan", TABLE_REVERSE_SCANS);
+
+    bench_start();
+    bytes = I2S_indexValues(is);
+    bench_stop("I2S_indexValues", TABLE_ENTRIES);
+    printf("  %-36s %12zu kB (table %zu kB)\n", "I2S value index", bytes / 1024, (size_t)TABLE_ENTRIES * sizeof(I2S) / 1024);
+
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)I2S_findValue(is, names[(i * 7919) % TABLE_ENTRIES]);
+    bench_stop("I2S_findValue indexed", TABLE_LOOKUPS);
+
+    bench_start();
+    for (int i = 0; i < TABLE_ENTRIES; i++) I2S_setKeyValue(is, i, i, names[TABLE_ENTRIES - 1 - i]);
+    bench_stop("I2S_setKeyValue indexed", TABLE_ENTRIES);
+
+    bench_start();
+    for (int i = 0; i < TABLE_REVERSE_SCANS; i++) sum += (size_t)S2S_findValue(ss, names[(i * 7919) % TABLE_ENTRIES]);
+    bench_stop("S2S_findValue scan", TABLE_REVERSE_SCANS);
+
+    bytes = S2S_indexValues(ss);
+    printf("  %-36s %12zu kB (table %zu kB)\n", "S2S value index", bytes / 1024, (size_t)TABLE_ENTRIES * sizeof(S2S) / 1024);
+
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)S2S_findValue(ss, names[(i * 7919) % TABLE_ENTRIES]);
+    bench_stop("S2S_findValue indexed", TABLE_LOOKUPS);
+
+    bench_start();
+    for (int i = 0; i < TABLE_REVERSE_SCANS; i++) sum += (size_t)i2i_findValue(ii, table_key((i * 7919) % TABLE_ENTRIES));
+    bench_stop("i2i_findValue scan", TABLE_REVERSE_SCANS);
+
+    bytes = i2i_indexValues(ii);
+    printf("  %-36s %12zu kB (table %zu kB)\n", "i2i value index", bytes / 1024, (size_t)TABLE_ENTRIES * sizeof(i2i) / 1024);
+
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)i2i_findValue(ii, table_key((int)((i * 7919) % TABLE_ENTRIES)));
+    bench_stop("i2i_findValue indexed", TABLE_LOOKUPS);
+
+    // Every value the same but a few, the common case of an empty column
+    for (int i = 0; i < TABLE_ENTRIES; i++) I2S_setKeyValue(is, i, i, (i % 1000) ? "" : names[i]);
+
+    bench_start();
+    I2S_indexValues(is);
+    bench_stop("I2S_indexValues duplicates", TABLE_ENTRIES);
+
+    bench_start();
+    for (size_t i = 0; i < TABLE_LOOKUPS; i++) sum += (size_t)I2S_findValue(is, (i & 1) ? "" : names[(i * 1000) % TABLE_ENTRIES]);
+    bench_stop("I2S_findValue duplicates", TABLE_LOOKUPS);
+
+    bench_start();
+    for (int i = 0; i < TABLE_ENTRIES; i++) I2S_setKeyValue(is, i, i, (i & 1) ? "" : "x");
+    bench_stop("I2S_setKeyValue duplicates", TABLE_ENTRIES);
+
+    bench_sink += sum;
+    I2S_free(is);
+    S2S_free(ss);
+    i2i_free(ii);
+    free(names);
+}
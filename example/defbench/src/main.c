@@ -0,0 +1,84 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Benchmarks of Def
+ *
+ * @file     main.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Usage: defbench [name ...]
+ * Runs all benchmarks, or only those whose name starts with one of the
+ * given arguments.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+
+#include "def.h"
+#include "def_util.h"
+#include "main.h"
+#include "bench.h"
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    char *name;
+    void (*run)(void);
+} benchmark;
+
+// Variables --------------------------------------------------------------
+
+static benchmark benchmarks[] = {
+    {"mstr_alloc", bench_mstr_alloc},
+    {"mstr_sso", bench_mstr_sso},
+    {"mstr_growth", bench_mstr_growth},
+    {"mstr_insert", bench_mstr_insert},
+    {"mstr_class", bench_mstr_class},
+    {"mstr_strip", bench_mstr_strip},
+    {"mstr_search", bench_mstr_search},
+    {"mstr_format", bench_mstr_format},
+    {"mstr_utf8", bench_mstr_utf8},
+    {"mview_split", bench_mview_split},
+    {"marena_request", bench_marena_request},
+    {"mrope_edit", bench_mrope_edit},
+    {"mintern_tags", bench_mintern_tags},
+    {"i2i_lookup", bench_i2i_lookup},
+    {"i2i_small", bench_i2i_small},
+    {"table_len", bench_table_len},
+    {"table_freeze", bench_table_freeze},
+    {"table_phash", bench_table_phash},
+    {"table_compact", bench_table_compact},
+    {"table_reverse", bench_table_reverse},
+    {"shared_read", bench_shared_read},
+    {"table_matrix", bench_table_matrix},
+    {"table_file", bench_table_file},
+    {"table_batch", bench_table_batch},
+    {"table_churn", bench_table_churn},
+    {NULL, NULL}};
+
+// Code -------------------------------------------------------------------
+
+static bool selected(char *name, int argc, char *argv[]) {
+    if (argc < 2) return true;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strncmp(name, argv[i], strlen(argv[i]))) return true;
+    }
+    return false;
+}
+
+int main(int argc, char *argv[]) {
+    printTextLine(APP_DESCRIPTION);
+
+    for (benchmark *b = benchmarks; b->name != NULL; b++) {
+        if (selected(b->name, argc, argv)) b->run();
+    }
+
+    return 0;
+}
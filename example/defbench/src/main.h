@@ -0,0 +1,33 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Benchmarks of Def
+ *
+ * @file     main.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ *
+ */
+        
+#ifndef _MAIN_H_
+#define _MAIN_H_
+
+
+#define APP_NAME        "defbench"
+#define APP_VERSION     "0.01"
+#define APP_DESCRIPTION "Benchmarks of Def"
+#define APP_LICENSE     ""
+#define APP_AUTHOR      "Peter Malmberg"
+#define APP_EMAIL       "<peter.malmberg@gmail.com>"
+#define APP_ORG         "PMG"
+#define APP_HOME        ""
+#define APP_ICON        ""
+
+
+
+
+#endif // _MAIN_H_
@@ -20,6 +20,7 @@
 #include <signal.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
 
 #include "unity.h"
@@ -28,9 +29,24 @@
 #include "def_util.h"
 #include "def_linux.h"
 #include "i2i.h"
+#include "i2i_index.h"
+#include "dbinfo.h"
+#include "dbvalue.h"
+#include "dbkeys.h"
+#include "dbfile.h"
 #include "i2s.h"
 #include "s2s.h"
+#include "i2sc.h"
+#include "s2sc.h"
+#include "s2s_shared.h"
 #include "mstr.h"
+#include "mgap.h"
+#include "mview.h"
+#include "marena.h"
+#include "mrope.h"
+#include "mintern.h"
+#include "fgcolors_ph.h"
+#include "numbers_ph.h"
 
 // Defines ----------------------------------------------------------------
 
@@ -46,7 +62,29 @@ void colorTest(void);
 void I2S_test(void);
 void S2S_test(void);
 void I2I_test(void);
+void I2I_INDEX_test(void);
+void DBINFO_test(void);
+void FREEZE_test(void);
+void PHASH_test(void);
+void COMPACT_test(void);
+void REVERSE_test(void);
+void SHARED_test(void);
+void TABLE_test(void);
+void KEYS_test(void);
+void DBFILE_test(void);
+void BATCH_test(void);
+void REMOVE_test(void);
 void defTest(void);
+void MSTR_test(void);
+void MGAP_test(void);
+void MVIEW_test(void);
+void MARENA_test(void);
+void MROPE_test(void);
+void MINTERN_test(void);
+void MSTR_format_test(void);
+void MSTR_utf8_test(void);
+void MSTR_simd_test(void);
+void MSTR_find_test(void);
 int unitTest(void);
 int mstr_test(void);
 // Code -------------------------------------------------------------------
@@ -204,6 +242,1008 @@ void I2I_test(void) {
     i2i_printDb(ii);
 }
 
+void I2I_INDEX_test(void) {
+    i2i dup[] = {{7, 1}, {8, 2}, {7, 3}, {I2I_END}};
+    i2i_index *idx;
+    i2i *db;
+
+    idx = i2i_index_new(ii);
+    TEST_ASSERT_EQUAL_INT(5, i2i_index_len(idx));
+    TEST_ASSERT_EQUAL_INT(1, i2i_index_findKey(idx, 2));
+    TEST_ASSERT_EQUAL_INT(4, i2i_index_findKey(idx, 5));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_index_findKey(idx, 6));
+    TEST_ASSERT_EQUAL_INT(333, i2i_index_getValue(idx, 3));
+    TEST_ASSERT_EQUAL_INT(0, i2i_index_getValue(idx, 6));
+    TEST_ASSERT_TRUE(idx->db == ii);
+
+    // Adding a key moves the entries into an array owned by the index
+    TEST_ASSERT_EQUAL_INT(5, i2i_index_put(idx, 6, 666));
+    TEST_ASSERT_TRUE(idx->db != ii);
+    TEST_ASSERT_EQUAL_INT(5, i2i_len(ii));
+    TEST_ASSERT_EQUAL_INT(6, i2i_len(idx->db));
+    TEST_ASSERT_EQUAL_INT(666, i2i_getValue(idx->db, 6));
+    TEST_ASSERT_EQUAL_INT(2, i2i_index_put(idx, 3, 3333));
+    TEST_ASSERT_EQUAL_INT(3333, i2i_getValue(idx->db, 3));
+    TEST_ASSERT_EQUAL_INT(333, i2i_getValue(ii, 3));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_index_put(idx, I2I_LAST, 1));
+    i2i_index_free(idx);
+
+    idx = i2i_index_new(dup);
+    TEST_ASSERT_EQUAL_INT(0, i2i_index_findKey(idx, 7));
+    i2i_index_setValue(idx, 7, 10);
+    TEST_ASSERT_EQUAL_INT(10, i2i_getValue(dup, 7));
+    i2i_setKeyValue(dup, 0, 9, 11);
+    i2i_index_rebuild(idx);
+    TEST_ASSERT_EQUAL_INT(2, i2i_index_findKey(idx, 7));
+    TEST_ASSERT_EQUAL_INT(11, i2i_index_getValue(idx, 9));
+    i2i_index_free(idx);
+
+    idx = i2i_index_new(NULL);
+    TEST_ASSERT_EQUAL_INT(0, i2i_index_len(idx));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_index_findKey(idx, 0));
+    for (int i = 0; i < 20000; i++) {
+        i2i_index_put(idx, i * 7919 - 50000, i);
+    }
+    TEST_ASSERT_EQUAL_INT(20000, i2i_index_len(idx));
+    TEST_ASSERT_EQUAL_INT(20000, i2i_len(idx->db));
+    db = idx->db;
+    for (int i = 0; i < 20000; i += 37) {
+        TEST_ASSERT_EQUAL_INT(i, i2i_index_findKey(idx, i * 7919 - 50000));
+        TEST_ASSERT_EQUAL_INT(i2i_findKey(db, i * 7919 - 50000), i2i_index_findKey(idx, i * 7919 - 50000));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, i2i_index_findKey(idx, 1));
+    i2i_index_free(idx);
+}
+
+void DBINFO_test(void) {
+    i2i one[] = {{1, 10}, {I2I_END}};
+    i2i three[] = {{7, 70}, {8, 80}, {9, 90}, {I2I_END}};
+    char key[S2S_STRLEN];
+    i2i reuse[4];
+    I2S *is;
+    S2S *ss;
+    i2i *db;
+
+    // Static table, scanned and copied on append
+    TEST_ASSERT_NULL(dbinfo_get(numbersDb));
+    is = I2S_append(numbersDb, 5, "Fifth");
+    TEST_ASSERT_TRUE(is != numbersDb);
+    TEST_ASSERT_EQUAL_INT(4, I2S_len(numbersDb));
+    TEST_ASSERT_EQUAL_INT(5, I2S_len(is));
+    TEST_ASSERT_EQUAL_INT(4, I2S_last(is));
+    TEST_ASSERT_EQUAL_STRING("Fifth", I2S_getValue(is, 5));
+    TEST_ASSERT_EQUAL_INT(I2S_LAST, is[5].key);
+
+    I2S_remove(is, 0);
+    TEST_ASSERT_EQUAL_INT(4, I2S_len(is));
+    TEST_ASSERT_EQUAL_INT(-1, I2S_findKey(is, 22));
+    TEST_ASSERT_EQUAL_INT(3, I2S_findKey(is, 5));
+    I2S_remove(is, 4);
+    TEST_ASSERT_EQUAL_INT(4, I2S_len(is));
+    I2S_setKeyValue(is, 4, 9, "Out");
+    TEST_ASSERT_EQUAL_INT(-1, I2S_findKey(is, 9));
+    I2S_free(is);
+
+    // Storage reused for another table, registered only when asked to
+    memcpy(reuse, one, sizeof(one));
+    TEST_ASSERT_EQUAL_INT(0, i2i_indexValues(reuse));
+    i2i_freeze(reuse);
+    TEST_ASSERT_NULL(dbinfo_get(reuse));
+    memcpy(reuse, three, sizeof(three));
+    TEST_ASSERT_EQUAL_INT(3, i2i_len(reuse));
+    TEST_ASSERT_EQUAL_INT(2, i2i_findValue(reuse, 90));
+
+    memcpy(reuse, one, sizeof(one));
+    i2i_register(reuse);
+    TEST_ASSERT_TRUE(i2i_indexValues(reuse) > 0);
+    i2i_freeze(reuse);
+    TEST_ASSERT_EQUAL_INT(1, dbinfo_get(reuse)->len);
+    i2i_unregister(reuse);
+    memcpy(reuse, three, sizeof(three));
+    TEST_ASSERT_NULL(dbinfo_get(reuse));
+    TEST_ASSERT_EQUAL_INT(3, i2i_len(reuse));
+    TEST_ASSERT_EQUAL_INT(2, i2i_findValue(reuse, 90));
+    TEST_ASSERT_EQUAL_INT(1, i2i_findKey(reuse, 8));
+
+    db = i2i_new(0);
+    for (int i = 0; i < 1000; i++) {
+        db = i2i_append(db, i, i * 2);
+    }
+    TEST_ASSERT_EQUAL_INT(1000, i2i_len(db));
+    TEST_ASSERT_EQUAL_INT(1000, dbinfo_get(db)->len);
+    TEST_ASSERT_EQUAL_INT(1998, i2i_getValue(db, 999));
+    for (int i = 0; i < 1000; i += 2) {
+        i2i_remove(db, i / 2);
+    }
+    TEST_ASSERT_EQUAL_INT(500, i2i_len(db));
+    TEST_ASSERT_EQUAL_INT(0, i2i_findKey(db, 1));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findKey(db, 2));
+    TEST_ASSERT_EQUAL_INT(I2I_LAST, db[500].key);
+    i2i_free(db);
+    TEST_ASSERT_NULL(dbinfo_get(db));
+
+    // Unregistered arrays still work through the sentinel
+    db = i2i_copy(ii);
+    i2i_remove(ii, 4);
+    TEST_ASSERT_EQUAL_INT(4, i2i_len(ii));
+    TEST_ASSERT_EQUAL_INT(5, i2i_len(db));
+    memcpy(ii, db, 6 * sizeof(i2i));
+    i2i_free(db);
+
+    ss = S2S_new(2);
+    TEST_ASSERT_EQUAL_INT(2, S2S_len(ss));
+    S2S_setKeyValue(ss, 0, "a", "A");
+    S2S_setKeyValue(ss, 1, "b", "B");
+    for (int i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        ss = S2S_append(ss, key, "v");
+    }
+    TEST_ASSERT_EQUAL_INT(102, S2S_len(ss));
+    TEST_ASSERT_EQUAL_INT(101, S2S_last(ss));
+    TEST_ASSERT_EQUAL_INT(51, S2S_findKey(ss, "k49"));
+    TEST_ASSERT_EQUAL_STRING("B", S2S_getValue(ss, "b"));
+    S2S_remove(ss, 1);
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(ss, "b"));
+    TEST_ASSERT_EQUAL_INT(101, S2S_len(ss));
+    S2S_free(ss);
+}
+
+void FREEZE_test(void) {
+    I2S is[] = {{9, "nine"}, {-3, "minus"}, {9, "again"}, {0, "zero"}, {I2S_END}};
+    int expect[600];
+    char key[S2S_STRLEN];
+    S2S *ss;
+    I2S *db;
+
+    I2S_register(is);
+    I2S_freeze(is);
+    TEST_ASSERT_NOT_NULL(dbinfo_get(is)->keys);
+    TEST_ASSERT_EQUAL_INT(0, I2S_findKey(is, 9));
+    TEST_ASSERT_EQUAL_INT(1, I2S_findKey(is, -3));
+    TEST_ASSERT_EQUAL_INT(3, I2S_findKey(is, 0));
+    TEST_ASSERT_EQUAL_INT(-1, I2S_findKey(is, 5));
+    TEST_ASSERT_EQUAL_INT(-1, I2S_findKey(is, 10));
+    TEST_ASSERT_EQUAL_INT(-1, I2S_findKey(is, -4));
+    TEST_ASSERT_EQUAL_STRING("minus", I2S_getValue(is, -3));
+
+    // Changing a key drops the index
+    I2S_setKeyValue(is, 0, 5, "five");
+    TEST_ASSERT_EQUAL_INT(0, I2S_findKey(is, 5));
+    TEST_ASSERT_EQUAL_INT(2, I2S_findKey(is, 9));
+    I2S_thaw(is);
+    I2S_unregister(is);
+    TEST_ASSERT_NULL(dbinfo_get(is));
+
+    db = I2S_new(0);
+    for (int i = 0; i < 500; i++) {
+        db = I2S_append(db, ((i * 7919) % 300) * 2 - 300, "v");
+    }
+    for (int k = -300; k < 300; k++) {
+        expect[k + 300] = I2S_findKey(db, k);
+    }
+    I2S_freeze(db);
+    for (int k = -300; k < 300; k++) {
+        TEST_ASSERT_EQUAL_INT(expect[k + 300], I2S_findKey(db, k));
+    }
+    I2S_free(db);
+
+    S2S_register(fgColors);
+    S2S_freeze(fgColors);
+    TEST_ASSERT_EQUAL_INT(6, S2S_findKey(fgColors, E_CYAN));
+    TEST_ASSERT_EQUAL_STRING("Br Blue", S2S_getValue(fgColors, E_BR_BLUE));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(fgColors, "Cyan"));
+    TEST_ASSERT_EQUAL_INT(16, S2S_len(fgColors));
+    S2S_unregister(fgColors);
+
+    // Keys sharing long prefixes, some equal, some shorter than 8
+    ss = S2S_new(0);
+    for (int i = 0; i < 600; i++) {
+        if (i % 3) {
+            snprintf(key, sizeof(key), "config.section.%d", (i * 37) % 400);
+        } else {
+            snprintf(key, sizeof(key), "k%d", i % 50);
+        }
+        ss = S2S_append(ss, key, "v");
+    }
+    for (int i = 0; i < 600; i++) {
+        snprintf(key, sizeof(key), (i % 2) ? "config.section.%d" : "k%d", i);
+        expect[i] = S2S_findKey(ss, key);
+    }
+    S2S_freeze(ss);
+    for (int i = 0; i < 600; i++) {
+        snprintf(key, sizeof(key), (i % 2) ? "config.section.%d" : "k%d", i);
+        TEST_ASSERT_EQUAL_INT(expect[i], S2S_findKey(ss, key));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(ss, ""));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(ss, "config.section."));
+    S2S_free(ss);
+}
+
+void PHASH_test(void) {
+    int idx;
+
+    TEST_ASSERT_EQUAL_INT(S2S_len(fgColors), FGCOLORSPH_LEN);
+    for (int i = 0; i < FGCOLORSPH_LEN; i++) {
+        idx = fgColorsPh_findKey(fgColors[i].key);
+        TEST_ASSERT_TRUE(idx >= 0);
+        TEST_ASSERT_EQUAL_STRING(fgColors[i].key, fgColorsPh_key(idx));
+        TEST_ASSERT_EQUAL_STRING(fgColors[i].value, fgColorsPh_value(idx));
+        TEST_ASSERT_EQUAL_STRING(fgColors[i].value, fgColorsPh_getValue(fgColors[i].key));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, fgColorsPh_findKey(E_BG_RED));
+    TEST_ASSERT_EQUAL_INT(-1, fgColorsPh_findKey(""));
+    TEST_ASSERT_NULL(fgColorsPh_getValue("\e[1;3"));
+
+    TEST_ASSERT_EQUAL_INT(4, NUMBERSPH_LEN);
+    for (int i = 1; i <= NUMBERSPH_LEN; i++) {
+        idx = numbersPh_findKey(i);
+        TEST_ASSERT_EQUAL_INT(i, numbersPh_key(idx));
+        TEST_ASSERT_EQUAL_STRING(numbersPh_value(idx), numbersPh_getValue(i));
+    }
+    TEST_ASSERT_EQUAL_STRING("Third", numbersPh_getValue(3));
+    TEST_ASSERT_EQUAL_INT(-1, numbersPh_findKey(0));
+    TEST_ASSERT_EQUAL_INT(-1, numbersPh_findKey(I2S_LAST));
+    TEST_ASSERT_NULL(numbersPh_getValue(5));
+}
+
+void COMPACT_test(void) {
+    char key[64];
+    char value[64];
+    S2SC *ss;
+    I2SC *is;
+    size_t size;
+
+    ss = S2SC_fromS2S(fgColors);
+    TEST_ASSERT_EQUAL_INT(S2S_len(fgColors), S2SC_len(ss));
+    TEST_ASSERT_EQUAL_STRING("Cyan", S2SC_getValue(ss, E_CYAN));
+    TEST_ASSERT_EQUAL_INT(S2S_findValue(fgColors, "White"), S2SC_findValue(ss, "White"));
+    TEST_ASSERT_NULL(S2SC_getValue(ss, "Cyan"));
+    S2SC_free(ss);
+
+    // Strings longer than S2S_STRLEN are kept whole
+    ss = S2SC_new(2);
+    TEST_ASSERT_EQUAL_STRING("", S2SC_key(ss, 1));
+    S2SC_setKeyValue(ss, 0, "a.key.that.is.longer.than.thirty.two.characters", "short");
+    S2SC_setKeyValue(ss, 1, "k", "a value that is also longer than thirty two characters");
+    TEST_ASSERT_EQUAL_INT(0, S2SC_findKey(ss, "a.key.that.is.longer.than.thirty.two.characters"));
+    TEST_ASSERT_EQUAL_INT(-1, S2SC_findKey(ss, "a.key.that.is.longer.than.thirty"));
+    TEST_ASSERT_EQUAL_STRING("a value that is also longer than thirty two characters", S2SC_getValue(ss, "k"));
+    S2SC_setValue(ss, "k", "v");
+    TEST_ASSERT_EQUAL_STRING("v", S2SC_getValue(ss, "k"));
+
+    // Values taken from the table itself, while the heap moves
+    for (int i = 0; i < 200; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        S2SC_append(ss, key, S2SC_key(ss, i));
+    }
+    TEST_ASSERT_EQUAL_INT(202, S2SC_len(ss));
+    TEST_ASSERT_EQUAL_STRING("k", S2SC_getValue(ss, "key1"));
+    TEST_ASSERT_EQUAL_STRING("key7", S2SC_getValue(ss, "key9"));
+    S2SC_setKeyValue(ss, 5, "key5b", S2SC_key(ss, 5));
+    TEST_ASSERT_EQUAL_STRING("key3", S2SC_getValue(ss, "key5b"));
+
+    // Rewriting all values many times, garbage is reclaimed
+    size = S2SC_size(ss);
+    for (int n = 0; n < 50; n++) {
+        for (int i = 2; i < 202; i++) {
+            snprintf(value, sizeof(value), "value %d of round %d", i, n);
+            S2SC_setValue(ss, S2SC_key(ss, i), value);
+        }
+    }
+    TEST_ASSERT_TRUE(S2SC_size(ss) < size * 4);
+    TEST_ASSERT_EQUAL_STRING("value 100 of round 49", S2SC_value(ss, 100));
+    TEST_ASSERT_EQUAL_STRING("key98", S2SC_key(ss, 100));
+
+    S2SC_remove(ss, 0);
+    TEST_ASSERT_EQUAL_INT(201, S2SC_len(ss));
+    TEST_ASSERT_EQUAL_INT(-1, S2SC_findKey(ss, "a.key.that.is.longer.than.thirty.two.characters"));
+    TEST_ASSERT_EQUAL_INT(0, S2SC_findKey(ss, "k"));
+    TEST_ASSERT_NULL(S2SC_key(ss, 201));
+    S2SC_free(ss);
+
+    is = I2SC_new(0);
+    for (int i = 0; i < 100; i++) {
+        snprintf(value, sizeof(value), "number %d", i);
+        TEST_ASSERT_EQUAL_INT(i, I2SC_append(is, i * 3, value));
+    }
+    TEST_ASSERT_EQUAL_INT(33, I2SC_findKey(is, 99));
+    TEST_ASSERT_EQUAL_INT(-1, I2SC_findKey(is, 100));
+    TEST_ASSERT_EQUAL_STRING("number 33", I2SC_getValue(is, 99));
+    TEST_ASSERT_EQUAL_INT(50, I2SC_findValue(is, "number 50"));
+    I2SC_setValue(is, 99, "a value that is longer than thirty two characters");
+    TEST_ASSERT_EQUAL_STRING("a value that is longer than thirty two characters", I2SC_getValue(is, 99));
+    I2SC_remove(is, 0);
+    TEST_ASSERT_EQUAL_INT(98, I2SC_last(is));
+    TEST_ASSERT_EQUAL_INT(3, I2SC_key(is, 0));
+    I2SC_free(is);
+
+    is = I2SC_fromI2S(numbersDb);
+    TEST_ASSERT_EQUAL_INT(I2S_len(numbersDb), I2SC_len(is));
+    TEST_ASSERT_EQUAL_STRING(I2S_getValue(numbersDb, 3), I2SC_getValue(is, 3));
+    I2SC_free(is);
+}
+
+// Position of value found by scanning, to check the value index against
+static int reverse_scan(I2S *db, const char *value) {
+    for (int i = 0; i < I2S_len(db); i++) {
+        if (!strncmp(db[i].value, value, I2S_STRLEN)) return i;
+    }
+    return -1;
+}
+
+void REVERSE_test(void) {
+    I2S colors[] = {{1, "red"}, {2, "green"}, {3, "red"}, {I2S_END}};
+    char value[64];
+    I2S *is;
+    S2S *ss;
+    i2i *iv;
+
+    // Static table, indexed once registered
+    TEST_ASSERT_EQUAL_INT(0, I2S_indexValues(colors));
+    TEST_ASSERT_NULL(dbinfo_get(colors));
+    I2S_register(colors);
+    TEST_ASSERT_TRUE(I2S_indexValues(colors) > 0);
+    TEST_ASSERT_EQUAL_INT(0, I2S_findValue(colors, "red"));
+    TEST_ASSERT_EQUAL_INT(-1, I2S_findValue(colors, "blue"));
+    I2S_setValue(colors, 1, "blue");
+    TEST_ASSERT_EQUAL_INT(2, I2S_findValue(colors, "red"));
+    TEST_ASSERT_EQUAL_INT(0, I2S_findValue(colors, "blue"));
+    I2S_freeze(colors);
+    I2S_thaw(colors);
+    TEST_ASSERT_NOT_NULL(dbinfo_get(colors));
+    I2S_dropValues(colors);
+    TEST_ASSERT_NOT_NULL(dbinfo_get(colors));
+    I2S_unregister(colors);
+    TEST_ASSERT_NULL(dbinfo_get(colors));
+    TEST_ASSERT_EQUAL_INT(2, I2S_findValue(colors, "red"));
+
+    // Values with duplicates through all changes, against a scan
+    is = I2S_new(0);
+    for (int i = 0; i < 300; i++) {
+        snprintf(value, sizeof(value), "name%d", i % 70);
+        is = I2S_append(is, i, value);
+        if (i == 100) I2S_indexValues(is);
+    }
+    for (int i = 0; i < 300; i += 7) {
+        snprintf(value, sizeof(value), "name%d", (i * 13) % 90);
+        I2S_setValue(is, i, value);
+        I2S_setKeyValue(is, (i * 3) % 300, i + 1000, "name5");
+    }
+    for (int i = 0; i < 40; i++) I2S_remove(is, (i * 31) % I2S_len(is));
+    for (int i = 0; i < 100; i++) {
+        snprintf(value, sizeof(value), "name%d", i);
+        TEST_ASSERT_EQUAL_INT(reverse_scan(is, value), I2S_findValue(is, value));
+    }
+    I2S_free(is);
+
+    ss = S2S_copy(fgColors);
+    S2S_indexValues(ss);
+    TEST_ASSERT_EQUAL_INT(6, S2S_findValue(ss, "Cyan"));
+    S2S_setValue(ss, E_RED, "Cyan");
+    TEST_ASSERT_EQUAL_INT(1, S2S_findValue(ss, "Cyan"));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findValue(ss, "Red"));
+    S2S_remove(ss, 0);
+    TEST_ASSERT_EQUAL_INT(0, S2S_findValue(ss, "Cyan"));
+    ss = S2S_append(ss, "key", "Red");
+    TEST_ASSERT_EQUAL_INT(S2S_last(ss), S2S_findValue(ss, "Red"));
+    S2S_dropValues(ss);
+    TEST_ASSERT_EQUAL_INT(S2S_last(ss), S2S_findValue(ss, "Red"));
+    S2S_free(ss);
+
+    iv = i2i_new(0);
+    for (int i = 0; i < 100; i++) iv = i2i_append(iv, i, i % 10);
+    i2i_indexValues(iv);
+    TEST_ASSERT_EQUAL_INT(3, i2i_findValue(iv, 3));
+    i2i_setKeyValue(iv, 3, 3, 42);
+    TEST_ASSERT_EQUAL_INT(13, i2i_findValue(iv, 3));
+    TEST_ASSERT_EQUAL_INT(3, i2i_findValue(iv, 42));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findValue(iv, 10));
+    i2i_free(iv);
+
+    // One value in nearly all elements, changed at both ends and between
+    is = I2S_new(0);
+    for (int i = 0; i < 20000; i++) is = I2S_append(is, i, "");
+    I2S_indexValues(is);
+    TEST_ASSERT_EQUAL_INT(0, I2S_findValue(is, ""));
+    I2S_setValue(is, 0, "x");
+    I2S_setValue(is, 19999, "x");
+    I2S_setValue(is, 10000, "x");
+    TEST_ASSERT_EQUAL_INT(1, I2S_findValue(is, ""));
+    TEST_ASSERT_EQUAL_INT(0, I2S_findValue(is, "x"));
+    for (int i = 1; i < 20000; i += 2) I2S_setValue(is, i, "x");
+    I2S_setValue(is, 0, "");
+    I2S_setValue(is, 5001, "");
+    TEST_ASSERT_EQUAL_INT(0, I2S_findValue(is, ""));
+    TEST_ASSERT_EQUAL_INT(1, I2S_findValue(is, "x"));
+    for (int i = 0; i < 6; i++) I2S_remove(is, 0);
+    is = I2S_append(is, 20000, "y");
+    TEST_ASSERT_EQUAL_INT(reverse_scan(is, ""), I2S_findValue(is, ""));
+    TEST_ASSERT_EQUAL_INT(reverse_scan(is, "x"), I2S_findValue(is, "x"));
+    TEST_ASSERT_EQUAL_INT(19994, I2S_findValue(is, "y"));
+    I2S_free(is);
+}
+
+#define SHARED_KEYS 16
+#define SHARED_READERS 3
+#define SHARED_VERSIONS 300
+
+static s2s_shared *shared;
+static int sharedDone;
+static int sharedTorn;
+
+// Every published table has the same value for all keys, a reader
+// seeing two different values has seen a table being changed
+static void *shared_reader(void *arg) {
+    char value[S2S_STRLEN];
+    S2S *db;
+
+    UNUSED(arg);
+    while (!__atomic_load_n(&sharedDone, __ATOMIC_ACQUIRE)) {
+        db = s2s_shared_read(shared);
+        for (int i = 1; i < SHARED_KEYS; i++) {
+            if (strcmp(db[i].value, db[0].value)) __atomic_add_fetch(&sharedTorn, 1, __ATOMIC_RELAXED);
+        }
+        s2s_shared_done(shared);
+
+        if (!s2s_shared_getValue(shared, "key3", value, sizeof(value))) {
+            __atomic_add_fetch(&sharedTorn, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return NULL;
+}
+
+void SHARED_test(void) {
+    pthread_t readers[SHARED_READERS];
+    char key[S2S_STRLEN];
+    char value[S2S_STRLEN];
+    S2S *db;
+
+    shared = s2s_shared_new(fgColors);
+    TEST_ASSERT_TRUE(s2s_shared_getValue(shared, E_CYAN, value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("Cyan", value);
+    TEST_ASSERT_TRUE(s2s_shared_getValue(shared, E_CYAN, value, 3));
+    TEST_ASSERT_EQUAL_STRING("Cy", value);
+    TEST_ASSERT_FALSE(s2s_shared_getValue(shared, "Cyan", value, sizeof(value)));
+
+    s2s_shared_setValue(shared, E_CYAN, "Turquoise");
+    TEST_ASSERT_TRUE(s2s_shared_getValue(shared, E_CYAN, value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("Turquoise", value);
+    TEST_ASSERT_EQUAL_STRING("Cyan", S2S_getValue(fgColors, E_CYAN));
+    TEST_ASSERT_EQUAL_INT(1, (int)shared->version);
+
+    // Nested read sections keep their tables, one too deep fails
+    db = s2s_shared_read(shared);
+    for (int i = 1; i < S2S_SHARED_NEST; i++) TEST_ASSERT_TRUE(s2s_shared_read(shared) == db);
+    TEST_ASSERT_NULL(s2s_shared_read(shared));
+    TEST_ASSERT_FALSE(s2s_shared_getValue(shared, E_CYAN, value, sizeof(value)));
+    for (int i = 0; i < S2S_SHARED_NEST; i++) s2s_shared_done(shared);
+    TEST_ASSERT_TRUE(s2s_shared_getValue(shared, E_CYAN, value, sizeof(value)));
+    s2s_shared_free(shared);
+
+    db = S2S_new(SHARED_KEYS);
+    for (int i = 0; i < SHARED_KEYS; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        S2S_setKeyValue(db, i, key, "v0");
+    }
+    shared = s2s_shared_new(db);
+    S2S_free(db);
+
+    sharedDone = 0;
+    sharedTorn = 0;
+    for (int i = 0; i < SHARED_READERS; i++) pthread_create(&readers[i], NULL, shared_reader, NULL);
+    for (int v = 1; v <= SHARED_VERSIONS; v++) {
+        db = s2s_shared_copy(shared);
+        snprintf(value, sizeof(value), "v%d", v);
+        for (int i = 0; i < SHARED_KEYS; i++) S2S_setValue(db, db[i].key, value);
+        s2s_shared_publish(shared, db);
+    }
+    __atomic_store_n(&sharedDone, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < SHARED_READERS; i++) pthread_join(readers[i], NULL);
+
+    TEST_ASSERT_EQUAL_INT(0, sharedTorn);
+    TEST_ASSERT_TRUE(s2s_shared_getValue(shared, "key15", value, sizeof(value)));
+    TEST_ASSERT_EQUAL_STRING("v300", value);
+    s2s_shared_free(shared);
+}
+
+// Table type of the test only, 64 bit keys to doubles
+typedef struct {
+    uint64_t key;
+    double value;
+} u2d;
+
+#define U2D_LAST UINT64_MAX
+
+#define DBT_SCOPE static __attribute__((unused))
+#define DBT_PREFIX u2d
+#define DBT_TYPE u2d
+#define DBT_KEY uint64_t
+#define DBT_VAL double
+#define DBT_GET double
+#define DBT_NONE 0.0
+#define DBT_IS_LAST(e) ((e)->key == U2D_LAST)
+#define DBT_SET_LAST(e) ((e)->key = U2D_LAST)
+#define DBT_KEY_EQ(e, k) ((e)->key == (k))
+#define DBT_VAL_EQ(e, v) ((e)->value == (v))
+#define DBT_KEY_SET(e, k) ((e)->key = (k))
+#define DBT_VAL_SET(e, v) ((e)->value = (v))
+#define DBT_VAL_HASH(v) dbvalue_hash((const char *)&(v), sizeof(double))
+#define DBT_PRINT(e) printf("%20lu   %f\n", (unsigned long)(e)->key, (e)->value)
+#include "dbtable.h"
+
+void TABLE_test(void) {
+    u2d fixed[] = {{10, 0.5}, {1ull << 40, 2.5}, {30, 0.5}, {U2D_LAST, 0}};
+    u2d *db;
+
+    // Same operations as i2i, on a table of another type
+    TEST_ASSERT_EQUAL_INT(3, u2d_len(fixed));
+    TEST_ASSERT_EQUAL_INT(1, u2d_findKey(fixed, 1ull << 40));
+    TEST_ASSERT_EQUAL_INT(-1, u2d_findKey(fixed, 20));
+    TEST_ASSERT_EQUAL_INT(0, u2d_findValue(fixed, 0.5));
+    TEST_ASSERT_TRUE(u2d_getValue(fixed, 30) == 0.5);
+    TEST_ASSERT_TRUE(u2d_getValue(fixed, 20) == 0.0);
+
+    db = u2d_copy(fixed);
+    for (uint64_t i = 0; i < 200; i++) {
+        db = u2d_append(db, i << 33, (double)(i % 50) / 4);
+    }
+    TEST_ASSERT_EQUAL_INT(203, u2d_len(db));
+    TEST_ASSERT_EQUAL_INT(202, u2d_last(db));
+    TEST_ASSERT_EQUAL_INT(4, u2d_findKey(db, 1ull << 33));
+
+    // Value index gives the same answers as the scan
+    TEST_ASSERT_TRUE(u2d_indexValues(db) > 0);
+    u2d_setValue(db, 10, 99.0);
+    u2d_setKeyValue(db, 2, 31, 0.5);
+    u2d_remove(db, 0);
+    TEST_ASSERT_EQUAL_INT(202, u2d_len(db));
+    TEST_ASSERT_EQUAL_INT(1, u2d_findValue(db, 0.5));
+    TEST_ASSERT_EQUAL_INT(-1, u2d_findValue(db, 99.0));
+    TEST_ASSERT_EQUAL_INT(6, u2d_findValue(db, 1.0));
+    u2d_dropValues(db);
+    TEST_ASSERT_EQUAL_INT(6, u2d_findValue(db, 1.0));
+    TEST_ASSERT_EQUAL_INT(1, u2d_findKey(db, 31));
+    TEST_ASSERT_TRUE(u2d_getValue(db, 31) == 0.5);
+    u2d_free(db);
+}
+
+// Position of key found by scanning, to check the frozen lookup against
+static int keys_scan(i2i *db, int len, int key) {
+    for (int i = 0; i < len; i++) {
+        if (db[i].key == key) return i;
+    }
+    return -1;
+}
+
+void KEYS_test(void) {
+    i2i small[] = {{5, 50}, {0, 1}, {-3, 30}, {5, 51}, {I2I_END}};
+    int level = dbkeys_simd_level();
+    i2i *db;
+
+    // Static table, packed keys
+    i2i_register(small);
+    i2i_freeze(small);
+    TEST_ASSERT_FALSE(((dbkeys *)dbinfo_get(small)->keys)->sorted);
+    TEST_ASSERT_EQUAL_INT(0, i2i_findKey(small, 5));
+    TEST_ASSERT_EQUAL_INT(1, i2i_findKey(small, 0));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findKey(small, 7));
+    TEST_ASSERT_EQUAL_INT(30, i2i_getValue(small, -3));
+    i2i_unregister(small);
+    TEST_ASSERT_NULL(dbinfo_get(small));
+
+    // Every implementation, packed and sorted sizes, duplicate keys and
+    // keys equal to the padding
+    for (int l = DBKEYS_SIMD_SCALAR; l <= DBKEYS_SIMD_AVX2; l++) {
+        if (dbkeys_simd_set(l) != l) continue;
+
+        for (int len = 0; len <= 2 * DBKEYS_PACKED; len += (len < 20) ? 1 : 13) {
+            db = i2i_new(len);
+            for (int i = 0; i < len; i++) i2i_setKeyValue(db, i, (i * 7) % 23 - 5, i);
+            i2i_freeze(db);
+            TEST_ASSERT_EQUAL(len > DBKEYS_PACKED, ((dbkeys *)dbinfo_get(db)->keys)->sorted);
+            for (int key = -8; key < 22; key++) {
+                TEST_ASSERT_EQUAL_INT(keys_scan(db, len, key), i2i_findKey(db, key));
+            }
+            i2i_free(db);
+        }
+    }
+    dbkeys_simd_set(level);
+
+    // Changing keys thaws
+    db = i2i_new(3);
+    for (int i = 0; i < 3; i++) i2i_setKeyValue(db, i, i + 10, i);
+    i2i_freeze(db);
+    i2i_setValue(db, 11, 7);
+    TEST_ASSERT_NOT_NULL(dbinfo_get(db)->keys);
+    db = i2i_append(db, 20, 8);
+    TEST_ASSERT_NULL(dbinfo_get(db)->keys);
+    TEST_ASSERT_EQUAL_INT(3, i2i_findKey(db, 20));
+    TEST_ASSERT_EQUAL_INT(7, i2i_getValue(db, 11));
+    i2i_free(db);
+}
+
+void DBFILE_test(void) {
+    I2S codes[] = {{404, "Not Found"}, {200, "OK"}, {-7, "Error"}, {404, "Gone"}, {500, "Not Found"}, {I2S_END}};
+    S2S names[] = {{"ENOENT", "No such file"}, {"", "empty"}, {"EPERM", "Not permitted"},
+                   {"ENOENT", "Again"}, {S2S_END}};
+    i2i empty[] = {{I2I_END}};
+    char longPath[4096];
+    char path[64];
+    dbfile *f;
+    i2i *db;
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "/tmp/deftest-%d.db", (int)getpid());
+
+    // I2S, first of equal keys found, strings stored once
+    TEST_ASSERT_EQUAL_INT(0, dbfile_writeI2S(path, codes));
+    f = dbfile_open(path);
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(DBFILE_I2S, dbfile_type(f));
+    TEST_ASSERT_EQUAL_INT(5, dbfile_len(f));
+    TEST_ASSERT_EQUAL_STRING("Not Found", dbfile_getI2S(f, 404));
+    TEST_ASSERT_EQUAL_STRING("OK", dbfile_getI2S(f, 200));
+    TEST_ASSERT_EQUAL_STRING("Error", dbfile_getI2S(f, -7));
+    TEST_ASSERT_NULL(dbfile_getI2S(f, 403));
+    TEST_ASSERT_EQUAL_INT(-1, dbfile_findStr(f, "OK"));
+    TEST_ASSERT_EQUAL_PTR(dbfile_getI2S(f, 404), dbfile_getI2S(f, 500));
+    TEST_ASSERT_EQUAL_INT(-7, dbfile_keyInt(f, 0));
+    TEST_ASSERT_NULL(dbfile_valueStr(f, 5));
+    dbfile_close(f);
+
+    // S2S, empty key is a key like any other
+    TEST_ASSERT_EQUAL_INT(0, dbfile_writeS2S(path, names));
+    f = dbfile_open(path);
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(DBFILE_S2S, dbfile_type(f));
+    TEST_ASSERT_EQUAL_STRING("No such file", dbfile_getS2S(f, "ENOENT"));
+    TEST_ASSERT_EQUAL_STRING("Not permitted", dbfile_getS2S(f, "EPERM"));
+    TEST_ASSERT_EQUAL_STRING("empty", dbfile_getS2S(f, ""));
+    TEST_ASSERT_NULL(dbfile_getS2S(f, "EIO"));
+    TEST_ASSERT_EQUAL_INT(-1, dbfile_findInt(f, 0));
+    TEST_ASSERT_EQUAL_STRING("", dbfile_keyStr(f, 0));
+    dbfile_close(f);
+
+    // i2i, every key of a larger table and an empty one
+    db = i2i_new(1000);
+    for (int i = 0; i < 1000; i++) i2i_setKeyValue(db, i, i * 7919 - 500000, i);
+    TEST_ASSERT_EQUAL_INT(0, dbfile_writei2i(path, db));
+    f = dbfile_open(path);
+    TEST_ASSERT_NOT_NULL(f);
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_EQUAL_INT(i, dbfile_geti2i(f, i * 7919 - 500000));
+    }
+    TEST_ASSERT_EQUAL_INT(-1, dbfile_findInt(f, 1));
+    dbfile_close(f);
+    i2i_free(db);
+
+    TEST_ASSERT_EQUAL_INT(0, dbfile_writei2i(path, empty));
+    f = dbfile_open(path);
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL_INT(0, dbfile_len(f));
+    TEST_ASSERT_EQUAL_INT(-1, dbfile_findInt(f, 0));
+    dbfile_close(f);
+
+    // Not a table file
+    fp = fopen(path, "w");
+    fputs("DBF0 not a table file, long enough to hold a header", fp);
+    fclose(fp);
+    errno = 0;
+    TEST_ASSERT_NULL(dbfile_open(path));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+
+    // Truncated
+    TEST_ASSERT_EQUAL_INT(0, dbfile_writeI2S(path, codes));
+    TEST_ASSERT_EQUAL_INT(0, truncate(path, 60));
+    errno = 0;
+    TEST_ASSERT_NULL(dbfile_open(path));
+    TEST_ASSERT_EQUAL_INT(EINVAL, errno);
+
+    unlink(path);
+    TEST_ASSERT_NULL(dbfile_open(path));
+    TEST_ASSERT_EQUAL_INT(ENOENT, errno);
+
+    // No room for the temporary name
+    memset(longPath, 'x', sizeof(longPath) - 1);
+    longPath[sizeof(longPath) - 1] = '\0';
+    TEST_ASSERT_EQUAL_INT(-1, dbfile_writeI2S(longPath, codes));
+    TEST_ASSERT_EQUAL_INT(ENAMETOOLONG, errno);
+}
+
+void BATCH_test(void) {
+    i2i small[] = {{4, 40}, {2, 20}, {4, 41}, {I2I_END}};
+    int keys[300], values[300], idx[300];
+    char names[40][16], *names_p[40], *found[40];
+    I2S *codes;
+    S2S *sdb;
+    i2i *db;
+
+    // Few keys on a table not frozen are scanned for
+    keys[0] = 4;
+    keys[1] = 3;
+    TEST_ASSERT_EQUAL_INT(1, i2i_findKeys(small, keys, 2, idx));
+    TEST_ASSERT_EQUAL_INT(0, idx[0]);
+    TEST_ASSERT_EQUAL_INT(-1, idx[1]);
+    TEST_ASSERT_NULL(dbinfo_get(small));
+
+    // Built tables, packed and sorted key index, duplicate keys
+    for (int len = 0; len <= 150; len += 30) {
+        for (int i = 0; i < len; i++) {
+            keys[i] = (i * 7) % 101 - 50;
+            values[i] = i;
+        }
+        db = i2i_build(keys, values, len);
+        TEST_ASSERT_EQUAL_INT(len, i2i_len(db));
+        TEST_ASSERT_NOT_NULL(dbinfo_get(db)->keys);
+
+        for (int i = 0; i < 300; i++) keys[i] = i - 150;
+        i2i_findKeys(db, keys, 300, idx);
+        for (int i = 0; i < 300; i++) {
+            TEST_ASSERT_EQUAL_INT(keys_scan(db, len, keys[i]), idx[i]);
+        }
+        i2i_getValues(db, keys, 300, values);
+        for (int i = 0; i < 300; i++) {
+            TEST_ASSERT_EQUAL_INT(i2i_getValue(db, keys[i]), values[i]);
+        }
+        i2i_free(db);
+    }
+
+    // A batch leaves a table that is not frozen as is
+    db = i2i_new(200);
+    for (int i = 0; i < 200; i++) i2i_setKeyValue(db, i, 1000 - i, i);
+    for (int i = 0; i < 20; i++) keys[i] = 1000 - i * 11;
+    TEST_ASSERT_EQUAL_INT(19, i2i_findKeys(db, keys, 20, idx));
+    TEST_ASSERT_NULL(dbinfo_get(db)->keys);
+    TEST_ASSERT_EQUAL_INT(187, idx[17]);
+    TEST_ASSERT_EQUAL_INT(-1, idx[19]);
+    i2i_getValues(db, keys, 20, values);
+    TEST_ASSERT_NULL(dbinfo_get(db)->keys);
+    TEST_ASSERT_EQUAL_INT(187, values[17]);
+    i2i_free(db);
+
+    // I2S and S2S, keys outside the shared prefix and longer than any
+    for (int i = 0; i < 40; i++) {
+        snprintf(names[i], sizeof(names[i]), "name%02d", i);
+        names_p[i] = names[i];
+        keys[i] = i;
+    }
+    codes = I2S_build(keys, names_p, 40);
+    keys[0] = -5;
+    TEST_ASSERT_EQUAL_INT(39, I2S_getValues(codes, keys, 40, found));
+    TEST_ASSERT_NULL(found[0]);
+    TEST_ASSERT_EQUAL_STRING("name39", found[39]);
+    I2S_free(codes);
+
+    sdb = S2S_build(names_p, names_p, 40);
+    strcpy(names[0], "nam");
+    strcpy(names[1], "other");
+    strcpy(names[2], "name02 and more");
+    TEST_ASSERT_EQUAL_INT(37, S2S_findKeys(sdb, names_p, 40, idx));
+    TEST_ASSERT_EQUAL_INT(-1, idx[0]);
+    TEST_ASSERT_EQUAL_INT(-1, idx[1]);
+    TEST_ASSERT_EQUAL_INT(-1, idx[2]);
+    TEST_ASSERT_EQUAL_INT(3, idx[3]);
+    S2S_getValues(sdb, names_p, 40, found);
+    TEST_ASSERT_NULL(found[1]);
+    TEST_ASSERT_EQUAL_STRING("name17", found[17]);
+    S2S_free(sdb);
+}
+
+void REMOVE_test(void) {
+    i2i fixed[] = {{1, 10}, {2, 20}, {1, 11}, {3, 30}, {4, 40}, {5, 50}, {6, 60}, {7, 70}, {8, 80}, {I2I_END}};
+    int live[2000];
+    char key[S2S_STRLEN];
+    S2S *sdb;
+    I2SC *c;
+    I2S *idb;
+    i2i *db;
+
+    // Static table, removed elements left in place once registered
+    i2i_register(fixed);
+    TEST_ASSERT_EQUAL_INT(0, i2i_removeKey(fixed, 1));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_removeKey(fixed, 9));
+    TEST_ASSERT_EQUAL_INT(9, i2i_len(fixed));
+    TEST_ASSERT_EQUAL_INT(2, i2i_findKey(fixed, 1));
+    TEST_ASSERT_EQUAL_INT(11, i2i_getValue(fixed, 1));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findValue(fixed, 10));
+    TEST_ASSERT_EQUAL_INT(1, dbinfo_get(fixed)->dead);
+    TEST_ASSERT_EQUAL_INT(0, i2i_removeKey(fixed, 1));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findKey(fixed, 1));
+    TEST_ASSERT_EQUAL_INT(2, i2i_compact(fixed));
+    TEST_ASSERT_EQUAL_INT(0, dbinfo_get(fixed)->dead);
+    TEST_ASSERT_EQUAL_INT(7, i2i_len(fixed));
+    TEST_ASSERT_EQUAL_INT(0, i2i_findKey(fixed, 2));
+    TEST_ASSERT_EQUAL_INT(6, i2i_findKey(fixed, 8));
+    TEST_ASSERT_EQUAL_INT(0, i2i_compact(fixed));
+
+    // Unregistering compacts, later removals shift
+    i2i_removeKey(fixed, 2);
+    i2i_unregister(fixed);
+    TEST_ASSERT_NULL(dbinfo_get(fixed));
+    TEST_ASSERT_EQUAL_INT(6, i2i_len(fixed));
+    TEST_ASSERT_EQUAL_INT(0, i2i_removeKey(fixed, 3));
+    TEST_ASSERT_NULL(dbinfo_get(fixed));
+    TEST_ASSERT_EQUAL_INT(5, i2i_len(fixed));
+    TEST_ASSERT_EQUAL_INT(0, i2i_findKey(fixed, 4));
+
+    // Compacted automatically once more than a quarter are removed
+    db = i2i_new(100);
+    for (int i = 0; i < 100; i++) i2i_setKeyValue(db, i, i, i);
+    for (int i = 0; i < 25; i++) i2i_removeKey(db, i * 4);
+    TEST_ASSERT_EQUAL_INT(100, i2i_len(db));
+    TEST_ASSERT_EQUAL_INT(25, dbinfo_get(db)->dead);
+    i2i_removeKey(db, 1);
+    TEST_ASSERT_EQUAL_INT(74, i2i_len(db));
+    TEST_ASSERT_EQUAL_INT(0, dbinfo_get(db)->dead);
+    TEST_ASSERT_EQUAL_INT(0, i2i_findKey(db, 2));
+    TEST_ASSERT_EQUAL_INT(73, i2i_findKey(db, 99));
+
+    // Writing a removed element revives it
+    i2i_removeKey(db, 2);
+    i2i_setKeyValue(db, 0, 200, 1);
+    TEST_ASSERT_EQUAL_INT(0, dbinfo_get(db)->dead);
+    i2i_free(db);
+
+    // Value index built while removed elements are left, rebuilt by remove
+    db = i2i_new(10);
+    for (int i = 0; i < 10; i++) i2i_setKeyValue(db, i, i, i * 10);
+    i2i_removeKey(db, 3);
+    i2i_indexValues(db);
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findValue(db, 30));
+    TEST_ASSERT_EQUAL_INT(4, i2i_findValue(db, 40));
+    i2i_remove(db, 0);
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findValue(db, 30));
+    TEST_ASSERT_EQUAL_INT(3, i2i_findValue(db, 40));
+    i2i_setKeyValue(db, 2, 3, 30);
+    TEST_ASSERT_EQUAL_INT(2, i2i_findValue(db, 30));
+    i2i_free(db);
+
+    sdb = S2S_copy(fgColors);
+    S2S_removeKey(sdb, E_RED);
+    S2S_indexValues(sdb);
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findValue(sdb, "Red"));
+    TEST_ASSERT_EQUAL_INT(2, S2S_findValue(sdb, "Green"));
+    S2S_free(sdb);
+
+    // Frozen, packed and sorted keys, and value index kept up to date,
+    // against a model of which elements are left
+    for (int len = 40; len <= 2000; len += 1960) {
+        db = i2i_new(len);
+        for (int i = 0; i < len; i++) {
+            i2i_setKeyValue(db, i, i % (len / 2), i);
+            live[i] = 1;
+        }
+        i2i_freeze(db);
+        i2i_indexValues(db);
+        for (int i = 0; i < len / 5; i++) {
+            i2i_removeKey(db, (i * 7) % (len / 2));
+            for (int j = 0; j < len; j++) {
+                if (live[j] && (j % (len / 2) == (i * 7) % (len / 2))) {
+                    live[j] = 0;
+                    break;
+                }
+            }
+        }
+        TEST_ASSERT_NOT_NULL(dbinfo_get(db)->keys);
+        TEST_ASSERT_EQUAL_INT(len, i2i_len(db));
+        for (int k = 0; k < len / 2; k++) {
+            int expect = -1;
+
+            for (int j = 0; j < len; j++) {
+                if (live[j] && (j % (len / 2) == k)) {
+                    expect = j;
+                    break;
+                }
+            }
+            TEST_ASSERT_EQUAL_INT(expect, i2i_findKey(db, k));
+            if (expect >= 0) TEST_ASSERT_EQUAL_INT(expect, i2i_findValue(db, expect));
+        }
+        TEST_ASSERT_EQUAL_INT(len / 5, i2i_compact(db));
+        TEST_ASSERT_NOT_NULL(dbinfo_get(db)->keys);
+        TEST_ASSERT_EQUAL_INT(len - len / 5, i2i_len(db));
+        i2i_free(db);
+    }
+
+    // S2S, keys longer than the prefix the index keeps, the first
+    // element holding the shared prefix removed
+    sdb = S2S_new(0);
+    for (int i = 0; i < 50; i++) {
+        snprintf(key, sizeof(key), "common/prefix/%02d/long-key", i % 25);
+        sdb = S2S_append(sdb, key, key);
+    }
+    S2S_freeze(sdb);
+    S2S_removeKey(sdb, "common/prefix/00/long-key");
+    S2S_removeKey(sdb, "common/prefix/07/long-key");
+    S2S_removeKey(sdb, "common/prefix/07/long-key");
+    TEST_ASSERT_NOT_NULL(dbinfo_get(sdb)->keys);
+    TEST_ASSERT_EQUAL_INT(25, S2S_findKey(sdb, "common/prefix/00/long-key"));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(sdb, "common/prefix/07/long-key"));
+    TEST_ASSERT_EQUAL_INT(24, S2S_findKey(sdb, "common/prefix/24/long-key"));
+    S2S_thaw(sdb);
+    S2S_freeze(sdb);
+    TEST_ASSERT_EQUAL_INT(25, S2S_findKey(sdb, "common/prefix/00/long-key"));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(sdb, "common/prefix/07/long-key"));
+    TEST_ASSERT_EQUAL_INT(3, S2S_compact(sdb));
+    TEST_ASSERT_EQUAL_INT(23, S2S_findKey(sdb, "common/prefix/00/long-key"));
+    TEST_ASSERT_EQUAL_INT(22, S2S_findKey(sdb, "common/prefix/24/long-key"));
+    S2S_free(sdb);
+
+    // No key is reserved for removed elements
+    db = i2i_new(4);
+    i2i_setKeyValue(db, 0, 1, 10);
+    i2i_setKeyValue(db, 1, 2, 20);
+    i2i_setKeyValue(db, 2, INT_MIN, 30);
+    i2i_setKeyValue(db, 3, 4, 40);
+    TEST_ASSERT_EQUAL_INT(0, i2i_removeKey(db, 2));
+    TEST_ASSERT_TRUE(i2i_isRemoved(db, 1));
+    TEST_ASSERT_FALSE(i2i_isRemoved(db, 2));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findKey(db, 2));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_removeKey(db, 2));
+    TEST_ASSERT_EQUAL_INT(1, dbinfo_get(db)->dead);
+    TEST_ASSERT_EQUAL_INT(2, i2i_findKey(db, INT_MIN));
+    TEST_ASSERT_EQUAL_INT(30, i2i_getValue(db, INT_MIN));
+    TEST_ASSERT_EQUAL_INT(2, i2i_findValue(db, 30));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findValue(db, 20));
+    i2i_freeze(db);
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findKey(db, 2));
+    TEST_ASSERT_EQUAL_INT(2, i2i_findKey(db, INT_MIN));
+    TEST_ASSERT_EQUAL_INT(0, i2i_removeKey(db, INT_MIN));
+    TEST_ASSERT_EQUAL_INT(2, i2i_len(db));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findKey(db, INT_MIN));
+    TEST_ASSERT_EQUAL_INT(1, i2i_findKey(db, 4));
+    i2i_free(db);
+
+    sdb = S2S_new(5);
+    S2S_setKeyValue(sdb, 0, "#T@mb!key", "a");
+    S2S_setKeyValue(sdb, 1, "removed-key", "b");
+    S2S_setKeyValue(sdb, 2, "c", "c");
+    S2S_setKeyValue(sdb, 3, "d", "d");
+    S2S_setKeyValue(sdb, 4, "e", "e");
+    TEST_ASSERT_EQUAL_INT(0, S2S_removeKey(sdb, "removed-key"));
+    TEST_ASSERT_EQUAL_INT(0, S2S_findKey(sdb, "#T@mb!key"));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(sdb, "removed-key"));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findValue(sdb, "b"));
+    S2S_freeze(sdb);
+    TEST_ASSERT_EQUAL_INT(0, S2S_findKey(sdb, "#T@mb!key"));
+    TEST_ASSERT_EQUAL_INT(-1, S2S_findKey(sdb, "removed-key"));
+    TEST_ASSERT_EQUAL_INT(1, S2S_compact(sdb));
+    TEST_ASSERT_EQUAL_INT(1, S2S_findKey(sdb, "c"));
+    S2S_free(sdb);
+
+    // Marks move down with the elements, across words of the bitmap
+    db = i2i_new(70);
+    for (int i = 0; i < 70; i++) i2i_setKeyValue(db, i, i, i);
+    i2i_removeKey(db, 10);
+    i2i_removeKey(db, 65);
+    i2i_remove(db, 0);
+    TEST_ASSERT_TRUE(i2i_isRemoved(db, 9));
+    TEST_ASSERT_TRUE(i2i_isRemoved(db, 64));
+    TEST_ASSERT_FALSE(i2i_isRemoved(db, 10));
+    TEST_ASSERT_FALSE(i2i_isRemoved(db, 63));
+    TEST_ASSERT_FALSE(i2i_isRemoved(db, 65));
+    TEST_ASSERT_EQUAL_INT(-1, i2i_findKey(db, 65));
+    TEST_ASSERT_EQUAL_INT(63, i2i_findKey(db, 64));
+    TEST_ASSERT_EQUAL_INT(65, i2i_findKey(db, 66));
+    i2i_remove(db, 9);
+    TEST_ASSERT_EQUAL_INT(1, dbinfo_get(db)->dead);
+    TEST_ASSERT_TRUE(i2i_isRemoved(db, 63));
+    i2i_free(db);
+
+    // Removed elements are not converted
+    idb = I2S_new(0);
+    idb = I2S_append(idb, 1, "one");
+    idb = I2S_append(idb, 2, "two");
+    idb = I2S_append(idb, 3, "three");
+    idb = I2S_append(idb, 4, "four");
+    I2S_removeKey(idb, 2);
+    c = I2SC_fromI2S(idb);
+    TEST_ASSERT_EQUAL_INT(3, I2SC_len(c));
+    TEST_ASSERT_EQUAL_INT(-1, I2SC_findKey(c, 2));
+    TEST_ASSERT_EQUAL_STRING("three", I2SC_getValue(c, 3));
+    I2SC_free(c);
+    I2S_free(idb);
+}
+
 void defTest(void) {
     TEST_ASSERT_EQUAL_INT(10, Max(10, 5));
     TEST_ASSERT_EQUAL_INT(10, Max(5, 10));
@@ -237,6 +1277,624 @@ void defTest(void) {
     TEST_ASSERT_FALSE(isOutside(5, -10, 10));
 }
 
+void MSTR_test(void) {
+    mstr *s;
+    mstr_sso local;
+
+    s = mstr_newl(4);
+    TEST_ASSERT_TRUE(mstr_is_inline(s));
+    TEST_ASSERT_EQUAL_INT(0, mstr_len(s));
+    TEST_ASSERT_EQUAL_STRING("", s->str);
+
+    mstr_append(s, "Hello");
+    TEST_ASSERT_EQUAL_STRING("Hello", s->str);
+
+    mstr_append(s, " world, grown beyond the inline storage");
+    TEST_ASSERT_FALSE(mstr_is_inline(s));
+    TEST_ASSERT_EQUAL_STRING("Hello world, grown beyond the inline storage", s->str);
+
+    mstr_prepend(s, ">> ");
+    TEST_ASSERT_EQUAL_STRING(">> Hello world, grown beyond the inline storage", s->str);
+    mstr_free(s);
+
+    s = mstr_init(&local, "short key");
+    TEST_ASSERT_TRUE(s->str == local.sso);
+    TEST_ASSERT_EQUAL_STRING("short key", s->str);
+    mstr_insert(s, "very ", 0);
+    mstr_strip(s, "vy");
+    TEST_ASSERT_EQUAL_STRING("ery short ke", s->str);
+    mstr_append(s, " that no longer fits in the struct");
+    TEST_ASSERT_TRUE(s->str != local.sso);
+    TEST_ASSERT_EQUAL_STRING("ery short ke that no longer fits in the struct", s->str);
+    mstr_release(s);
+
+    // MSTR_SSO - 1 characters fit inline, one more does not
+    s = mstr_init(&local, "0123456789abcdefghij");
+    mstr_append(s, "klm");
+    TEST_ASSERT_EQUAL_INT(MSTR_SSO - 1, mstr_len(s));
+    TEST_ASSERT_TRUE(s->str == local.sso);
+    mstr_append(s, "n");
+    TEST_ASSERT_TRUE(s->str != local.sso);
+    TEST_ASSERT_EQUAL_STRING("0123456789abcdefghijklmn", s->str);
+    mstr_release(s);
+
+    s = mstr_newl(0);
+    for (int i = 0; i < 1000; i++) mstr_append(s, "x");
+    TEST_ASSERT_EQUAL_INT(1000, mstr_len(s));
+    TEST_ASSERT_TRUE(s->capacity < 4 * 1000);
+    mstr_shrink_to_fit(s);
+    TEST_ASSERT_TRUE(s->capacity >= 1000 + MSTR_EXTRA);
+    TEST_ASSERT_TRUE(s->capacity < 1000 + MSTR_EXTRA + 2 * MSTR_BLOCK);
+    mstr_reserve(s, 5000);
+    TEST_ASSERT_TRUE(s->capacity >= 5000);
+    TEST_ASSERT_EQUAL_INT(1000, mstr_len(s));
+    TEST_ASSERT_EQUAL_INT('x', s->str[999]);
+    TEST_ASSERT_EQUAL_INT('\0', s->str[1000]);
+    mstr_free(s);
+
+    s = mstr_new("0123456789");
+    mstr_insert(s, "ab", -1);
+    TEST_ASSERT_EQUAL_STRING("012345678ab9", s->str);
+    mstr_insert_g(s, s->str, 4, 2);
+    TEST_ASSERT_EQUAL_STRING("0101232345678ab9", s->str);
+    mstr_prepend(s, s);
+    TEST_ASSERT_EQUAL_STRING("0101232345678ab90101232345678ab9", s->str);
+    mstr_free(s);
+
+    mstr_charset cs;
+    mstr_charset_init(&cs, " ,.!\xe5");
+    TEST_ASSERT_TRUE(mstr_charset_has(&cs, ','));
+    TEST_ASSERT_TRUE(mstr_charset_has(&cs, '\xe5'));
+    TEST_ASSERT_FALSE(mstr_charset_has(&cs, 'a'));
+
+    s = mstr_new("  ,!! ..   A more...advanced,,, stripping..  ..,,,     ");
+    mstr_strip_set(s, &cs);
+    TEST_ASSERT_EQUAL_STRING("A more...advanced,,, stripping", s->str);
+    mstr_clear(s);
+    mstr_append(s, "\xe5\xe5 text \xe5");
+    mstr_rstrip_set(s, &cs);
+    TEST_ASSERT_EQUAL_STRING("text \xe5", s->str);
+    mstr_lstrip_set(s, &cs);
+    TEST_ASSERT_EQUAL_STRING("text", s->str);
+    mstr_clear(s);
+    mstr_append(s, "     ");
+    mstr_strip(s, " ");
+    TEST_ASSERT_EQUAL_STRING("", s->str);
+    TEST_ASSERT_EQUAL_INT(0, mstr_len(s));
+    mstr_append(s, "xxx");
+    mstr_lstrip(s, "x");
+    TEST_ASSERT_EQUAL_STRING("", s->str);
+    TEST_ASSERT_EQUAL_INT(0, mstr_len(s));
+    mstr_append(s, "xxx");
+    mstr_rstrip(s, "x");
+    TEST_ASSERT_EQUAL_STRING("", s->str);
+    mstr_free(s);
+}
+
+void MSTR_simd_test(void) {
+    char *samples[] = {"abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ",
+                       "0123456789012345678901234567890123456789", " \t\n\v\f\r  \t\n\v\f\r  \t\n\v\f\r  \t\n",
+                       "abc123DEF456ghi789JKL012mno345PQR678", "@[`{/:", "\xe5\xe4\xf6" "abcdefghijklmnopqrstuvwxyz\xc5",
+                       "HeLlo WoRlD, mixed Case text that spans more than 32 bytes", ""};
+    unsigned int seed = 1;
+
+    for (int level = MSTR_SIMD_NONE; level <= MSTR_SIMD_AVX2; level++) {
+        for (int n = 0; n < 2000; n++) {
+            char buf[80];
+            char ref_upper[80], ref_lower[80];
+            bool ref[4];
+            mstr *s;
+            size_t len;
+
+            if (n < 8) {
+                strcpy(buf, samples[n]);
+            } else {
+                // random strings drawn from one sample, with some random bytes
+                char *src = samples[n % 8];
+                len = seed % 70;
+                for (size_t i = 0; i < len; i++) {
+                    seed = seed * 1103515245 + 12345;
+                    buf[i] = (src[0] && (seed >> 16) % 16) ? src[(seed >> 8) % strlen(src)] : (char)((seed >> 16) & 0xFF);
+                    if (buf[i] == '\0') buf[i] = 'x';
+                }
+                buf[len] = '\0';
+            }
+
+            mstr_simd_set(MSTR_SIMD_NONE);
+            s = mstr_new(buf);
+            ref[0] = mstr_is_alpha(s);
+            ref[1] = mstr_is_numeric(s);
+            ref[2] = mstr_is_alnum(s);
+            ref[3] = mstr_is_space(s);
+            mstr_upper(s);
+            strcpy(ref_upper, s->str);
+            mstr_lower(s);
+            strcpy(ref_lower, s->str);
+            mstr_free(s);
+
+            mstr_simd_set(level);
+            s = mstr_new(buf);
+            TEST_ASSERT_EQUAL_INT(ref[0], mstr_is_alpha(s));
+            TEST_ASSERT_EQUAL_INT(ref[1], mstr_is_numeric(s));
+            TEST_ASSERT_EQUAL_INT(ref[2], mstr_is_alnum(s));
+            TEST_ASSERT_EQUAL_INT(ref[3], mstr_is_space(s));
+            mstr_upper(s);
+            TEST_ASSERT_EQUAL_STRING(ref_upper, s->str);
+            mstr_lower(s);
+            TEST_ASSERT_EQUAL_STRING(ref_lower, s->str);
+            mstr_free(s);
+        }
+    }
+    mstr_simd_set(-1);
+}
+
+void MSTR_find_test(void) {
+    char text[4096];
+    int pos[8];
+    mstr *s;
+
+    s = mstr_new("A field with a flower, a tree and a bush");
+    TEST_ASSERT_EQUAL_INT(0, mstr_find(s, "A"));
+    TEST_ASSERT_EQUAL_INT(23, mstr_find(s, "a tree"));
+    TEST_ASSERT_EQUAL_INT(-1, mstr_find(s, "a treex"));
+    TEST_ASSERT_EQUAL_INT(36, mstr_find(s, "bush"));
+    TEST_ASSERT_EQUAL_INT(-1, mstr_find_g(s, "A", 1, 1));
+    TEST_ASSERT_EQUAL_INT(3, mstr_find_all(s, "a ", pos, 8));
+    TEST_ASSERT_EQUAL_INT(13, pos[0]);
+    TEST_ASSERT_EQUAL_INT(23, pos[1]);
+    TEST_ASSERT_EQUAL_INT(34, pos[2]);
+
+    TEST_ASSERT_EQUAL_INT(1, mstr_replace(s, "a tree", "an oak"));
+    TEST_ASSERT_EQUAL_STRING("A field with a flower, an oak and a bush", s->str);
+    TEST_ASSERT_EQUAL_INT(5, mstr_replace(s, "a", ""));
+    TEST_ASSERT_EQUAL_STRING("A field with  flower, n ok nd  bush", s->str);
+    TEST_ASSERT_EQUAL_INT(2, mstr_replace(s, "  ", " - "));
+    TEST_ASSERT_EQUAL_STRING("A field with - flower, n ok nd - bush", s->str);
+    TEST_ASSERT_EQUAL_INT(0, mstr_replace(s, "tree", "oak"));
+    mstr_free(s);
+
+    // Compare with strstr on random text, on every implementation
+    unsigned int seed = 7;
+    for (size_t i = 0; i < sizeof(text) - 1; i++) {
+        seed = seed * 1103515245 + 12345;
+        text[i] = "ab c"[(seed >> 16) % 4];
+    }
+    text[sizeof(text) - 1] = '\0';
+    s = mstr_new(text);
+
+    char *needles[] = {"ab", "aab", "abca", "c ab", "bbbbbb", "ab c aab", "a", "abcabcabcabcabcabcabcabcabcabcabcab"};
+    for (int level = MSTR_SIMD_NONE; level <= MSTR_SIMD_AVX2; level++) {
+        mstr_simd_set(level);
+        for (size_t n = 0; n < sizeof(needles) / sizeof(needles[0]); n++) {
+            size_t len = strlen(needles[n]);
+            size_t count = 0;
+            char *p = text;
+
+            while ((p = strstr(p, needles[n])) != NULL) {
+                if (count == 0) TEST_ASSERT_EQUAL_INT(p - text, mstr_find(s, needles[n]));
+                count++;
+                p += len;
+            }
+            if (count == 0) TEST_ASSERT_EQUAL_INT(-1, mstr_find(s, needles[n]));
+            TEST_ASSERT_EQUAL_INT(count, mstr_find_all(s, needles[n], NULL, 0));
+        }
+    }
+    mstr_simd_set(-1);
+    mstr_free(s);
+}
+
+void MSTR_format_test(void) {
+    int64_t ints[] = {0, 7, -7, 10, 99, 100, -12345, 1234567890123LL, INT64_MAX, INT64_MIN};
+    double dbls[] = {0.0, 1.5, -2.25, 3.14159, 1234.5678, -0.0004, 0.999, 1e15, 123456.0};
+    char ref[64];
+    mstr *s = mstr_new("");
+
+    mstr_appendf(s, "%s=%d", "x", 42);
+    TEST_ASSERT_EQUAL_STRING("x=42", s->str);
+
+    // Longer than the free space, formatted again after growing
+    mstr_appendf(s, " %0100d", 1);
+    TEST_ASSERT_EQUAL_INT(105, s->len);
+    TEST_ASSERT_EQUAL_INT('1', s->str[104]);
+    TEST_ASSERT_EQUAL_INT(105, strlen(s->str));
+
+    // Arguments pointing into the string itself, short and grown
+    mstr_clear(s);
+    mstr_append(s, "abc");
+    mstr_appendf(s, "|%s|%s", s->str, s->str + 1);
+    TEST_ASSERT_EQUAL_STRING("abc|abc|bc", s->str);
+    for (int i = 0; i < 6; i++) mstr_appendf(s, "%s%s", s->str, s->str);
+    TEST_ASSERT_EQUAL_INT(10 * 729, s->len);
+    TEST_ASSERT_EQUAL_INT(0, strncmp(s->str + 10 * 728, "abc|abc|bc", 10));
+    TEST_ASSERT_EQUAL_INT(10 * 729, strlen(s->str));
+
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        mstr_clear(s);
+        mstr_append_int(s, ints[i]);
+        snprintf(ref, sizeof(ref), "%lld", (long long)ints[i]);
+        TEST_ASSERT_EQUAL_STRING(ref, s->str);
+        TEST_ASSERT_EQUAL_INT(strlen(ref), s->len);
+
+        mstr_clear(s);
+        mstr_append_uint(s, (uint64_t)ints[i]);
+        snprintf(ref, sizeof(ref), "%llu", (unsigned long long)ints[i]);
+        TEST_ASSERT_EQUAL_STRING(ref, s->str);
+
+        mstr_clear(s);
+        mstr_append_hex(s, (uint64_t)ints[i], 4);
+        snprintf(ref, sizeof(ref), "%04llx", (unsigned long long)ints[i]);
+        TEST_ASSERT_EQUAL_STRING(ref, s->str);
+    }
+
+    for (size_t i = 0; i < sizeof(dbls) / sizeof(dbls[0]); i++) {
+        for (int d = 0; d <= 4; d++) {
+            mstr_clear(s);
+            mstr_append_fixed(s, dbls[i], d);
+            snprintf(ref, sizeof(ref), "%.*f", d, dbls[i]);
+            if ((ref[0] == '-') && (strspn(ref + 1, "0.") == strlen(ref + 1))) memmove(ref, ref + 1, strlen(ref));
+            TEST_ASSERT_EQUAL_STRING(ref, s->str);
+        }
+    }
+
+    mstr_clear(s);
+    mstr_append_fixed(s, 1e300, 2);
+    TEST_ASSERT_EQUAL_INT(304, s->len);
+    mstr_free(s);
+}
+
+static size_t utf8_encode(char *out, uint32_t cp) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xC0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xE0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+void MSTR_utf8_test(void) {
+    char *valid[] = {"", "plain ascii", "gr\xc3\xb6n", "\xe2\x82\xac 5", "\xf0\x9f\x98\x80",
+                     "\xed\x9f\xbf", "\xef\xbf\xbf", "\xf4\x8f\xbf\xbf", "\xc2\x80"};
+    char *invalid[] = {"\x80", "\xc3", "a\xc3" "a", "\xc0\xaf", "\xc1\xbf", "\xe0\x80\xaf",
+                       "\xed\xa0\x80", "\xf0\x80\x80\xaf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80",
+                       "\xff", "\xe2\x82", "\xf0\x9f\x98", "\xc3\xb6\xb6"};
+    char buf[600];
+    mstr *s = mstr_newl(600);
+
+    for (int level = MSTR_SIMD_NONE; level <= MSTR_SIMD_AVX2; level++) {
+        if (mstr_simd_set(level) != level) continue;
+
+        // At the start, and across a 32 byte block boundary
+        for (size_t pad = 0; pad < 40; pad += 13) {
+            for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+                mstr_clear(s);
+                for (size_t k = 0; k < pad; k++) mstr_append(s, "x");
+                mstr_append(s, valid[i]);
+                TEST_ASSERT_TRUE_MESSAGE(mstr_utf8_valid(s), valid[i]);
+            }
+            for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+                mstr_clear(s);
+                for (size_t k = 0; k < pad; k++) mstr_append(s, "x");
+                mstr_append(s, invalid[i]);
+                TEST_ASSERT_FALSE_MESSAGE(mstr_utf8_valid(s), invalid[i]);
+                mstr_append(s, "yy");
+                TEST_ASSERT_FALSE_MESSAGE(mstr_utf8_valid(s), invalid[i]);
+            }
+        }
+
+        mstr_clear(s);
+        mstr_append(s, "gr\xc3\xb6n \xe2\x82\xac \xe4\xb8\xad\xe6\x96\x87 \xf0\x9f\x98\x80 e\xcc\x81");
+        TEST_ASSERT_EQUAL_INT(14, mstr_utf8_len(s));
+        TEST_ASSERT_EQUAL_INT(16, mstr_utf8_width(s));
+
+        // Random code points, valid as a whole and broken by one byte
+        srand(level);
+        for (int round = 0; round < 200; round++) {
+            size_t len = 0;
+            size_t count = 0;
+            while (len < sizeof(buf) - 4) {
+                uint32_t cp;
+                int pick = rand();
+                // Any plane, around width boundaries, or mostly wide
+                if (round % 3 == 0) pick %= 4;
+                else if (round % 3 == 1) pick = 4 + pick % 4;
+                else pick = (pick % 8) ? 7 : 0;
+                switch (pick) {
+                    case 0: cp = rand() % 0x80; break;
+                    case 1: cp = 0x80 + rand() % 0x780; break;
+                    case 2: cp = 0x800 + rand() % 0xF800; break;
+                    case 3: cp = 0x10000 + rand() % 0x100000; break;
+                    // CJK and Hangul, with neighbours of different width
+                    case 4: cp = 0x4DB0 + rand() % 0x60; break;
+                    case 5: cp = 0xA4C0 + rand() % 0x20; break;
+                    case 6: cp = 0xD790 + rand() % 0x20; break;
+                    default: cp = (rand() & 1) ? 0x4E00 + rand() % 0x5200 : 0xAC00 + rand() % 0x2BA4; break;
+                }
+                if ((cp >= 0xD800) && (cp <= 0xDFFF)) continue;
+                len += utf8_encode(buf + len, cp);
+                count++;
+            }
+            mstr_clear(s);
+            mstr_append_g(s, buf, len);
+            TEST_ASSERT_TRUE(mstr_utf8_valid(s));
+            TEST_ASSERT_EQUAL_INT(count, mstr_utf8_len(s));
+            size_t width = mstr_utf8_width(s);
+            mstr_simd_set(MSTR_SIMD_NONE);
+            TEST_ASSERT_EQUAL_INT(mstr_utf8_width(s), width);
+            mstr_simd_set(level);
+
+            // Same verdict as the per byte check
+            s->str[rand() % len] = (char)(0x80 + rand() % 0x80);
+            bool ok = mstr_utf8_valid(s);
+            mstr_simd_set(MSTR_SIMD_NONE);
+            TEST_ASSERT_EQUAL_INT(mstr_utf8_valid(s), ok);
+            mstr_simd_set(level);
+        }
+    }
+    mstr_simd_set(-1);
+    mstr_free(s);
+}
+
+void MGAP_test(void) {
+    mgap *g;
+    mstr *s;
+
+    g = mgap_new("world", 0);
+    mgap_insert(g, "Hello ", 6, 0);
+    mgap_insert(g, "!", 1, mgap_len(g));
+    mgap_insert(g, "big ", 4, 6);
+    TEST_ASSERT_EQUAL_INT(16, mgap_len(g));
+    TEST_ASSERT_EQUAL_INT('b', mgap_at(g, 6));
+    TEST_ASSERT_EQUAL_INT('!', mgap_at(g, 15));
+
+    mgap_delete(g, 0, 6);
+    s = mgap_to_mstr(g);
+    TEST_ASSERT_EQUAL_STRING("big world!", s->str);
+    mstr_free(s);
+
+    for (int i = 0; i < 200; i++) mgap_insert(g, "ab", 2, 3);
+    TEST_ASSERT_EQUAL_INT(410, mgap_len(g));
+    mgap_delete(g, 3, 400);
+    s = mgap_to_mstr(g);
+    TEST_ASSERT_EQUAL_STRING("big world!", s->str);
+    mstr_free(s);
+    mgap_free(g);
+}
+
+void MVIEW_test(void) {
+    mstr_charset ws;
+    mview rest, f, fields[8];
+    mstr *s;
+    int n = 0;
+
+    mstr_charset_init(&ws, " \t\n");
+
+    // Split keeps empty fields and does not touch the source
+    s = mstr_new("id,,name, value ");
+    rest = mview_new(s);
+    while (mview_split(&rest, ',', &f)) fields[n++] = f;
+    TEST_ASSERT_EQUAL_INT(4, n);
+    TEST_ASSERT_TRUE(mview_eq_c(fields[0], "id"));
+    TEST_ASSERT_EQUAL_INT(0, fields[1].len);
+    TEST_ASSERT_TRUE(mview_eq_c(fields[2], "name"));
+    TEST_ASSERT_TRUE(mview_eq_c(mview_trim(fields[3], &ws), "value"));
+    TEST_ASSERT_TRUE(fields[2].ptr == s->str + 4);
+    TEST_ASSERT_EQUAL_STRING("id,,name, value ", s->str);
+
+    rest = mview_c("a,");
+    n = 0;
+    while (mview_split(&rest, ',', &f)) n++;
+    TEST_ASSERT_EQUAL_INT(2, n);
+
+    // Tokenize skips delimiter runs
+    rest = mview_c("  one \t two\n\nthree  ");
+    n = 0;
+    while (mview_tokenize(&rest, &ws, &f)) fields[n++] = f;
+    TEST_ASSERT_EQUAL_INT(3, n);
+    TEST_ASSERT_TRUE(mview_eq_c(fields[1], "two"));
+    TEST_ASSERT_TRUE(mview_eq_c(fields[2], "three"));
+    rest = mview_c("   ");
+    TEST_ASSERT_FALSE(mview_tokenize(&rest, &ws, &f));
+
+    // Compare, prefix and search
+    TEST_ASSERT_TRUE(mview_cmp(mview_c("abc"), mview_c("abd")) < 0);
+    TEST_ASSERT_TRUE(mview_cmp(mview_c("ab"), mview_c("abc")) < 0);
+    TEST_ASSERT_TRUE(mview_cmp(mview_c("abc"), mview_c("ab")) > 0);
+    TEST_ASSERT_EQUAL_INT(0, mview_cmp(mview_c(""), mview_g(NULL, 0)));
+    TEST_ASSERT_FALSE(mview_eq_c(mview_c("ab"), "abc"));
+    TEST_ASSERT_TRUE(mview_startswith(mview_new(s), mview_c("id,")));
+    TEST_ASSERT_EQUAL_INT(2, mview_find_c(mview_new(s), ','));
+    TEST_ASSERT_EQUAL_INT(-1, mview_find_c(mview_sub(mview_new(s), 4, 4), ','));
+    TEST_ASSERT_TRUE(mview_eq_c(mview_sub(mview_new(s), 14, 100), "e "));
+    TEST_ASSERT_EQUAL_INT(0, mview_sub(mview_new(s), 100, 2).len);
+    mstr_free(s);
+
+    // Copy out
+    s = mview_to_mstr(mview_c("hello"));
+    mview_append(s, mview_g(" world!!", 6));
+    TEST_ASSERT_EQUAL_STRING("hello world", s->str);
+    mstr_free(s);
+}
+
+void MARENA_test(void) {
+    marena *a = marena_new(256);
+    mstr *s1, *s2;
+    char *p1, *p2;
+
+    // Allocations are aligned and consecutive
+    p1 = marena_alloc(a, 3);
+    p2 = marena_alloc(a, 20);
+    TEST_ASSERT_EQUAL_INT(0, (uintptr_t)p1 % MARENA_ALIGN);
+    TEST_ASSERT_TRUE(p2 == p1 + MARENA_ALIGN);
+    TEST_ASSERT_TRUE(marena_extend(a, p2, 40));
+    TEST_ASSERT_FALSE(marena_extend(a, p1, 40));
+    TEST_ASSERT_EQUAL_INT(64, marena_used(a));
+
+    // Larger than a block gets its own block
+    p1 = marena_alloc(a, 1000);
+    memset(p1, 'x', 1000);
+
+    marena_reset(a);
+    TEST_ASSERT_EQUAL_INT(0, marena_used(a));
+    TEST_ASSERT_TRUE(marena_alloc(a, 3) == a->first->data);
+
+    // Latest string grows in place, others move their characters out
+    s1 = mstr_new_a(a, 0, "Hello");
+    p1 = s1->str;
+    mstr_append(s1, " world, this string has to grow");
+    TEST_ASSERT_TRUE(s1->str == p1);
+    s2 = mstr_new_a(a, 0, "second");
+    mstr_append(s1, ", and once more after the next string");
+    TEST_ASSERT_TRUE(s1->str != p1);
+    TEST_ASSERT_EQUAL_STRING("Hello world, this string has to grow, and once more after the next string", s1->str);
+    TEST_ASSERT_EQUAL_STRING("second", s2->str);
+
+    for (int i = 0; i < 100; i++) mstr_append(s2, "0123456789");
+    TEST_ASSERT_EQUAL_INT(1006, s2->len);
+    TEST_ASSERT_EQUAL_INT(1, mstr_replace(s2, "second", "2nd string"));
+    TEST_ASSERT_EQUAL_INT(1010, s2->len);
+    mstr_free(s1);
+    mstr_free(s2);
+
+    marena_reset(a);
+    s1 = mstr_new_a(a, 0, "reused");
+    TEST_ASSERT_TRUE((char *)s1 == a->first->data);
+    marena_free(a);
+}
+
+void MROPE_test(void) {
+    struct iovec iov[4];
+    mrope *r;
+    mstr *ref, *s;
+    char text[64];
+    size_t pos, n, total;
+
+    r = mrope_new("world");
+    mrope_insert(r, "Hello ", 6, 0);
+    mrope_insert(r, "!", 1, mrope_len(r));
+    TEST_ASSERT_EQUAL_INT(12, mrope_len(r));
+    TEST_ASSERT_EQUAL_INT('w', mrope_at(r, 6));
+    mrope_delete(r, 5, 100);
+    s = mrope_to_mstr(r);
+    TEST_ASSERT_EQUAL_STRING("Hello", s->str);
+    mstr_free(s);
+    mrope_free(r);
+
+    // Random edits of a text spanning many chunks, checked against mstr
+    ref = mstr_newl(0);
+    for (int i = 0; i < 5000; i++) mstr_append_int(ref, i);
+    r = mrope_news(ref);
+    srand(1);
+    for (int i = 0; i < 3000; i++) {
+        n = (i % 10 == 0) ? 1500 : (size_t)(rand() % 40);
+        memset(text, 'a' + (i % 26), sizeof(text));
+        pos = rand() % (ref->len + 1);
+        if (rand() % 3 == 0) {
+            mrope_delete(r, pos, n);
+            if (n > ref->len - pos) n = ref->len - pos;
+            memmove(ref->str + pos, ref->str + pos + n, ref->len - pos - n + 1);
+            ref->len -= n;
+        } else {
+            n = n % sizeof(text);
+            mrope_insert(r, text, n, pos);
+            mstr_insert_g(ref, text, n, pos);
+        }
+        TEST_ASSERT_EQUAL_INT(ref->len, mrope_len(r));
+    }
+    mrope_insert(r, ref->str, 3000, 10);
+    mstr_insert_g(ref, ref->str, 3000, 10);
+    s = mrope_to_mstr(r);
+    TEST_ASSERT_EQUAL_STRING(ref->str, s->str);
+    mstr_free(s);
+
+    // Walk the chunks a few at a time from an offset
+    pos = 100;
+    total = 0;
+    while ((n = mrope_iovec(r, &pos, iov, 4)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            TEST_ASSERT_EQUAL_MEMORY(ref->str + 100 + total, iov[i].iov_base, iov[i].iov_len);
+            total += iov[i].iov_len;
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(ref->len - 100, total);
+    TEST_ASSERT_EQUAL_INT(ref->len, pos);
+
+    mstr_free(ref);
+    mrope_free(r);
+}
+
+static void *mintern_thread(void *arg) {
+    mintern_pool *p = (mintern_pool *)arg;
+    const char **res = (const char **)malloc(2000 * sizeof(char *));
+    char buf[32];
+
+    for (int i = 0; i < 2000; i++) {
+        snprintf(buf, sizeof(buf), "tag-%d", i);
+        res[i] = mintern(p, buf);
+    }
+    return res;
+}
+
+void MINTERN_test(void) {
+    mintern_pool *p = mintern_new();
+    mintern_stats st;
+    pthread_t threads[4];
+    const char **res[4];
+    const char *a, *b;
+    mstr *s;
+    char buf[32];
+
+    a = mintern(p, "host=alpha");
+    s = mstr_new("host=alpha");
+    b = mintern(p, s);
+    TEST_ASSERT_TRUE(a == b);
+    TEST_ASSERT_TRUE(a != s->str);
+    TEST_ASSERT_EQUAL_STRING("host=alpha", a);
+    TEST_ASSERT_EQUAL_INT(10, mintern_len(a));
+    TEST_ASSERT_TRUE(mintern_g(p, "host=alpha-2", 4) != a);
+    TEST_ASSERT_TRUE(mintern_find(p, "host", 4) != NULL);
+    TEST_ASSERT_NULL(mintern_find(p, "hos", 3));
+    TEST_ASSERT_EQUAL_STRING("", mintern_g(p, "", 0));
+    mstr_free(s);
+
+    mintern_get_stats(p, &st);
+    TEST_ASSERT_EQUAL_INT(4, st.lookups);
+    TEST_ASSERT_EQUAL_INT(1, st.hits);
+    TEST_ASSERT_EQUAL_INT(3, st.strings);
+    TEST_ASSERT_EQUAL_INT(14, st.bytes);
+    TEST_ASSERT_EQUAL_INT(10, st.bytes_saved);
+
+    // Threads interning the same strings get the same pointers, growing
+    // the table on the way
+    for (int i = 0; i < 4; i++) pthread_create(&threads[i], NULL, mintern_thread, p);
+    for (int i = 0; i < 4; i++) pthread_join(threads[i], (void **)&res[i]);
+    for (int i = 0; i < 2000; i++) {
+        snprintf(buf, sizeof(buf), "tag-%d", i);
+        TEST_ASSERT_EQUAL_STRING(buf, res[0][i]);
+        for (int t = 1; t < 4; t++) TEST_ASSERT_TRUE(res[0][i] == res[t][i]);
+    }
+    for (int i = 0; i < 4; i++) free(res[i]);
+
+    mintern_get_stats(p, &st);
+    TEST_ASSERT_EQUAL_INT(2003, st.strings);
+    TEST_ASSERT_EQUAL_INT(4 + 4 * 2000, st.lookups);
+    TEST_ASSERT_EQUAL_INT(1 + 3 * 2000, st.hits);
+    mintern_free(p);
+}
+
 int unitTest(void) {
 
     printf("Swap %X\n", Swap16(0xFF00));
@@ -245,7 +1903,29 @@ int unitTest(void) {
     RUN_TEST(I2S_test);
     RUN_TEST(S2S_test);
     RUN_TEST(I2I_test);
+    RUN_TEST(I2I_INDEX_test);
+    RUN_TEST(DBINFO_test);
+    RUN_TEST(FREEZE_test);
+    RUN_TEST(PHASH_test);
+    RUN_TEST(COMPACT_test);
+    RUN_TEST(REVERSE_test);
+    RUN_TEST(SHARED_test);
+    RUN_TEST(TABLE_test);
+    RUN_TEST(KEYS_test);
+    RUN_TEST(DBFILE_test);
+    RUN_TEST(BATCH_test);
+    RUN_TEST(REMOVE_test);
     RUN_TEST(defTest);
+    RUN_TEST(MSTR_test);
+    RUN_TEST(MSTR_simd_test);
+    RUN_TEST(MSTR_find_test);
+    RUN_TEST(MSTR_format_test);
+    RUN_TEST(MSTR_utf8_test);
+    RUN_TEST(MGAP_test);
+    RUN_TEST(MVIEW_test);
+    RUN_TEST(MARENA_test);
+    RUN_TEST(MROPE_test);
+    RUN_TEST(MINTERN_test);
 
     return UNITY_END();
 }
@@ -366,10 +2046,10 @@ int mstr_test(void) {
     // mstr *space = mstr_new("    ");
     // mstr_printx(space);
 
-    // mstr *replace = mstr_new("A field with a flower, a tree and a bush");
-    // mstr_printx(replace, "new", "");
-    // mstr_replace(replace, "a tree", "oak");
-    // mstr_printx(replace, "replace", "");
+    mstr *replace = mstr_new("A field with a flower, a tree and a bush");
+    mstr_printx(replace, "new", "");
+    mstr_replace(replace, "a tree", "an oak");
+    mstr_printx(replace, "replace", "");
 
     // mstr *number = mstr_new("091234");
     // mstr_printx(replace, "Tro")
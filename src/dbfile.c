@@ -0,0 +1,444 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Memory mapped table files.
+ *
+ * @file     dbfile.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * The writers collect the elements of a table as entries, strings go to
+ * the heap in table order, key before value. The entries are then
+ * sorted and hashed into the slots in sorted order. tools/dbpack does
+ * the same steps and writes the same bytes.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dbfile.h"
+#include "dbvalue.h"
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    dbfile_entry e;
+    uint32_t hash;
+    uint32_t pos;     // Position in table
+    const char *str;  // String key, in the heap
+} dbfile_item;
+
+typedef struct {
+    int type;
+    int len;
+    dbfile_item *items;
+    char *heap;
+    uint32_t heapSize;
+    uint32_t heapCap;
+    uint32_t *strings;  // Heap offset + 1 of stored strings, 0 if empty
+    uint32_t mask;
+} dbfile_builder;
+
+// Prototypes -------------------------------------------------------------
+
+static const char *dbfile_str(dbfile *f, uint32_t off);
+static bool dbfile_valid(const dbfile_header *h, size_t size);
+static void dbfile_begin(dbfile_builder *b, int type, int len);
+static void dbfile_end(dbfile_builder *b);
+static uint32_t dbfile_store(dbfile_builder *b, const char *str, size_t max);
+static int dbfile_intCmp(const void *a, const void *b);
+static int dbfile_strCmp(const void *a, const void *b);
+static int dbfile_write(const char *path, dbfile_builder *b);
+
+// Code -------------------------------------------------------------------
+
+uint32_t dbfile_hash(const char *str) {
+    uint32_t h = 2166136261u;
+
+    while (*str) {
+        h ^= (unsigned char)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t dbfile_hashInt(int key) {
+    uint32_t h = (uint32_t)key;
+
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static const char *dbfile_str(dbfile *f, uint32_t off) {
+    return (off < f->header->heapSize) ? f->heap + off : "";
+}
+
+// Header and section bounds, all that is checked on open
+static bool dbfile_valid(const dbfile_header *h, size_t size) {
+    if ((size < sizeof(dbfile_header)) || memcmp(h->magic, DBFILE_MAGIC, 4)) return false;
+    if ((h->version != DBFILE_VERSION) || (h->order != DBFILE_ORDER)) return false;
+    if ((h->type < DBFILE_I2I) || (h->type > DBFILE_S2S) || (h->size != size)) return false;
+    if ((h->slots == 0) || (h->slots & (h->slots - 1)) || (h->slots <= h->len)) return false;
+    if ((h->entries % 4) || (h->index % 4)) return false;
+    if ((uint64_t)h->entries + (uint64_t)h->len * sizeof(dbfile_entry) > size) return false;
+    if ((uint64_t)h->index + (uint64_t)h->slots * sizeof(dbfile_slot) > size) return false;
+    if ((h->heapSize == 0) || ((uint64_t)h->heap + h->heapSize > size)) return false;
+
+    return ((const char *)h)[h->heap + h->heapSize - 1] == '\0';
+}
+
+dbfile *dbfile_open(const char *path) {
+    struct stat st;
+    dbfile *f;
+    void *map;
+    int fd;
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return NULL;
+    }
+    if (st.st_size < (off_t)sizeof(dbfile_header)) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    if (!dbfile_valid(map, (size_t)st.st_size)) {
+        munmap(map, (size_t)st.st_size);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    f = (dbfile *)malloc(sizeof(dbfile));
+    f->header = map;
+    f->entries = (const dbfile_entry *)((const char *)map + f->header->entries);
+    f->slots = (const dbfile_slot *)((const char *)map + f->header->index);
+    f->heap = (const char *)map + f->header->heap;
+    f->size = (size_t)st.st_size;
+
+    return f;
+}
+
+void dbfile_close(dbfile *f) {
+    if (f == NULL) return;
+
+    munmap((void *)f->header, f->size);
+    free(f);
+}
+
+int dbfile_type(dbfile *f) {
+    return f->header->type;
+}
+
+int dbfile_len(dbfile *f) {
+    return (int)f->header->len;
+}
+
+int dbfile_findInt(dbfile *f, int key) {
+    uint32_t h = dbfile_hashInt(key);
+    uint32_t mask = f->header->slots - 1;
+    const dbfile_slot *s;
+
+    if (f->header->type == DBFILE_S2S) return -1;
+
+    for (uint32_t i = h & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+        s = &f->slots[i];
+        if ((s->entry == 0) || (s->entry > f->header->len)) return -1;
+        if ((s->hash == h) && ((int32_t)f->entries[s->entry - 1].key == key)) {
+            return (int)s->entry - 1;
+        }
+    }
+    return -1;
+}
+
+int dbfile_findStr(dbfile *f, const char *key) {
+    uint32_t h = dbfile_hash(key);
+    uint32_t mask = f->header->slots - 1;
+    const dbfile_slot *s;
+
+    if (f->header->type != DBFILE_S2S) return -1;
+
+    for (uint32_t i = h & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+        s = &f->slots[i];
+        if ((s->entry == 0) || (s->entry > f->header->len)) return -1;
+        if ((s->hash == h) && !strcmp(dbfile_str(f, f->entries[s->entry - 1].key), key)) {
+            return (int)s->entry - 1;
+        }
+    }
+    return -1;
+}
+
+int dbfile_keyInt(dbfile *f, int idx) {
+    if ((idx < 0) || ((uint32_t)idx >= f->header->len)) return 0;
+    return (int32_t)f->entries[idx].key;
+}
+
+const char *dbfile_keyStr(dbfile *f, int idx) {
+    if ((idx < 0) || ((uint32_t)idx >= f->header->len)) return NULL;
+    return dbfile_str(f, f->entries[idx].key);
+}
+
+int dbfile_valueInt(dbfile *f, int idx) {
+    if ((idx < 0) || ((uint32_t)idx >= f->header->len)) return 0;
+    return (int32_t)f->entries[idx].value;
+}
+
+const char *dbfile_valueStr(dbfile *f, int idx) {
+    if ((idx < 0) || ((uint32_t)idx >= f->header->len)) return NULL;
+    return dbfile_str(f, f->entries[idx].value);
+}
+
+int dbfile_geti2i(dbfile *f, int key) {
+    return dbfile_valueInt(f, dbfile_findInt(f, key));
+}
+
+const char *dbfile_getI2S(dbfile *f, int key) {
+    return dbfile_valueStr(f, dbfile_findInt(f, key));
+}
+
+const char *dbfile_getS2S(dbfile *f, const char *key) {
+    return dbfile_valueStr(f, dbfile_findStr(f, key));
+}
+
+static void dbfile_begin(dbfile_builder *b, int type, int len) {
+    uint32_t n = DBFILE_SLOTS;
+
+    while (n < (uint32_t)len * 4) n *= 2;
+
+    b->type = type;
+    b->len = len;
+    b->items = (dbfile_item *)calloc((size_t)len + 1, sizeof(dbfile_item));
+    b->heapCap = 256;
+    b->heap = (char *)malloc(b->heapCap);
+    b->heap[0] = '\0';
+    b->heapSize = 1;
+    b->strings = (uint32_t *)calloc(n, sizeof(uint32_t));
+    b->mask = n - 1;
+}
+
+static void dbfile_end(dbfile_builder *b) {
+    free(b->items);
+    free(b->heap);
+    free(b->strings);
+}
+
+// Heap offset of str, at most max characters, stored once
+static uint32_t dbfile_store(dbfile_builder *b, const char *str, size_t max) {
+    size_t len = strnlen(str, max);
+    uint32_t h = dbvalue_hash(str, len);
+    uint32_t *s;
+
+    if (len == 0) return 0;
+
+    for (uint32_t i = h & b->mask;; i = (i + 1) & b->mask) {
+        s = &b->strings[i];
+        if (*s == 0) break;
+        if (!strncmp(b->heap + *s - 1, str, len) && (b->heap[*s - 1 + len] == '\0')) return *s - 1;
+    }
+
+    if (b->heapSize + len + 1 > b->heapCap) {
+        while (b->heapSize + len + 1 > b->heapCap) b->heapCap *= 2;
+        b->heap = (char *)realloc(b->heap, b->heapCap);
+    }
+    memcpy(b->heap + b->heapSize, str, len);
+    b->heap[b->heapSize + len] = '\0';
+    *s = b->heapSize + 1;
+    b->heapSize += (uint32_t)len + 1;
+
+    return *s - 1;
+}
+
+// Order by key, equal keys by position so the first one is found
+static int dbfile_intCmp(const void *a, const void *b) {
+    const dbfile_item *x = a;
+    const dbfile_item *y = b;
+
+    if (x->e.key != y->e.key) {
+        return ((int32_t)x->e.key < (int32_t)y->e.key) ? -1 : 1;
+    }
+    return (x->pos < y->pos) ? -1 : 1;
+}
+
+static int dbfile_strCmp(const void *a, const void *b) {
+    const dbfile_item *x = a;
+    const dbfile_item *y = b;
+    int c = strcmp(x->str, y->str);
+
+    if (c != 0) return c;
+    return (x->pos < y->pos) ? -1 : 1;
+}
+
+static int dbfile_write(const char *path, dbfile_builder *b) {
+    uint32_t n = DBFILE_SLOTS;
+    dbfile_header h;
+    dbfile_entry *entries;
+    dbfile_slot *slots;
+    char tmp[4096];
+    uint32_t i;
+    FILE *fp;
+    int fd;
+    int ok;
+
+    // Replace by rename, processes that have the old file mapped keep it
+    if (snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path) >= (int)sizeof(tmp)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    while (n < (uint32_t)b->len * 2) n *= 2;
+
+    qsort(b->items, b->len, sizeof(dbfile_item), (b->type == DBFILE_S2S) ? dbfile_strCmp : dbfile_intCmp);
+
+    entries = (dbfile_entry *)malloc(((size_t)b->len + 1) * sizeof(dbfile_entry));
+    slots = (dbfile_slot *)calloc(n, sizeof(dbfile_slot));
+    for (int e = 0; e < b->len; e++) {
+        entries[e] = b->items[e].e;
+        for (i = b->items[e].hash & (n - 1); slots[i].entry != 0; i = (i + 1) & (n - 1)) {
+        }
+        slots[i].hash = b->items[e].hash;
+        slots[i].entry = (uint32_t)e + 1;
+    }
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, DBFILE_MAGIC, 4);
+    h.version = DBFILE_VERSION;
+    h.type = (uint16_t)b->type;
+    h.order = DBFILE_ORDER;
+    h.len = (uint32_t)b->len;
+    h.slots = n;
+    h.entries = sizeof(dbfile_header);
+    h.index = h.entries + h.len * sizeof(dbfile_entry);
+    h.heap = h.index + n * sizeof(dbfile_slot);
+    h.heapSize = b->heapSize;
+    h.size = h.heap + h.heapSize;
+
+    fd = mkstemp(tmp);
+    if (fd < 0) {
+        free(entries);
+        free(slots);
+        return -1;
+    }
+    fp = (fchmod(fd, 0644) == 0) ? fdopen(fd, "w") : NULL;
+    if (fp == NULL) {
+        close(fd);
+        unlink(tmp);
+        free(entries);
+        free(slots);
+        return -1;
+    }
+
+    ok = (fwrite(&h, sizeof(h), 1, fp) == 1);
+    ok = ok && (fwrite(entries, sizeof(dbfile_entry), h.len, fp) == h.len);
+    ok = ok && (fwrite(slots, sizeof(dbfile_slot), n, fp) == n);
+    ok = ok && (fwrite(b->heap, 1, b->heapSize, fp) == b->heapSize);
+
+    // On disk before the rename, or a crash can leave an empty table
+    ok = ok && (fflush(fp) == 0) && (fsync(fd) == 0);
+    ok = (fclose(fp) == 0) && ok;
+    ok = ok && (rename(tmp, path) == 0);
+    if (!ok) unlink(tmp);
+
+    free(entries);
+    free(slots);
+    return ok ? 0 : -1;
+}
+
+int dbfile_writei2i(const char *path, i2i *db) {
+    dbfile_builder b;
+    dbfile_item *e;
+    int len = i2i_len(db);
+    int n = 0;
+    int r;
+
+    dbfile_begin(&b, DBFILE_I2I, len);
+    for (int i = 0; i < len; i++) {
+        if (i2i_isRemoved(db, i)) continue;
+
+        e = &b.items[n++];
+        e->e.key = (uint32_t)db[i].key;
+        e->e.value = (uint32_t)db[i].value;
+        e->hash = dbfile_hashInt(db[i].key);
+        e->pos = (uint32_t)i;
+    }
+    b.len = n;
+    r = dbfile_write(path, &b);
+    dbfile_end(&b);
+
+    return r;
+}
+
+int dbfile_writeI2S(const char *path, I2S *db) {
+    dbfile_builder b;
+    dbfile_item *e;
+    int len = I2S_len(db);
+    int n = 0;
+    int r;
+
+    dbfile_begin(&b, DBFILE_I2S, len);
+    for (int i = 0; i < len; i++) {
+        if (I2S_isRemoved(db, i)) continue;
+
+        e = &b.items[n++];
+        e->e.key = (uint32_t)db[i].key;
+        e->e.value = dbfile_store(&b, db[i].value, I2S_STRLEN);
+        e->hash = dbfile_hashInt(db[i].key);
+        e->pos = (uint32_t)i;
+    }
+    b.len = n;
+    r = dbfile_write(path, &b);
+    dbfile_end(&b);
+
+    return r;
+}
+
+int dbfile_writeS2S(const char *path, S2S *db) {
+    dbfile_builder b;
+    dbfile_item *e;
+    int len = S2S_len(db);
+    int n = 0;
+    int r;
+
+    dbfile_begin(&b, DBFILE_S2S, len);
+    for (int i = 0; i < len; i++) {
+        if (S2S_isRemoved(db, i)) continue;
+
+        e = &b.items[n++];
+        e->e.key = dbfile_store(&b, db[i].key, S2S_STRLEN);
+        e->e.value = dbfile_store(&b, db[i].value, S2S_STRLEN);
+        e->pos = (uint32_t)i;
+    }
+    b.len = n;
+
+    // The heap is complete and stays in place
+    for (int i = 0; i < n; i++) {
+        b.items[i].str = b.heap + b.items[i].e.key;
+        b.items[i].hash = dbfile_hash(b.items[i].str);
+    }
+    r = dbfile_write(path, &b);
+    dbfile_end(&b);
+
+    return r;
+}
@@ -0,0 +1,264 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Memory mapped table files.
+ *
+ * @file     dbfile.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * i2i, I2S and S2S tables stored in a file that is mapped read-only and
+ * queried in place. Opening checks the header only, nothing is parsed
+ * or copied, and processes mapping the same file share its pages.
+ * Written by dbfile_writeI2S() and friends or by tools/dbpack from a
+ * text table. Files are in the byte order of the writer, a file of the
+ * other order is refused.
+ *
+ * Layout, version 1, all offsets in bytes from the start of the file:
+ *
+ *   dbfile_header   magic "DBF1", version, type and where the rest is
+ *   dbfile_entry[]  one per element, sorted by key, equal keys in table
+ *                   order. Integers are stored as is, strings as
+ *                   offsets in the heap.
+ *   dbfile_slot[]   hash index, a power of 2 slots at most half full,
+ *                   linear probing from hash & (slots - 1). Integer keys
+ *                   hash with dbfile_hashInt(), strings with
+ *                   dbfile_hash(). The first entry of equal keys is the
+ *                   one found.
+ *   heap            null terminated strings, equal strings stored once,
+ *                   "" at offset 0
+ *
+ * Offsets read from the file are checked before use, a damaged file
+ * gives wrong answers but no access outside the mapping.
+ *
+ * A file mapped by running processes must be replaced, not rewritten,
+ * the writers write a temporary file, sync it to disk and rename it.
+ */
+
+#ifndef DBFILE_H
+#define DBFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "i2i.h"
+#include "i2s.h"
+#include "s2s.h"
+
+// Macros -----------------------------------------------------------------
+
+#define DBFILE_MAGIC "DBF1"
+#define DBFILE_VERSION 1
+#define DBFILE_ORDER 0x01020304u  // Byte order mark
+#define DBFILE_SLOTS 8            // Smallest nr of hash slots
+
+// Table types
+#define DBFILE_I2I 1
+#define DBFILE_I2S 2
+#define DBFILE_S2S 3
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    char magic[4];      // DBFILE_MAGIC
+    uint16_t version;   // DBFILE_VERSION
+    uint16_t type;      // DBFILE_I2I, DBFILE_I2S or DBFILE_S2S
+    uint32_t order;     // DBFILE_ORDER as written
+    uint32_t len;       // nr of entries
+    uint32_t slots;     // nr of hash slots
+    uint32_t entries;   // Offset of entries
+    uint32_t index;     // Offset of hash slots
+    uint32_t heap;      // Offset of string heap
+    uint32_t heapSize;  // Bytes of string heap
+    uint32_t size;      // Bytes of file
+} dbfile_header;
+
+typedef struct {
+    uint32_t key;    // int32_t key or heap offset
+    uint32_t value;  // int32_t value or heap offset
+} dbfile_entry;
+
+typedef struct {
+    uint32_t hash;   // Hash of key
+    uint32_t entry;  // Entry + 1, 0 for an empty slot
+} dbfile_slot;
+
+typedef struct {
+    const dbfile_header *header;
+    const dbfile_entry *entries;
+    const dbfile_slot *slots;
+    const char *heap;
+    size_t size;     // Bytes mapped
+} dbfile;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Map table file.
+ *
+ * @param path file to open
+ * @return table file, NULL with errno set on failure, EINVAL if the
+ *         file is not a table file of this version and byte order
+ */
+dbfile *dbfile_open(const char *path);
+
+/**
+ * Unmap table file.
+ *
+ * @param f table file, NULL is ignored
+ */
+void dbfile_close(dbfile *f);
+
+/**
+ * Table type.
+ *
+ * @param f table file
+ * @return DBFILE_I2I, DBFILE_I2S or DBFILE_S2S
+ */
+int dbfile_type(dbfile *f);
+
+/**
+ * Number of entries.
+ *
+ * @param f table file
+ * @return nr of entries
+ */
+int dbfile_len(dbfile *f);
+
+/**
+ * Find integer key, i2i and I2S files.
+ *
+ * @param f table file
+ * @param key key to find
+ * @return -1 if key not found, else index of entry
+ */
+int dbfile_findInt(dbfile *f, int key);
+
+/**
+ * Find string key, S2S files.
+ *
+ * @param f table file
+ * @param key key to find
+ * @return -1 if key not found, else index of entry
+ */
+int dbfile_findStr(dbfile *f, const char *key);
+
+/**
+ * Integer key of entry.
+ *
+ * @param f table file
+ * @param idx index of entry
+ * @return key, 0 if idx is out of range
+ */
+int dbfile_keyInt(dbfile *f, int idx);
+
+/**
+ * String key of entry.
+ *
+ * @param f table file
+ * @param idx index of entry
+ * @return key, NULL if idx is out of range
+ */
+const char *dbfile_keyStr(dbfile *f, int idx);
+
+/**
+ * Integer value of entry.
+ *
+ * @param f table file
+ * @param idx index of entry
+ * @return value, 0 if idx is out of range
+ */
+int dbfile_valueInt(dbfile *f, int idx);
+
+/**
+ * String value of entry.
+ *
+ * @param f table file
+ * @param idx index of entry
+ * @return value, NULL if idx is out of range
+ */
+const char *dbfile_valueStr(dbfile *f, int idx);
+
+/**
+ * Value of key in an i2i file.
+ *
+ * @param f table file
+ * @param key key to find
+ * @return value, 0 if key not found
+ */
+int dbfile_geti2i(dbfile *f, int key);
+
+/**
+ * Value of key in an I2S file.
+ *
+ * @param f table file
+ * @param key key to find
+ * @return value, NULL if key not found
+ */
+const char *dbfile_getI2S(dbfile *f, int key);
+
+/**
+ * Value of key in an S2S file.
+ *
+ * @param f table file
+ * @param key key to find
+ * @return value, NULL if key not found
+ */
+const char *dbfile_getS2S(dbfile *f, const char *key);
+
+/**
+ * Write i2i table to file.
+ *
+ * @param path file to write, replaced
+ * @param db table to write
+ * @return 0 on success, -1 with errno set on failure
+ */
+int dbfile_writei2i(const char *path, i2i *db);
+
+/**
+ * Write I2S table to file.
+ *
+ * @param path file to write, replaced
+ * @param db table to write
+ * @return 0 on success, -1 with errno set on failure
+ */
+int dbfile_writeI2S(const char *path, I2S *db);
+
+/**
+ * Write S2S table to file.
+ *
+ * @param path file to write, replaced
+ * @param db table to write
+ * @return 0 on success, -1 with errno set on failure
+ */
+int dbfile_writeS2S(const char *path, S2S *db);
+
+/**
+ * Hash of string key.
+ *
+ * @param str key
+ * @return FNV-1a, 32 bit
+ */
+uint32_t dbfile_hash(const char *str);
+
+/**
+ * Hash of integer key.
+ *
+ * @param key key
+ * @return hash
+ */
+uint32_t dbfile_hashInt(int key);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
@@ -0,0 +1,312 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Side information of associative array tables.
+ *
+ * @file     dbinfo.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Every table operation asks the directory about its array, so lookups
+ * take no lock. Writers serialize on a mutex and bump a sequence count
+ * around each change, readers probe and retry if the count moved. Slot
+ * arrays replaced when growing are kept, not freed, since a reader may
+ * still be probing them, they add up to less than the current one.
+ *
+ * Each thread remembers the last table it asked about together with the
+ * count, a table looked up again before the directory changes is
+ * answered without probing.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbinfo.h"
+#include "dbvalue.h"
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    const void *db;  // NULL for an empty slot
+    dbinfo *info;
+} dbinfo_slot;
+
+typedef struct {
+    const void *db;  // Table last looked up, NULL if none
+    dbinfo *info;
+    unsigned seq;    // Directory count the answer is valid for
+} dbinfo_last;
+
+typedef struct dbinfo_dir {
+    struct dbinfo_dir *retired;  // Previous, smaller slot array
+    size_t mask;                 // nr of slots - 1
+    dbinfo_slot slots[];
+} dbinfo_dir;
+
+// Prototypes -------------------------------------------------------------
+
+static size_t dbinfo_hash(const void *db);
+static dbinfo_slot *dbinfo_probe(dbinfo_dir *d, const void *db);
+static void dbinfo_put(const void *db, dbinfo *info);
+static void dbinfo_delete(dbinfo_slot *slot);
+static void dbinfo_lock(void);
+static void dbinfo_unlock(void);
+
+// Variables --------------------------------------------------------------
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static dbinfo_dir *dir;
+static size_t count;
+static unsigned seq;     // Odd while a writer changes the directory
+static int frozen;       // nr of tables with a key index
+static int removing;     // nr of tables with removed elements
+static __thread dbinfo_last last;
+
+// Code -------------------------------------------------------------------
+
+static size_t dbinfo_hash(const void *db) {
+    uint64_t h = (uint64_t)(uintptr_t)db;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+// Slot holding db, or the empty slot where it would go. Writers only.
+static dbinfo_slot *dbinfo_probe(dbinfo_dir *d, const void *db) {
+    size_t i = dbinfo_hash(db) & d->mask;
+
+    while ((d->slots[i].db != NULL) && (d->slots[i].db != db)) {
+        i = (i + 1) & d->mask;
+    }
+    return &d->slots[i];
+}
+
+static void dbinfo_lock(void) {
+    pthread_mutex_lock(&lock);
+    __atomic_add_fetch(&seq, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void dbinfo_unlock(void) {
+    __atomic_add_fetch(&seq, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&lock);
+}
+
+static void dbinfo_put(const void *db, dbinfo *info) {
+    dbinfo_dir *old = dir;
+    dbinfo_dir *d = dir;
+    dbinfo_slot *slot;
+    size_t n;
+
+    if ((d == NULL) || ((count + 1) * 2 > d->mask + 1)) {
+        n = (d == NULL) ? DBINFO_SLOTS : (d->mask + 1) * 2;
+        d = (dbinfo_dir *)calloc(1, sizeof(dbinfo_dir) + n * sizeof(dbinfo_slot));
+        d->mask = n - 1;
+        d->retired = old;
+
+        for (size_t i = 0; old != NULL && i <= old->mask; i++) {
+            if (old->slots[i].db != NULL) *dbinfo_probe(d, old->slots[i].db) = old->slots[i];
+        }
+        __atomic_store_n(&dir, d, __ATOMIC_RELEASE);
+    }
+
+    slot = dbinfo_probe(d, db);
+    if (slot->db == NULL) __atomic_add_fetch(&count, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->info, info, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot->db, db, __ATOMIC_RELAXED);
+}
+
+// Backward shift, entries after the hole move up if that brings them
+// closer to their home slot
+static void dbinfo_delete(dbinfo_slot *slot) {
+    dbinfo_slot *s = dir->slots;
+    size_t mask = dir->mask;
+    size_t hole = (size_t)(slot - s);
+    size_t i = hole;
+    size_t home;
+
+    for (;;) {
+        i = (i + 1) & mask;
+        if (s[i].db == NULL) break;
+
+        home = dbinfo_hash(s[i].db) & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            __atomic_store_n(&s[hole].info, s[i].info, __ATOMIC_RELAXED);
+            __atomic_store_n(&s[hole].db, s[i].db, __ATOMIC_RELAXED);
+            hole = i;
+        }
+    }
+
+    __atomic_store_n(&s[hole].db, NULL, __ATOMIC_RELAXED);
+    __atomic_store_n(&s[hole].info, NULL, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&count, 1, __ATOMIC_RELAXED);
+}
+
+dbinfo *dbinfo_get(const void *db) {
+    dbinfo_dir *d;
+    dbinfo *info;
+    const void *key;
+    unsigned s;
+    size_t i;
+
+    if (__atomic_load_n(&count, __ATOMIC_RELAXED) == 0) return NULL;
+
+    for (;;) {
+        s = __atomic_load_n(&seq, __ATOMIC_ACQUIRE);
+        if (s & 1) continue;
+        if ((last.db == db) && (last.seq == s)) return last.info;
+
+        d = __atomic_load_n(&dir, __ATOMIC_ACQUIRE);
+        if (d == NULL) return NULL;
+
+        info = NULL;
+        i = dbinfo_hash(db) & d->mask;
+        for (;;) {
+            key = __atomic_load_n(&d->slots[i].db, __ATOMIC_RELAXED);
+            if (key == NULL) break;
+            if (key == db) {
+                info = __atomic_load_n(&d->slots[i].info, __ATOMIC_RELAXED);
+                break;
+            }
+            i = (i + 1) & d->mask;
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&seq, __ATOMIC_RELAXED) == s) {
+            last.db = db;
+            last.info = info;
+            last.seq = s;
+            return info;
+        }
+    }
+}
+
+dbinfo *dbinfo_add(void *db, int len, int capacity, bool owned) {
+    dbinfo *info = (dbinfo *)calloc(1, sizeof(dbinfo));
+
+    info->db = db;
+    info->len = len;
+    info->capacity = capacity;
+    info->owned = owned;
+
+    dbinfo_lock();
+    dbinfo_put(db, info);
+    dbinfo_unlock();
+
+    return info;
+}
+
+void dbinfo_move(dbinfo *info, void *db) {
+    dbinfo_slot *slot;
+
+    dbinfo_lock();
+    slot = dbinfo_probe(dir, info->db);
+    if (slot->db != NULL) dbinfo_delete(slot);
+    info->db = db;
+    dbinfo_put(db, info);
+    dbinfo_unlock();
+}
+
+void dbinfo_freeze(dbinfo *info, void *keys) {
+    dbinfo_thaw(info);
+    info->keys = keys;
+    __atomic_add_fetch(&frozen, 1, __ATOMIC_RELAXED);
+}
+
+void dbinfo_thaw(dbinfo *info) {
+    if ((info == NULL) || (info->keys == NULL)) return;
+
+    free(info->keys);
+    info->keys = NULL;
+    __atomic_sub_fetch(&frozen, 1, __ATOMIC_RELAXED);
+}
+
+bool dbinfo_frozen(void) {
+    return __atomic_load_n(&frozen, __ATOMIC_RELAXED) != 0;
+}
+
+void dbinfo_markRemoved(dbinfo *info, int pos) {
+    int words;
+
+    if (dbinfo_removed(info, pos)) return;
+
+    if (pos >= info->removedLen) {
+        words = ((pos < info->len) ? info->len : pos + 1) / 64 + 1;
+        if (info->removed == NULL) __atomic_add_fetch(&removing, 1, __ATOMIC_RELAXED);
+        info->removed = realloc(info->removed, words * sizeof(uint64_t));
+        memset(info->removed + info->removedLen / 64, 0, (words - info->removedLen / 64) * sizeof(uint64_t));
+        info->removedLen = words * 64;
+    }
+
+    info->removed[pos >> 6] |= 1ULL << (pos & 63);
+    info->dead++;
+}
+
+void dbinfo_unmarkRemoved(dbinfo *info, int pos) {
+    if (!dbinfo_removed(info, pos)) return;
+
+    info->removed[pos >> 6] &= ~(1ULL << (pos & 63));
+    if (--info->dead == 0) dbinfo_clearRemoved(info);
+}
+
+void dbinfo_dropRemoved(dbinfo *info, int pos) {
+    uint64_t *r = info->removed;
+    uint64_t below;
+    int w = pos >> 6;
+
+    if (pos >= info->removedLen) return;
+
+    dbinfo_unmarkRemoved(info, pos);
+    if (info->removed == NULL) return;
+
+    // Bits below pos stay, the rest move down one
+    below = (1ULL << (pos & 63)) - 1;
+    r[w] = (r[w] & below) | ((r[w] >> 1) & ~below);
+    for (; w + 1 < info->removedLen / 64; w++) {
+        r[w] |= r[w + 1] << 63;
+        r[w + 1] >>= 1;
+    }
+}
+
+void dbinfo_clearRemoved(dbinfo *info) {
+    if (info->removed != NULL) __atomic_sub_fetch(&removing, 1, __ATOMIC_RELAXED);
+    free(info->removed);
+    info->removed = NULL;
+    info->removedLen = 0;
+    info->dead = 0;
+}
+
+bool dbinfo_removing(void) {
+    return __atomic_load_n(&removing, __ATOMIC_RELAXED) != 0;
+}
+
+void dbinfo_remove(const void *db) {
+    dbinfo_slot *slot;
+    dbinfo *info = NULL;
+
+    if (__atomic_load_n(&count, __ATOMIC_RELAXED) == 0) return;
+
+    dbinfo_lock();
+    slot = dbinfo_probe(dir, db);
+    if (slot->db != NULL) {
+        info = slot->info;
+        dbinfo_delete(slot);
+    }
+    dbinfo_unlock();
+
+    dbinfo_thaw(info);
+    if (info != NULL) {
+        dbvalue_free(info->values);
+        dbinfo_clearRemoved(info);
+    }
+    free(info);
+}
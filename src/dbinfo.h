@@ -0,0 +1,173 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Side information of associative array tables.
+ *
+ * @file     dbinfo.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * The i2i, I2S and S2S tables are plain arrays terminated by a sentinel
+ * element, so a table can be a static initializer list as well as an
+ * array from i2i_new()/I2S_new()/S2S_new(). Tables allocated by the
+ * library are registered here by address together with their length and
+ * capacity, which lets len/last answer without walking to the sentinel
+ * and lets tables grow. Arrays not registered (static, on the stack or
+ * from plain malloc) are handled by scanning as before. A static table
+ * is only registered, without being owned, by an explicit call such as
+ * i2i_register(), and must be unregistered before its storage is reused
+ * since another array at the same address would get its entry.
+ *
+ * The directory is shared by all tables and safe to use from several
+ * threads, the tables themselves are not.
+ */
+
+#ifndef DBINFO_H
+#define DBINFO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Macros -----------------------------------------------------------------
+
+#define DBINFO_SLOTS 64    // Initial nr of directory slots, a power of 2
+#define DBINFO_CAPACITY 8  // Smallest capacity of a growing table
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    void *db;       // Table array
+    int len;        // nr of elements before the sentinel
+    int capacity;   // nr of elements the array has room for
+    bool owned;     // Array allocated by the library, may be resized
+    void *keys;     // Key index of a frozen table, NULL if not frozen
+    void *values;   // dbvalue hash index of values, NULL if not indexed
+    int dead;       // nr of removed elements left in place
+    uint64_t *removed;  // Bit per removed element, NULL if none
+    int removedLen;     // nr of elements removed has bits for
+} dbinfo;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Information of a registered table.
+ *
+ * @param db table array
+ * @return information, NULL if db is not registered
+ */
+dbinfo *dbinfo_get(const void *db);
+
+/**
+ * Register a table.
+ *
+ * @param db table array
+ * @param len nr of elements before the sentinel
+ * @param capacity nr of elements the array has room for
+ * @param owned array allocated by the library
+ * @return information of db
+ */
+dbinfo *dbinfo_add(void *db, int len, int capacity, bool owned);
+
+/**
+ * Update the address of a registered table after it has been moved.
+ *
+ * @param info information of the table
+ * @param db new table array
+ */
+void dbinfo_move(dbinfo *info, void *db);
+
+/**
+ * Set the key index of a table, replacing an earlier one.
+ *
+ * @param info information of the table
+ * @param keys key index, released with free()
+ */
+void dbinfo_freeze(dbinfo *info, void *keys);
+
+/**
+ * Drop the key index of a table.
+ *
+ * @param info information of the table, NULL is ignored
+ */
+void dbinfo_thaw(dbinfo *info);
+
+/**
+ * Check if any table has a key index. Lookups in tables that are never
+ * frozen skip dbinfo_get() as long as none is.
+ *
+ * @return true if a table is frozen
+ */
+bool dbinfo_frozen(void);
+
+/**
+ * Check if an element of a table is removed.
+ *
+ * @param info information of the table, NULL for none removed
+ * @param pos position of element
+ * @return true if removed
+ */
+static inline bool dbinfo_removed(const dbinfo *info, int pos) {
+    return (info != NULL) && (pos < info->removedLen) && ((info->removed[pos >> 6] >> (pos & 63)) & 1);
+}
+
+/**
+ * Mark an element removed, it stays in place until compacted.
+ *
+ * @param info information of the table
+ * @param pos position of element
+ */
+void dbinfo_markRemoved(dbinfo *info, int pos);
+
+/**
+ * Mark an element not removed, when it is written again.
+ *
+ * @param info information of the table
+ * @param pos position of element
+ */
+void dbinfo_unmarkRemoved(dbinfo *info, int pos);
+
+/**
+ * Drop the mark of an element taken out of the table, the marks of later
+ * elements move down one position with them.
+ *
+ * @param info information of the table
+ * @param pos position of element
+ */
+void dbinfo_dropRemoved(dbinfo *info, int pos);
+
+/**
+ * Drop all marks, after removed elements are compacted away.
+ *
+ * @param info information of the table
+ */
+void dbinfo_clearRemoved(dbinfo *info);
+
+/**
+ * Check if any table has removed elements. Lookups in tables of programs
+ * that never remove skip dbinfo_get() as long as none has.
+ *
+ * @return true if a table has removed elements
+ */
+bool dbinfo_removing(void);
+
+/**
+ * Unregister a table, its indexes are freed.
+ *
+ * @param db table array, not registered is ignored
+ */
+void dbinfo_remove(const void *db);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
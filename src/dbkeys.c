@@ -0,0 +1,313 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Key index of frozen integer key tables.
+ *
+ * @file     dbkeys.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Packed keys are followed by zeros up to a multiple of DBKEYS_LANES so
+ * the vector scans only do full loads. A padding key matching comes
+ * after every real key of its load and is reported as not found.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def_simd.h"
+#include "dbkeys.h"
+
+#ifdef DEF_SIMD_X86
+#define DBKEYS_SIMD_X86
+#endif
+
+#if DBKEYS_PACKED > 64
+#error "DBKEYS_PACKED larger than the removed bits of a packed index"
+#endif
+
+// Macros -----------------------------------------------------------------
+
+// Digit of key at shift, with the sign bit flipped so negative keys come first
+#define DBKEYS_DIGIT(key, shift) ((((uint32_t)(key) ^ 0x80000000u) >> (shift)) & 0xff)
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    int key;
+    int pos;
+} dbkeys_pair;
+
+typedef int (*dbkeys_scan_fn)(const int *keys, int len, int key);
+
+// Prototypes -------------------------------------------------------------
+
+static void dbkeys_sort(dbkeys_pair *pairs, dbkeys_pair *tmp, int len);
+static int dbkeys_lower(const dbkeys *k, int key);
+static int dbkeys_search(const dbkeys *k, int key);
+static void dbkeys_searchBatch(const dbkeys *k, const int *keys, int n, int *pos);
+static int dbkeys_packed(const dbkeys *k, int key);
+static int dbkeys_scan_scalar(const int *keys, int len, int key);
+
+// Variables --------------------------------------------------------------
+
+static int dbkeys_simd = DBKEYS_SIMD_SCALAR;  // Until selected at load time
+static dbkeys_scan_fn dbkeys_scan = dbkeys_scan_scalar;
+
+// Code -------------------------------------------------------------------
+
+// Stable radix sort by key, 8 bits a pass from the lowest. Equal keys
+// keep their table order so the first one is found. Four passes, the
+// result ends up in pairs again.
+static void dbkeys_sort(dbkeys_pair *pairs, dbkeys_pair *tmp, int len) {
+    size_t count[256];
+    size_t sum, c;
+    dbkeys_pair *t;
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        memset(count, 0, sizeof(count));
+        for (int i = 0; i < len; i++) count[DBKEYS_DIGIT(pairs[i].key, shift)]++;
+        sum = 0;
+        for (int d = 0; d < 256; d++) {
+            c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (int i = 0; i < len; i++) tmp[count[DBKEYS_DIGIT(pairs[i].key, shift)]++] = pairs[i];
+
+        t = pairs;
+        pairs = tmp;
+        tmp = t;
+    }
+}
+
+// Branch free lower bound
+static int dbkeys_lower(const dbkeys *k, int key) {
+    const int *base = k->keys;
+    int n = k->len;
+    int half;
+
+    if (n == 0) {
+        return 0;
+    }
+
+    while (n > 1) {
+        half = n / 2;
+        base = (base[half] < key) ? &base[half] : base;
+        n -= half;
+    }
+    return (int)(base - k->keys) + (*base < key);
+}
+
+// First of the keys equal to key not removed
+static int dbkeys_search(const dbkeys *k, int key) {
+    for (int i = dbkeys_lower(k, key); (i < k->len) && (k->keys[i] == key); i++) {
+        if (k->pos[i] >= 0) return k->pos[i];
+    }
+    return -1;
+}
+
+// Lower bounds of up to DBKEYS_BATCH keys, one step of each search in
+// turn. Both elements the next step may compare are prefetched, by the
+// time a search comes round again they are in cache.
+static void dbkeys_searchBatch(const dbkeys *k, const int *keys, int n, int *pos) {
+    const int *base[DBKEYS_BATCH];
+    int len = k->len;
+    int half;
+    int next;
+
+    for (int i = 0; i < n; i++) base[i] = k->keys;
+
+    while (len > 1) {
+        half = len / 2;
+        next = (len - half) / 2;
+        for (int i = 0; i < n; i++) {
+            base[i] = (base[i][half] < keys[i]) ? &base[i][half] : base[i];
+            __builtin_prefetch(&base[i][next]);
+            __builtin_prefetch(&base[i][half + next]);
+        }
+        len -= half;
+    }
+
+    for (int i = 0; i < n; i++) {
+        pos[i] = -1;
+        for (int j = (int)(base[i] - k->keys) + (*base[i] < keys[i]); (j < k->len) && (k->keys[j] == keys[i]); j++) {
+            if (k->pos[j] >= 0) {
+                pos[i] = k->pos[j];
+                break;
+            }
+        }
+    }
+}
+
+// First of the packed keys equal to key not removed, the ones after a
+// removed match are few and compared one at a time
+static int dbkeys_packed(const dbkeys *k, int key) {
+    int i = dbkeys_scan(k->keys, k->len, key);
+
+    while ((i >= 0) && ((k->removed >> i) & 1)) {
+        for (i++; (i < k->len) && (k->keys[i] != key); i++) {
+        }
+        if (i == k->len) i = -1;
+    }
+    return i;
+}
+
+static int dbkeys_scan_scalar(const int *keys, int len, int key) {
+    for (int i = 0; i < len; i++) {
+        if (keys[i] == key) return i;
+    }
+    return -1;
+}
+
+#ifdef DBKEYS_SIMD_X86
+
+__attribute__((target("sse2"))) static int dbkeys_scan_sse2(const int *keys, int len, int key) {
+    __m128i k = _mm_set1_epi32(key);
+    __m128i a, b;
+    unsigned int m;
+
+    for (int i = 0; i < len; i += 8) {
+        a = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(keys + i)), k);
+        b = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(keys + i + 4)), k);
+        m = (unsigned int)_mm_movemask_epi8(_mm_packs_epi32(a, b));
+        if (m) {
+            i += __builtin_ctz(m) / 2;
+            return (i < len) ? i : -1;
+        }
+    }
+    return -1;
+}
+
+__attribute__((target("avx2"))) static int dbkeys_scan_avx2(const int *keys, int len, int key) {
+    __m256i k = _mm256_set1_epi32(key);
+    unsigned int m;
+
+    for (int i = 0; i < len; i += 8) {
+        m = (unsigned int)_mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *)(keys + i)), k)));
+        if (m) {
+            i += __builtin_ctz(m);
+            return (i < len) ? i : -1;
+        }
+    }
+    return -1;
+}
+
+#endif
+
+dbkeys *dbkeys_new(const int *key, size_t size, int len) {
+    bool sorted = len > DBKEYS_PACKED;
+    int padded = (len + DBKEYS_LANES - 1) / DBKEYS_LANES * DBKEYS_LANES;
+    const char *e = (const char *)key;
+    dbkeys_pair *pairs;
+    dbkeys *k;
+
+    if (sorted) {
+        k = malloc(sizeof(dbkeys) + 2 * len * sizeof(int));
+        k->pos = k->keys + len;
+
+        pairs = malloc(2 * len * sizeof(dbkeys_pair));
+        for (int i = 0; i < len; i++, e += size) {
+            pairs[i].key = *(const int *)e;
+            pairs[i].pos = i;
+        }
+        dbkeys_sort(pairs, pairs + len, len);
+        for (int i = 0; i < len; i++) {
+            k->keys[i] = pairs[i].key;
+            k->pos[i] = pairs[i].pos;
+        }
+        free(pairs);
+    } else {
+        k = malloc(sizeof(dbkeys) + padded * sizeof(int));
+        k->pos = NULL;
+        for (int i = 0; i < len; i++, e += size) {
+            k->keys[i] = *(const int *)e;
+        }
+        memset(k->keys + len, 0, (padded - len) * sizeof(int));
+    }
+
+    k->len = len;
+    k->sorted = sorted;
+    k->removed = 0;
+    return k;
+}
+
+int dbkeys_find(const dbkeys *k, int key) {
+    if (k->sorted) {
+        return dbkeys_search(k, key);
+    }
+    return dbkeys_packed(k, key);
+}
+
+int dbkeys_findKeys(const dbkeys *k, const int *keys, int n, int *pos) {
+    int found = 0;
+
+    if (k->sorted) {
+        for (int i = 0; i < n; i += DBKEYS_BATCH) {
+            dbkeys_searchBatch(k, keys + i, (n - i < DBKEYS_BATCH) ? n - i : DBKEYS_BATCH, pos + i);
+        }
+    } else {
+        for (int i = 0; i < n; i++) pos[i] = dbkeys_packed(k, keys[i]);
+    }
+
+    for (int i = 0; i < n; i++) found += (pos[i] >= 0);
+    return found;
+}
+
+void dbkeys_remove(dbkeys *k, int key, int pos) {
+    if (!k->sorted) {
+        k->removed |= 1ULL << pos;
+        return;
+    }
+
+    // Sorted keys stay in place, the position is marked
+    for (int i = dbkeys_lower(k, key); (i < k->len) && (k->keys[i] == key); i++) {
+        if (k->pos[i] == pos) {
+            k->pos[i] = -1;
+            return;
+        }
+    }
+}
+
+size_t dbkeys_size(const dbkeys *k) {
+    if (k->sorted) {
+        return sizeof(dbkeys) + 2 * k->len * sizeof(int);
+    }
+    return sizeof(dbkeys) + (k->len + DBKEYS_LANES - 1) / DBKEYS_LANES * DBKEYS_LANES * sizeof(int);
+}
+
+int dbkeys_simd_set(int level) {
+    int supported = DBKEYS_SIMD_SCALAR + def_simd_supported();
+
+    if ((level < 0) || (level > supported)) level = supported;
+
+    switch (level) {
+#ifdef DBKEYS_SIMD_X86
+        case DBKEYS_SIMD_AVX2:
+            dbkeys_scan = dbkeys_scan_avx2;
+            break;
+        case DBKEYS_SIMD_SSE2:
+            dbkeys_scan = dbkeys_scan_sse2;
+            break;
+#endif
+        default:
+            dbkeys_scan = dbkeys_scan_scalar;
+            break;
+    }
+
+    dbkeys_simd = level;
+    return level;
+}
+
+DEF_SIMD_INIT(dbkeys_simd_set)
+
+int dbkeys_simd_level(void) {
+    return dbkeys_simd;
+}
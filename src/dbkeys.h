@@ -0,0 +1,129 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Key index of frozen integer key tables.
+ *
+ * @file     dbkeys.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * The keys of an i2i or I2S table as an array of their own, for
+ * i2i_freeze() and I2S_freeze(). Tables of up to DBKEYS_PACKED elements
+ * keep the keys in table order and compare 4 (SSE2) or 8 (AVX2) of them
+ * per instruction, a scan that does not touch the values or look for
+ * the sentinel. Larger tables keep the keys sorted, with the position
+ * of each in an array beside them, for binary search. Batches of keys
+ * are searched DBKEYS_BATCH at a time, a step of each search in turn,
+ * so the cache misses of one search overlap those of the others.
+ */
+
+#ifndef DBKEYS_H
+#define DBKEYS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Macros -----------------------------------------------------------------
+
+#ifndef DBKEYS_PACKED
+#define DBKEYS_PACKED 64  // Largest table scanned instead of searched, at most 64
+#endif
+#define DBKEYS_LANES 8    // Packed keys are padded to a multiple of this
+#define DBKEYS_BATCH 16   // Binary searches run side by side by dbkeys_findKeys()
+
+// Implementations of the packed scan, the best one supported by the CPU
+// is selected when the program is loaded, see def_simd.h.
+#define DBKEYS_SIMD_SCALAR 0  // One key per iteration
+#define DBKEYS_SIMD_SSE2 1    // 4 keys per instruction
+#define DBKEYS_SIMD_AVX2 2    // 8 keys per instruction
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    int len;      // nr of keys
+    bool sorted;  // Keys sorted, positions in pos, else in table order
+    int *pos;     // Table position of each sorted key, -1 once removed,
+                  // NULL if packed
+    uint64_t removed;  // Bit per removed packed key
+    int keys[];
+} dbkeys;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create key index, released with free() like the other indexes.
+ *
+ * @param key key of the first element of the table
+ * @param size size of a table element
+ * @param len nr of elements
+ * @return key index
+ */
+dbkeys *dbkeys_new(const int *key, size_t size, int len);
+
+/**
+ * Find key.
+ *
+ * @param k key index
+ * @param key key to find
+ * @return -1 if key not found, else the lowest position holding key
+ */
+int dbkeys_find(const dbkeys *k, int key);
+
+/**
+ * Find keys.
+ *
+ * @param k key index
+ * @param keys keys to find
+ * @param n nr of keys
+ * @param pos position of each key, -1 if not found
+ * @return nr of keys found
+ */
+int dbkeys_findKeys(const dbkeys *k, const int *keys, int n, int *pos);
+
+/**
+ * Remove element from key index, the table keeps its position.
+ *
+ * @param k key index
+ * @param key key of element
+ * @param pos position of element in table
+ */
+void dbkeys_remove(dbkeys *k, int key, int pos);
+
+/**
+ * Memory used by key index.
+ *
+ * @param k key index
+ * @return bytes
+ */
+size_t dbkeys_size(const dbkeys *k);
+
+/**
+ * Implementation of the packed scan in use.
+ *
+ * @return DBKEYS_SIMD_*
+ */
+int dbkeys_simd_level(void);
+
+/**
+ * Select implementation of the packed scan, for tests and benchmarks. Not
+ * while other threads search.
+ *
+ * @param level DBKEYS_SIMD_*, -1 or one not supported selects the best
+ * @return level selected
+ */
+int dbkeys_simd_set(int level);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
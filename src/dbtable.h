@@ -0,0 +1,530 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Generic sentinel terminated key/value table.
+ *
+ * @file     dbtable.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * The operations of i2i, I2S and S2S written once. A table type is an
+ * array of elements with a key and a value member, terminated by a
+ * sentinel element. Define the parameters below and include this file
+ * to generate the functions of a table type, the comparisons are macros
+ * and compiled into each function. The file may be included several
+ * times, the parameters are undefined at the end.
+ *
+ *   DBT_PREFIX           prefix of generated functions, e.g. i2i
+ *   DBT_TYPE             element type
+ *   DBT_KEY              key parameter type
+ *   DBT_VAL              value parameter type
+ *   DBT_GET              return type of getValue
+ *   DBT_NONE             getValue result for missing key
+ *   DBT_IS_LAST(e)       element e is the sentinel
+ *   DBT_SET_LAST(e)      make element e the sentinel
+ *   DBT_KEY_EQ(e, k)     key of element e equals k
+ *   DBT_VAL_EQ(e, v)     value of element e equals v
+ *   DBT_KEY_SET(e, k)    store key k in element e
+ *   DBT_VAL_SET(e, v)    store value v in element e
+ *   DBT_VAL_HASH(v)      32 bit hash of a value, of a value parameter
+ *                        as well as of the value member
+ *   DBT_PRINT(e)         print element e on one line
+ *
+ * Optional:
+ *
+ *   DBT_FIND_FROZEN(info, k)  find k in the key index of a frozen table
+ *   DBT_FIND_FROZEN_N(info, keys, n, idx)
+ *                             find n keys in the key index of a frozen
+ *                             table, store positions in idx and return
+ *                             nr found, default DBT_FIND_FROZEN on each
+ *   DBT_REMOVE_FROZEN(info, e, idx)
+ *                             remove element e at idx from the key index
+ *                             of a frozen table, default thaw the table
+ *   DBT_FREEZE(db)            build the key index of a table, used by
+ *                             build and compact
+ *   DBT_SCOPE                 storage class of the generated functions,
+ *                             default none (extern)
+ *
+ * Generated: new, copy, free, register, unregister, build, findKey,
+ * findKeys, findValue, getValue, getValues, setValue, setKeyValue,
+ * append, remove, removeKey, isRemoved, compact, indexValues,
+ * dropValues, len, last, first and printDb, see i2i.h for what they do.
+ *
+ * removeKey leaves the element in place, marked removed by a bit in the
+ * dbinfo of the table, so no key is reserved for removed elements.
+ * Neither key nor value lookups find it, and the indexes are kept.
+ * Indexes built later leave removed elements out. Positions stay valid
+ * until the table is compacted, by compact or by removeKey once more
+ * than 1 in DBT_COMPACT_RATIO elements are removed.
+ *
+ * Only registered tables get indexes and removed elements, those from
+ * new and tables passed to register. A table that is not registered is
+ * scanned and removeKey shifts the later elements up.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbinfo.h"
+#include "dbvalue.h"
+
+// Macros -----------------------------------------------------------------
+
+#ifndef DBT_CAT
+#define DBT_CAT2(a, b) a##_##b
+#define DBT_CAT(a, b) DBT_CAT2(a, b)
+#endif
+
+#define DBT_FN(name) DBT_CAT(DBT_PREFIX, name)
+
+#ifndef DBT_SCOPE
+#define DBT_SCOPE
+#endif
+
+#ifndef DBT_BATCH
+#define DBT_BATCH 256  // Keys getValues looks up at a time
+#endif
+
+#ifndef DBT_COMPACT_RATIO
+#define DBT_COMPACT_RATIO 4
+#endif
+
+// Code -------------------------------------------------------------------
+
+// Index within table, checked against the sentinel up to idx only when
+// the length is not known
+static bool DBT_FN(inRange)(DBT_TYPE *db, int idx) {
+    dbinfo *info = dbinfo_get(db);
+
+    if (idx < 0) return false;
+    if (info != NULL) return idx < info->len;
+
+    for (int i = 0; i <= idx; i++) {
+        if (DBT_IS_LAST(&db[i])) return false;
+    }
+    return true;
+}
+
+// Index the values of all elements but removed ones, replacing an
+// earlier index
+static void DBT_FN(valueIndex)(DBT_TYPE *db, dbinfo *info) {
+    dbvalue *v = dbvalue_new(info->len);
+
+    for (int i = 0; i < info->len; i++) {
+        if (!dbinfo_removed(info, i)) dbvalue_add(v, DBT_VAL_HASH(db[i].value), i);
+    }
+    dbvalue_free(info->values);
+    info->values = v;
+}
+
+// Lowest position holding value, the one a scan would find. Positions
+// come in ascending order, the first with an equal value is it.
+static int DBT_FN(valueSearch)(DBT_TYPE *db, dbinfo *info, DBT_VAL value) {
+    dbvalue *v = info->values;
+    int pos;
+
+    for (pos = dbvalue_first(v, DBT_VAL_HASH(value)); pos >= 0; pos = dbvalue_next(v, pos)) {
+        if (DBT_VAL_EQ(&db[pos], value) && !dbinfo_removed(info, pos)) return pos;
+    }
+    return -1;
+}
+
+// Store value of element, keeping the value index up to date
+static void DBT_FN(putValue)(DBT_TYPE *db, dbinfo *info, int idx, DBT_VAL value) {
+    bool indexed = (info != NULL) && (info->values != NULL);
+
+    if (indexed) dbvalue_delete(info->values, DBT_VAL_HASH(db[idx].value), idx);
+    DBT_VAL_SET(&db[idx], value);
+    if (indexed) dbvalue_add(info->values, DBT_VAL_HASH(db[idx].value), idx);
+}
+
+DBT_SCOPE int DBT_FN(len)(DBT_TYPE *db) {
+    dbinfo *info = dbinfo_get(db);
+    int i = 0;
+
+    if (info != NULL) {
+        return info->len;
+    }
+
+    while (!DBT_IS_LAST(&db[i])) {
+        i++;
+    }
+
+    return i;
+}
+
+DBT_SCOPE DBT_TYPE *DBT_FN(new)(int size) {
+    DBT_TYPE *db;
+
+    db = malloc((size + 1) * sizeof(DBT_TYPE));
+    memset(db, 0, (size + 1) * sizeof(DBT_TYPE));
+    DBT_SET_LAST(&db[size]);
+
+    dbinfo_add(db, size, size, true);
+
+    return db;
+}
+
+DBT_SCOPE DBT_TYPE *DBT_FN(copy)(DBT_TYPE *db) {
+    dbinfo *info;
+    DBT_TYPE *dst;
+    int len;
+
+    len = DBT_FN(len)(db);
+    dst = DBT_FN(new)(len);
+    memcpy(dst, db, len * sizeof(DBT_TYPE));
+    if (((info = dbinfo_get(db)) != NULL) && (info->dead > 0)) {
+        for (int i = 0; i < len; i++) {
+            if (dbinfo_removed(info, i)) dbinfo_markRemoved(dbinfo_get(dst), i);
+        }
+    }
+
+    return dst;
+}
+
+DBT_SCOPE void DBT_FN(free)(DBT_TYPE *db) {
+    dbinfo_remove(db);
+    free(db);
+}
+
+DBT_SCOPE DBT_TYPE *DBT_FN(build)(DBT_KEY *keys, DBT_VAL *values, int len) {
+    DBT_TYPE *db = DBT_FN(new)(len);
+
+    for (int i = 0; i < len; i++) {
+        DBT_KEY_SET(&db[i], keys[i]);
+        DBT_VAL_SET(&db[i], values[i]);
+    }
+#ifdef DBT_FREEZE
+    DBT_FREEZE(db);
+#endif
+
+    return db;
+}
+
+// Asks the directory only while some table has removed elements
+DBT_SCOPE bool DBT_FN(isRemoved)(DBT_TYPE *db, int idx) {
+    return dbinfo_removing() && dbinfo_removed(dbinfo_get(db), idx);
+}
+
+DBT_SCOPE int DBT_FN(findKey)(DBT_TYPE *db, DBT_KEY key) {
+    int i = 0;
+
+#ifdef DBT_FIND_FROZEN
+    dbinfo *info;
+
+    if (dbinfo_frozen() && ((info = dbinfo_get(db)) != NULL) && (info->keys != NULL)) {
+        return DBT_FIND_FROZEN(info, key);
+    }
+#endif
+
+    while (!DBT_IS_LAST(&db[i])) {
+        if (DBT_KEY_EQ(&db[i], key) && !DBT_FN(isRemoved)(db, i)) {
+            return i;
+        }
+
+        i++;
+    }
+
+    return -1;
+}
+
+DBT_SCOPE int DBT_FN(findKeys)(DBT_TYPE *db, DBT_KEY *keys, int n, int *idx) {
+    dbinfo *info = dbinfo_get(db);
+    int found = 0;
+
+    // Lookups leave the table as is, the index is used if there is one
+#ifdef DBT_FIND_FROZEN
+    if ((info != NULL) && (info->keys != NULL)) {
+#ifdef DBT_FIND_FROZEN_N
+        return DBT_FIND_FROZEN_N(info, keys, n, idx);
+#else
+        for (int i = 0; i < n; i++) {
+            idx[i] = DBT_FIND_FROZEN(info, keys[i]);
+            found += (idx[i] >= 0);
+        }
+        return found;
+#endif
+    }
+#endif
+
+    (void)info;
+    for (int i = 0; i < n; i++) {
+        idx[i] = DBT_FN(findKey)(db, keys[i]);
+        found += (idx[i] >= 0);
+    }
+    return found;
+}
+
+DBT_SCOPE int DBT_FN(findValue)(DBT_TYPE *db, DBT_VAL value) {
+    dbinfo *info = dbinfo_get(db);
+    int i = 0;
+
+    if ((info != NULL) && (info->values != NULL)) {
+        return DBT_FN(valueSearch)(db, info, value);
+    }
+
+    while (!DBT_IS_LAST(&db[i])) {
+        if (DBT_VAL_EQ(&db[i], value) && !dbinfo_removed(info, i)) {
+            return i;
+        }
+
+        i++;
+    }
+
+    return -1;
+}
+
+DBT_SCOPE DBT_GET DBT_FN(getValue)(DBT_TYPE *db, DBT_KEY key) {
+    int idx = DBT_FN(findKey)(db, key);
+
+    if (idx != -1) {
+        return db[idx].value;
+    } else {
+        return DBT_NONE;
+    }
+}
+
+DBT_SCOPE int DBT_FN(getValues)(DBT_TYPE *db, DBT_KEY *keys, int n, DBT_GET *values) {
+    int idx[DBT_BATCH];
+    int found = 0;
+    int m;
+
+    for (int i = 0; i < n; i += m) {
+        m = (n - i < DBT_BATCH) ? n - i : DBT_BATCH;
+        found += DBT_FN(findKeys)(db, keys + i, m, idx);
+        for (int j = 0; j < m; j++) {
+            values[i + j] = (idx[j] != -1) ? db[idx[j]].value : DBT_NONE;
+        }
+    }
+    return found;
+}
+
+DBT_SCOPE void DBT_FN(setValue)(DBT_TYPE *db, DBT_KEY key, DBT_VAL value) {
+    int idx = DBT_FN(findKey)(db, key);
+
+    if (idx != -1) {
+        DBT_FN(putValue)(db, dbinfo_get(db), idx, value);
+    }
+}
+
+DBT_SCOPE void DBT_FN(setKeyValue)(DBT_TYPE *db, int idx, DBT_KEY key, DBT_VAL value) {
+    dbinfo *info;
+
+    if (DBT_FN(inRange)(db, idx)) {
+        info = dbinfo_get(db);
+        dbinfo_thaw(info);
+        if (info != NULL) dbinfo_unmarkRemoved(info, idx);
+        DBT_KEY_SET(&db[idx], key);
+        DBT_FN(putValue)(db, info, idx, value);
+    }
+}
+
+DBT_SCOPE DBT_TYPE *DBT_FN(append)(DBT_TYPE *db, DBT_KEY key, DBT_VAL value) {
+    dbinfo *info;
+    int len;
+
+    info = dbinfo_get(db);
+    if ((info == NULL) || !info->owned) {
+        db = DBT_FN(copy)(db);
+        info = dbinfo_get(db);
+    }
+    dbinfo_thaw(info);
+
+    len = info->len;
+    if (len >= info->capacity) {
+        info->capacity = (len * 2 > DBINFO_CAPACITY) ? len * 2 : DBINFO_CAPACITY;
+        db = realloc(db, (info->capacity + 1) * sizeof(DBT_TYPE));
+        dbinfo_move(info, db);
+    }
+
+    db[len + 1] = db[len];
+    DBT_KEY_SET(&db[len], key);
+    DBT_VAL_SET(&db[len], value);
+    info->len++;
+
+    if (info->values != NULL) {
+        dbvalue_add(info->values, DBT_VAL_HASH(db[len].value), len);
+    }
+
+    return db;
+}
+
+DBT_SCOPE void DBT_FN(remove)(DBT_TYPE *db, int idx) {
+    dbinfo *info = dbinfo_get(db);
+    int len;
+
+    len = (info != NULL) ? info->len : DBT_FN(len)(db);
+    if ((idx < 0) || (idx >= len)) {
+        return;
+    }
+
+    dbinfo_thaw(info);
+    if (info != NULL) dbinfo_dropRemoved(info, idx);
+    memmove(&db[idx], &db[idx + 1], (len - idx) * sizeof(DBT_TYPE));
+
+    if (info != NULL) {
+        info->len--;
+
+        // Later elements moved, positions are rebuilt
+        if (info->values != NULL) DBT_FN(valueIndex)(db, info);
+    }
+}
+
+DBT_SCOPE int DBT_FN(compact)(DBT_TYPE *db) {
+    dbinfo *info = dbinfo_get(db);
+    bool frozen;
+    int len;
+    int n = 0;
+
+    // Only registered tables have removed elements
+    if ((info == NULL) || (info->dead == 0)) {
+        return 0;
+    }
+
+    len = info->len;
+    for (int i = 0; i < len; i++) {
+        if (dbinfo_removed(info, i)) continue;
+        if (n != i) db[n] = db[i];
+        n++;
+    }
+    db[n] = db[len];
+
+    // Positions changed, indexes are rebuilt
+    frozen = info->keys != NULL;
+    dbinfo_thaw(info);
+    dbinfo_clearRemoved(info);
+    info->len = n;
+    if (info->values != NULL) DBT_FN(valueIndex)(db, info);
+#ifdef DBT_FREEZE
+    if (frozen) DBT_FREEZE(db);
+#else
+    (void)frozen;
+#endif
+
+    return len - n;
+}
+
+DBT_SCOPE int DBT_FN(removeKey)(DBT_TYPE *db, DBT_KEY key) {
+    int idx = DBT_FN(findKey)(db, key);
+    dbinfo *info;
+
+    if (idx == -1) {
+        return -1;
+    }
+
+    // Removed elements are marked in the registration, others shift
+    info = dbinfo_get(db);
+    if (info == NULL) {
+        DBT_FN(remove)(db, idx);
+        return 0;
+    }
+
+    if (info->keys != NULL) {
+#ifdef DBT_REMOVE_FROZEN
+        DBT_REMOVE_FROZEN(info, &db[idx], idx);
+#else
+        dbinfo_thaw(info);
+#endif
+    }
+    if (info->values != NULL) {
+        dbvalue_delete(info->values, DBT_VAL_HASH(db[idx].value), idx);
+    }
+    dbinfo_markRemoved(info, idx);
+
+    if (info->dead * DBT_COMPACT_RATIO > info->len) {
+        DBT_FN(compact)(db);
+    }
+    return 0;
+}
+
+DBT_SCOPE size_t DBT_FN(indexValues)(DBT_TYPE *db) {
+    dbinfo *info = dbinfo_get(db);
+
+    if (info == NULL) {
+        return 0;
+    }
+    DBT_FN(valueIndex)(db, info);
+
+    return dbvalue_size(info->values);
+}
+
+DBT_SCOPE void DBT_FN(dropValues)(DBT_TYPE *db) {
+    dbinfo *info = dbinfo_get(db);
+
+    if ((info == NULL) || (info->values == NULL)) {
+        return;
+    }
+
+    dbvalue_free(info->values);
+    info->values = NULL;
+}
+
+DBT_SCOPE void DBT_FN(register)(DBT_TYPE *db) {
+    int len;
+
+    if (dbinfo_get(db) != NULL) {
+        return;
+    }
+
+    len = DBT_FN(len)(db);
+    dbinfo_add(db, len, len, false);
+}
+
+DBT_SCOPE void DBT_FN(unregister)(DBT_TYPE *db) {
+    dbinfo *info = dbinfo_get(db);
+
+    if ((info == NULL) || info->owned) {
+        return;
+    }
+
+    dbinfo_thaw(info);
+    DBT_FN(compact)(db);
+    dbinfo_remove(db);
+}
+
+DBT_SCOPE int DBT_FN(last)(DBT_TYPE *db) {
+    return DBT_FN(len)(db) - 1;
+}
+
+DBT_SCOPE int DBT_FN(first)(DBT_TYPE *db) {
+    (void)db;
+    return 0;
+}
+
+DBT_SCOPE void DBT_FN(printDb)(DBT_TYPE *db) {
+    dbinfo *info = dbinfo_get(db);
+    int len = DBT_FN(len)(db);
+
+    for (int i = 0; i < len; i++) {
+        if (!dbinfo_removed(info, i)) DBT_PRINT(&db[i]);
+    }
+}
+
+#undef DBT_FN
+#undef DBT_SCOPE
+#undef DBT_PREFIX
+#undef DBT_TYPE
+#undef DBT_KEY
+#undef DBT_VAL
+#undef DBT_GET
+#undef DBT_NONE
+#undef DBT_IS_LAST
+#undef DBT_SET_LAST
+#undef DBT_KEY_EQ
+#undef DBT_VAL_EQ
+#undef DBT_KEY_SET
+#undef DBT_VAL_SET
+#undef DBT_VAL_HASH
+#undef DBT_PRINT
+#undef DBT_FIND_FROZEN
+#undef DBT_FIND_FROZEN_N
+#undef DBT_REMOVE_FROZEN
+#undef DBT_FREEZE
@@ -0,0 +1,221 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Hash index of table values.
+ *
+ * @file     dbvalue.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dbvalue.h"
+
+// Prototypes -------------------------------------------------------------
+
+static uint32_t dbvalue_mix(uint32_t h);
+static void dbvalue_alloc(dbvalue *v, size_t slots);
+static void dbvalue_grow(dbvalue *v);
+static void dbvalue_reserve(dbvalue *v, int capacity);
+static size_t dbvalue_home(dbvalue *v, uint32_t hash);
+static dbvalue_slot *dbvalue_find(dbvalue *v, uint32_t hash);
+static void dbvalue_put(dbvalue *v, uint32_t hash, int pos);
+static void dbvalue_erase(dbvalue *v, size_t hole);
+
+// Code -------------------------------------------------------------------
+
+static uint32_t dbvalue_mix(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+static void dbvalue_alloc(dbvalue *v, size_t slots) {
+    v->slots = (dbvalue_slot *)malloc(slots * sizeof(dbvalue_slot));
+    memset(v->slots, 0xff, slots * sizeof(dbvalue_slot));
+    v->mask = slots - 1;
+}
+
+// Chains stay where they are, only the slots of their heads move
+static void dbvalue_grow(dbvalue *v) {
+    dbvalue_slot *old = v->slots;
+    size_t n = v->mask + 1;
+
+    dbvalue_alloc(v, n * 2);
+    for (size_t i = 0; i < n; i++) {
+        if (old[i].pos >= 0) dbvalue_put(v, old[i].hash, old[i].pos);
+    }
+    free(old);
+}
+
+static void dbvalue_reserve(dbvalue *v, int capacity) {
+    int n = (v->capacity * 2 > capacity) ? v->capacity * 2 : capacity;
+
+    v->links = (dbvalue_link *)realloc(v->links, (size_t)n * sizeof(dbvalue_link));
+    memset(v->links + v->capacity, 0xff, (size_t)(n - v->capacity) * sizeof(dbvalue_link));
+    v->capacity = n;
+}
+
+static size_t dbvalue_home(dbvalue *v, uint32_t hash) {
+    return dbvalue_mix(hash) & v->mask;
+}
+
+static dbvalue_slot *dbvalue_find(dbvalue *v, uint32_t hash) {
+    size_t i = dbvalue_home(v, hash);
+
+    while (v->slots[i].pos >= 0) {
+        if (v->slots[i].hash == hash) return &v->slots[i];
+        i = (i + 1) & v->mask;
+    }
+    return NULL;
+}
+
+static void dbvalue_put(dbvalue *v, uint32_t hash, int pos) {
+    size_t i = dbvalue_home(v, hash);
+
+    while (v->slots[i].pos >= 0) i = (i + 1) & v->mask;
+    v->slots[i].hash = hash;
+    v->slots[i].pos = pos;
+}
+
+// Backward shift, slots after the hole move up if that brings them
+// closer to their home slot
+static void dbvalue_erase(dbvalue *v, size_t hole) {
+    dbvalue_slot *s = v->slots;
+    size_t home;
+    size_t i;
+
+    for (i = hole;;) {
+        i = (i + 1) & v->mask;
+        if (s[i].pos < 0) break;
+
+        home = dbvalue_home(v, s[i].hash);
+        if (((i - home) & v->mask) >= ((i - hole) & v->mask)) {
+            s[hole] = s[i];
+            hole = i;
+        }
+    }
+    s[hole].pos = -1;
+}
+
+dbvalue *dbvalue_new(int len) {
+    dbvalue *v = (dbvalue *)calloc(1, sizeof(dbvalue));
+    size_t slots = DBVALUE_SLOTS;
+
+    while (slots < (size_t)len * 2) slots *= 2;
+    dbvalue_alloc(v, slots);
+    dbvalue_reserve(v, (len > DBVALUE_SLOTS) ? len : DBVALUE_SLOTS);
+    return v;
+}
+
+void dbvalue_free(dbvalue *v) {
+    if (v == NULL) return;
+
+    free(v->slots);
+    free(v->links);
+    free(v);
+}
+
+// FNV-1a
+uint32_t dbvalue_hash(const char *str, size_t len) {
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+uint32_t dbvalue_hashInt(int value) {
+    return dbvalue_mix((uint32_t)value);
+}
+
+void dbvalue_add(dbvalue *v, uint32_t hash, int pos) {
+    dbvalue_link *l;
+    dbvalue_slot *s;
+    int down = pos - 1;
+    int at;
+
+    if (pos >= v->capacity) dbvalue_reserve(v, pos + 1);
+    l = v->links;
+    l[pos].hash = hash;
+    v->count++;
+
+    s = dbvalue_find(v, hash);
+    if (s == NULL) {
+        if ((size_t)(v->used + 1) * 2 > v->mask + 1) dbvalue_grow(v);
+        dbvalue_put(v, hash, pos);
+        v->used++;
+        l[pos].next = pos;
+        l[pos].prev = pos;
+        return;
+    }
+
+    // Link in after the highest position below pos, a new lowest one
+    // goes after the highest and becomes the head. Below the head the
+    // walk down the table always ends at it.
+    at = l[s->pos].prev;
+    if (pos < s->pos) {
+        s->pos = pos;
+    } else {
+        while (at > pos) {
+            if ((l[down].prev >= 0) && (l[down].hash == hash)) {
+                at = down;
+                break;
+            }
+            down--;
+            at = l[at].prev;
+        }
+    }
+    l[pos].prev = at;
+    l[pos].next = l[at].next;
+    l[l[at].next].prev = pos;
+    l[at].next = pos;
+}
+
+void dbvalue_delete(dbvalue *v, uint32_t hash, int pos) {
+    dbvalue_link *l = v->links;
+    dbvalue_slot *s;
+
+    if ((pos < 0) || (pos >= v->capacity) || (l[pos].prev < 0) || (l[pos].hash != hash)) return;
+    s = dbvalue_find(v, hash);
+
+    if (l[pos].next == pos) {
+        dbvalue_erase(v, (size_t)(s - v->slots));
+        v->used--;
+    } else {
+        l[l[pos].prev].next = l[pos].next;
+        l[l[pos].next].prev = l[pos].prev;
+        if (s->pos == pos) s->pos = l[pos].next;
+    }
+    l[pos].next = -1;
+    l[pos].prev = -1;
+    v->count--;
+}
+
+int dbvalue_first(dbvalue *v, uint32_t hash) {
+    dbvalue_slot *s = dbvalue_find(v, hash);
+
+    return (s != NULL) ? s->pos : -1;
+}
+
+int dbvalue_next(dbvalue *v, int pos) {
+    int next = v->links[pos].next;
+
+    return (next > pos) ? next : -1;
+}
+
+size_t dbvalue_size(dbvalue *v) {
+    return sizeof(dbvalue) + (v->mask + 1) * sizeof(dbvalue_slot) + (size_t)v->capacity * sizeof(dbvalue_link);
+}
@@ -0,0 +1,149 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Hash index of table values.
+ *
+ * @file     dbvalue.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Maps the hash of a value to the positions of all elements holding it,
+ * for reverse lookups in i2i, I2S and S2S tables. The index only knows
+ * hashes, the table compares the values at the positions returned:
+ *
+ *   for (pos = dbvalue_first(v, hash); pos >= 0; pos = dbvalue_next(v, pos)) {
+ *       compare db[pos]
+ *   }
+ *
+ * Each distinct hash has one slot, positions holding it are chained in
+ * ascending order, so duplicate values cost neither building nor lookup.
+ * Adding the lowest or highest position of a hash and deleting any are
+ * O(1). Adding one between others looks for the one before it down the
+ * chain from its end and down the table from pos at the same time, the
+ * nearer is found first. Slots are 8 bytes and kept at most half full,
+ * the chain 12 bytes for each element of the table.
+ */
+
+#ifndef DBVALUE_H
+#define DBVALUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Macros -----------------------------------------------------------------
+
+#define DBVALUE_SLOTS 16  // Smallest nr of slots, a power of 2
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    uint32_t hash;
+    int pos;         // Lowest position with hash, -1 for an empty slot
+} dbvalue_slot;
+
+typedef struct {
+    int next;        // Next higher position with the same hash, wrapping
+    int prev;        // to the lowest, -1 for a position not in the index
+    uint32_t hash;
+} dbvalue_link;
+
+typedef struct {
+    dbvalue_slot *slots;
+    size_t mask;     // nr of slots - 1
+    int used;        // nr of slots in use, distinct hashes
+    int count;       // nr of positions in index
+    dbvalue_link *links;
+    int capacity;    // nr of positions links has room for
+} dbvalue;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create new index.
+ *
+ * @param len nr of positions to make room for
+ * @return pointer to index
+ */
+dbvalue *dbvalue_new(int len);
+
+/**
+ * Deallocate index.
+ *
+ * @param v index, NULL is ignored
+ */
+void dbvalue_free(dbvalue *v);
+
+/**
+ * Hash of a string value.
+ *
+ * @param str characters
+ * @param len nr of characters
+ * @return hash
+ */
+uint32_t dbvalue_hash(const char *str, size_t len);
+
+/**
+ * Hash of an integer value.
+ *
+ * @param value value
+ * @return hash
+ */
+uint32_t dbvalue_hashInt(int value);
+
+/**
+ * Add position of a value.
+ *
+ * @param v index
+ * @param hash hash of value
+ * @param pos position in table
+ */
+void dbvalue_add(dbvalue *v, uint32_t hash, int pos);
+
+/**
+ * Remove position of a value.
+ *
+ * @param v index
+ * @param hash hash of value at pos when it was added
+ * @param pos position in table, not in index is ignored
+ */
+void dbvalue_delete(dbvalue *v, uint32_t hash, int pos);
+
+/**
+ * Lowest position of a value with hash.
+ *
+ * @param v index
+ * @param hash hash of value
+ * @return position, -1 if there is none
+ */
+int dbvalue_first(dbvalue *v, uint32_t hash);
+
+/**
+ * Next higher position with the same hash as pos.
+ *
+ * @param v index
+ * @param pos position from dbvalue_first() or dbvalue_next()
+ * @return position, -1 when there are no more
+ */
+int dbvalue_next(dbvalue *v, int pos);
+
+/**
+ * Memory held by index.
+ *
+ * @param v index
+ * @return bytes allocated
+ */
+size_t dbvalue_size(dbvalue *v);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
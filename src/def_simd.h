@@ -0,0 +1,66 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Selection of SSE2/AVX2 implementations.
+ *
+ * @file     def_simd.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Modules with SSE2/AVX2 code paths keep function pointers to the
+ * implementations in use, set by a select function of their own that
+ * takes a level, -1 for the best one the CPU supports. DEF_SIMD_INIT()
+ * runs it once when the program or library is loaded, before any thread
+ * can call in, so afterwards the pointers are only read. Selecting again
+ * is for tests and benchmarks and must not race with other threads.
+ */
+
+#ifndef DEF_SIMD_H
+#define DEF_SIMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DEF_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// Macros -----------------------------------------------------------------
+
+#define DEF_SIMD_SCALAR 0  // No vector instructions
+#define DEF_SIMD_SSE2 1
+#define DEF_SIMD_AVX2 2
+
+// Call select(-1) once at load time
+#define DEF_SIMD_INIT(select) \
+    __attribute__((constructor)) static void select##_init(void) { select(-1); }
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Best level the CPU supports.
+ *
+ * @return DEF_SIMD_*
+ */
+static inline int def_simd_supported(void) {
+    int level = DEF_SIMD_SCALAR;
+
+#ifdef DEF_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) level = DEF_SIMD_SSE2;
+    if (__builtin_cpu_supports("avx2")) level = DEF_SIMD_AVX2;
+#endif
+    return level;
+}
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
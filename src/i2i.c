@@ -14,122 +14,54 @@
 
 #include "def.h"
 #include "i2i.h"
-
+#include "dbinfo.h"
+#include "dbvalue.h"
+#include "dbkeys.h"
 
 // Code -------------------------------------------------------------------
 
-i2i *i2i_new(int size) {
-    i2i *db;
-
-    db = malloc((size + 1) * sizeof(i2i));
-
-    db[size].key = I2I_LAST;
-    db[size].value = 0;
-
-    return db;
-}
-
-i2i *i2i_copy(i2i *db) {
-    i2i *dst;
-    int len;
-
-    len = i2i_len(db);
-    dst = i2i_new(len);
-    memcpy(dst, db, len * sizeof(i2i));
-
-    return dst;
-}
-
-void i2i_free(i2i *db) {
-    free(db);
-}
-
-int i2i_findKey(i2i *db, int key) {
-    int i = 0;
-
-    while (db[i].key != I2I_LAST) {
-        if (db[i].key == key) {
-            return i;
-        }
-
-        i++;
+#define DBT_PREFIX i2i
+#define DBT_TYPE i2i
+#define DBT_KEY I2I_KEY
+#define DBT_VAL I2I_VAL
+#define DBT_GET I2I_VAL
+#define DBT_NONE 0
+#define DBT_IS_LAST(e) ((e)->key == I2I_LAST)
+#define DBT_SET_LAST(e) ((e)->key = I2I_LAST)
+#define DBT_KEY_EQ(e, k) ((e)->key == (k))
+#define DBT_VAL_EQ(e, v) ((e)->value == (v))
+#define DBT_KEY_SET(e, k) ((e)->key = (k))
+#define DBT_VAL_SET(e, v) ((e)->value = (v))
+#define DBT_VAL_HASH(v) dbvalue_hashInt(v)
+#define DBT_PRINT(e) printf("%8d   %8d\n", (e)->key, (e)->value)
+#define DBT_FIND_FROZEN(info, k) dbkeys_find((info)->keys, k)
+#define DBT_FIND_FROZEN_N(info, keys, n, idx) dbkeys_findKeys((info)->keys, keys, n, idx)
+#define DBT_REMOVE_FROZEN(info, e, idx) dbkeys_remove((info)->keys, (e)->key, idx)
+#define DBT_FREEZE(db) i2i_freeze(db)
+#include "dbtable.h"
+
+void i2i_freeze(i2i *db) {
+    dbinfo *info = dbinfo_get(db);
+    dbkeys *k;
+
+    if (info == NULL) {
+        return;
     }
 
-    return -1;
-}
-
-int i2i_findValue(i2i *db, I2I_VAL value) {
-    int i = 0;
-
-    while (db[i].key != I2I_LAST) {
-
-        if (db[i].value == value) {
-            return i;
-        }
-
-        i++;
+    // Removed elements keep their keys, they are taken out of the index
+    k = dbkeys_new(&db[0].key, sizeof(i2i), info->len);
+    for (int i = 0; (i < info->len) && (info->dead > 0); i++) {
+        if (dbinfo_removed(info, i)) dbkeys_remove(k, db[i].key, i);
     }
-
-    return -1;
+    dbinfo_freeze(info, k);
 }
 
-I2I_VAL i2i_getValue(i2i *db, I2I_KEY key) {
-    int idx = 0;
-
-    idx = i2i_findKey(db, key);
+void i2i_thaw(i2i *db) {
+    dbinfo *info = dbinfo_get(db);
 
-    if (idx != -1) {
-        return db[idx].value;
-    } else {
-        return 0;
+    if (info == NULL) {
+        return;
     }
-}
-
-void i2i_setValue(i2i *db, I2I_KEY key, I2I_VAL value) {
-    int idx = 0;
 
-    idx = i2i_findValue(db, key);
-
-    if (idx != -1) {
-        //db[idx].key = key;
-        db[idx].value = value;
-    }
-}
-
-void i2i_setKeyValue(i2i *db, int idx, I2I_KEY key, I2I_VAL value) {
-
-    if (isWithin(idx, 0, i2i_len(db) - 1)) {
-        db[idx].key = key;
-        db[idx].value = value;
-    }
-}
-
-
-int i2i_len(i2i *db) {
-    int i = 0;
-
-    while (db[i].key != I2I_LAST) {
-        i++;
-    }
-
-    return i;
-}
-
-int i2i_last(i2i *db) {
-    return i2i_len(db) - 1;
+    dbinfo_thaw(info);
 }
-
-int i2i_first(i2i *db) {
-    UNUSED(db);
-    return 0;
-}
-
-void i2i_printDb(i2i *db) {
-    int i;
-
-    for (i = 0; i < i2i_len(db); i++) {
-        printf("%8d   %8d\n", db[i].key, db[i].value);
-    }
-}
-
-
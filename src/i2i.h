@@ -19,6 +19,9 @@ extern "C" {
 
 // Includes ---------------------------------------------------------------
 
+#include <stdbool.h>
+#include <stddef.h>
+
 // Macros -----------------------------------------------------------------
 
 #define I2I_LAST (int)0xFFFFFFFF
@@ -57,12 +60,46 @@ i2i *i2i_new(int size);
 i2i *i2i_copy(i2i *db);
 
 /**
- * Deallocate database.
+ * Deallocate database. Tables from i2i_new(), i2i_copy() and i2i_build()
+ * are released with this rather than free(), which would leave their
+ * indexes behind.
  *
  * @param db database to deallocate
  */
 void i2i_free(i2i *db);
 
+/**
+ * Register a table not allocated by the library, e.g. a static table or
+ * one on the stack, so that it can be indexed and i2i_removeKey() can
+ * leave removed elements in place. Tables are known by address,
+ * unregister the table with i2i_unregister() before its storage is
+ * reused or goes out of scope. Registering a table twice does nothing.
+ *
+ * @param db database to register
+ */
+void i2i_register(i2i *db);
+
+/**
+ * Unregister a table registered by i2i_register(). Its indexes are
+ * dropped and elements removed by i2i_removeKey() are compacted away.
+ * Tables from i2i_new() are left to i2i_free().
+ *
+ * @param db database to unregister
+ */
+void i2i_unregister(i2i *db);
+
+/**
+ * Create database from arrays of keys and values, and freeze it (see
+ * i2i_freeze()). One pass over the arrays and one sort of the keys,
+ * instead of a i2i_setKeyValue() per element.
+ *
+ * @param keys key of each element
+ * @param values value of each element
+ * @param len nr of elements
+ * @return pointer to db
+ */
+i2i *i2i_build(I2I_KEY *keys, I2I_VAL *values, int len);
+
 /**
  * Find index of key in database.
  *
@@ -72,6 +109,20 @@ void i2i_free(i2i *db);
  */
 int i2i_findKey(i2i *db, I2I_KEY key);
 
+/**
+ * Find index of each of an array of keys. Searches of a frozen database
+ * are interleaved and prefetch the index. A database that is not frozen
+ * is scanned for each key and not changed, freeze it with i2i_freeze()
+ * first to look up large batches.
+ *
+ * @param db database to search
+ * @param keys keys to be found in database
+ * @param n nr of keys
+ * @param idx index of each key in db, -1 if not found
+ * @return nr of keys found
+ */
+int i2i_findKeys(i2i *db, I2I_KEY *keys, int n, int *idx);
+
 /**
  * Find index of value in database.
  *
@@ -89,6 +140,17 @@ int i2i_findValue(i2i *db, I2I_VAL value);
  */
 I2I_VAL i2i_getValue(i2i *db, I2I_KEY key);
 
+/**
+ * Get the values of an array of keys, see i2i_findKeys().
+ *
+ * @param db database to search
+ * @param keys keys to find
+ * @param n nr of keys
+ * @param values value of each key, 0 if not found
+ * @return nr of keys found
+ */
+int i2i_getValues(i2i *db, I2I_KEY *keys, int n, I2I_VAL *values);
+
 /**
  * Set value to corresponding key in database
  * @param db database to set value in
@@ -107,6 +169,100 @@ void i2i_setValue(i2i *db, I2I_KEY key, I2I_VAL value);
 void i2i_setKeyValue(i2i *db, int idx, I2I_KEY key, I2I_VAL value);
 
 
+/**
+ * Append element, growing the table. Tables not created by i2i_new()
+ * or i2i_copy() (e.g. static tables) are first copied, so always
+ * continue with the returned table.
+ *
+ * @param db database to append to
+ * @param key new key
+ * @param value new value
+ * @return database, possibly moved
+ */
+i2i *i2i_append(i2i *db, I2I_KEY key, I2I_VAL value);
+
+/**
+ * Remove element, later elements move down one index.
+ *
+ * @param db database to remove from
+ * @param idx index of element to remove
+ */
+void i2i_remove(i2i *db, int idx);
+
+/**
+ * Remove the first element with key. The element is left in place and
+ * marked removed, see i2i_isRemoved(), no lookup finds it and positions
+ * and indexes stay valid. When more than a quarter of the elements are
+ * removed the database is compacted, see i2i_compact(). In a table that is
+ * not registered, see i2i_register(), later elements move down as by
+ * i2i_remove() instead.
+ *
+ * @param db database to remove from
+ * @param key key of element to remove
+ * @return 0 if removed, -1 if key not found
+ */
+int i2i_removeKey(i2i *db, I2I_KEY key);
+
+/**
+ * Check if an element was removed by i2i_removeKey(). It keeps its key
+ * and value until the database is compacted, code reading the array
+ * directly should skip it.
+ *
+ * @param db database
+ * @param idx index of element
+ * @return true if removed
+ */
+bool i2i_isRemoved(i2i *db, int idx);
+
+/**
+ * Drop elements removed by i2i_removeKey(), later elements move down,
+ * and rebuild the indexes of the database.
+ *
+ * @param db database to compact
+ * @return nr of elements dropped
+ */
+int i2i_compact(i2i *db);
+
+/**
+ * Freeze database for fast key lookup. The keys are copied to an array of
+ * their own, after which i2i_findKey(), i2i_getValue() and i2i_setValue()
+ * scan it 4 or 8 keys at a time, or use binary search for tables of more
+ * than DBKEYS_PACKED elements. Static tables are indexed once registered,
+ * see i2i_register(), the table itself is not changed. Changing keys
+ * through i2i_setKeyValue(), i2i_append() or i2i_remove() drops the index,
+ * i2i_removeKey() keeps it.
+ *
+ * @param db database to freeze
+ */
+void i2i_freeze(i2i *db);
+
+/**
+ * Drop the index built by i2i_freeze().
+ *
+ * @param db database to thaw
+ */
+void i2i_thaw(i2i *db);
+
+/**
+ * Index values for fast i2i_findValue(). A hash index of the values is
+ * built and kept up to date by i2i_setValue(), i2i_setKeyValue(),
+ * i2i_append() and i2i_remove(), values written to the table directly are
+ * not seen. Static tables must be registered first, see i2i_register(),
+ * else nothing is done. i2i_append() on those returns a copy without
+ * index. Costs 16 to 32 bytes per element.
+ *
+ * @param db database to index
+ * @return bytes used by the index
+ */
+size_t i2i_indexValues(i2i *db);
+
+/**
+ * Drop the index built by i2i_indexValues().
+ *
+ * @param db database
+ */
+void i2i_dropValues(i2i *db);
+
 /**
  * First element in database.
  *
@@ -123,7 +279,8 @@ int i2i_first(i2i *db);
 int i2i_last(i2i *db);
 
 /**
- * Length of database.
+ * Length of database. Tables created by i2i_new() or i2i_copy() keep
+ * their length, others are scanned for the sentinel.
  *
  * @param db database to be questioned
  * @return nr of elements in db
@@ -0,0 +1,211 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Hash index for integer 2 integer associative arrays.
+ *
+ * @file     i2i_index.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i2i_index.h"
+
+// Prototypes -------------------------------------------------------------
+
+static uint32_t i2i_index_home(i2i_index *ix, I2I_KEY key);
+static void i2i_index_alloc(i2i_index *ix, int slots);
+static void i2i_index_insert(i2i_index *ix, I2I_KEY key, int pos);
+static void i2i_index_grow(i2i_index *ix);
+static void i2i_index_own(i2i_index *ix, int capacity);
+
+// Code -------------------------------------------------------------------
+
+// 32 bit finalizer, keys that are sequential or share a stride spread
+// over all slots. The top bits pick the slot.
+static inline uint32_t i2i_index_home(i2i_index *ix, I2I_KEY key) {
+    uint32_t h = (uint32_t)key;
+
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h >> ix->shift;
+}
+
+static void i2i_index_alloc(i2i_index *ix, int slots) {
+    int bits = 0;
+
+    while ((1 << bits) < slots) bits++;
+
+    ix->slots = (i2i_slot *)malloc(((size_t)1 << bits) * sizeof(i2i_slot));
+    memset(ix->slots, 0xff, ((size_t)1 << bits) * sizeof(i2i_slot));
+    ix->mask = (1 << bits) - 1;
+    ix->shift = 32 - bits;
+}
+
+// Key must not be in the index. Richer slots (closer to home) give way
+// to the entry being placed, which keeps probe lengths even.
+static void i2i_index_insert(i2i_index *ix, I2I_KEY key, int pos) {
+    i2i_slot in = {key, pos};
+    i2i_slot tmp;
+    uint32_t i = i2i_index_home(ix, key);
+    uint32_t dist = 0;
+    uint32_t d;
+
+    for (;;) {
+        if (ix->slots[i].pos < 0) {
+            ix->slots[i] = in;
+            return;
+        }
+
+        d = (i - i2i_index_home(ix, ix->slots[i].key)) & ix->mask;
+        if (d < dist) {
+            tmp = ix->slots[i];
+            ix->slots[i] = in;
+            in = tmp;
+            dist = d;
+        }
+
+        i = (i + 1) & ix->mask;
+        dist++;
+    }
+}
+
+static void i2i_index_grow(i2i_index *ix) {
+    i2i_slot *old = ix->slots;
+    int n = ix->mask + 1;
+
+    i2i_index_alloc(ix, n * 2);
+    for (int i = 0; i < n; i++) {
+        if (old[i].pos >= 0) i2i_index_insert(ix, old[i].key, old[i].pos);
+    }
+    free(old);
+}
+
+// Make db an array owned by the index with room for capacity elements
+static void i2i_index_own(i2i_index *ix, int capacity) {
+    i2i *db;
+
+    if (ix->capacity == 0) {
+        db = (i2i *)malloc((capacity + 1) * sizeof(i2i));
+        memcpy(db, ix->db, (ix->len + 1) * sizeof(i2i));
+    } else {
+        db = (i2i *)realloc(ix->db, (capacity + 1) * sizeof(i2i));
+    }
+    ix->db = db;
+    ix->capacity = capacity;
+}
+
+i2i_index *i2i_index_new(i2i *db) {
+    i2i_index *ix = (i2i_index *)calloc(1, sizeof(i2i_index));
+
+    if (db == NULL) {
+        ix->db = (i2i *)malloc((I2I_INDEX_SLOTS + 1) * sizeof(i2i));
+        ix->db[0].key = I2I_LAST;
+        ix->db[0].value = 0;
+        ix->capacity = I2I_INDEX_SLOTS;
+    } else {
+        ix->db = db;
+    }
+
+    i2i_index_rebuild(ix);
+    return ix;
+}
+
+void i2i_index_free(i2i_index *ix) {
+    if (ix == NULL) return;
+
+    if (ix->capacity) free(ix->db);
+    free(ix->slots);
+    free(ix);
+}
+
+void i2i_index_rebuild(i2i_index *ix) {
+    int slots = I2I_INDEX_SLOTS;
+
+    ix->len = i2i_len(ix->db);
+    while (slots / 4 * 3 < ix->len) slots *= 2;
+
+    free(ix->slots);
+    i2i_index_alloc(ix, slots);
+
+    for (int i = 0; i < ix->len; i++) {
+        if (i2i_index_findKey(ix, ix->db[i].key) < 0) i2i_index_insert(ix, ix->db[i].key, i);
+    }
+}
+
+int i2i_index_findKey(i2i_index *ix, I2I_KEY key) {
+    uint32_t i = i2i_index_home(ix, key);
+    uint32_t dist = 0;
+    i2i_slot *s;
+
+    for (;;) {
+        s = &ix->slots[i];
+        if (s->pos < 0) return -1;
+        if (s->key == key) return s->pos;
+
+        // An entry closer to its home means key would have been placed here
+        if (((i - i2i_index_home(ix, s->key)) & ix->mask) < dist) return -1;
+
+        i = (i + 1) & ix->mask;
+        dist++;
+    }
+}
+
+I2I_VAL i2i_index_getValue(i2i_index *ix, I2I_KEY key) {
+    int idx = i2i_index_findKey(ix, key);
+
+    if (idx != -1) {
+        return ix->db[idx].value;
+    } else {
+        return 0;
+    }
+}
+
+void i2i_index_setValue(i2i_index *ix, I2I_KEY key, I2I_VAL value) {
+    int idx = i2i_index_findKey(ix, key);
+
+    if (idx != -1) {
+        ix->db[idx].value = value;
+    }
+}
+
+int i2i_index_put(i2i_index *ix, I2I_KEY key, I2I_VAL value) {
+    int idx;
+
+    if (key == I2I_LAST) return -1;
+
+    idx = i2i_index_findKey(ix, key);
+    if (idx != -1) {
+        ix->db[idx].value = value;
+        return idx;
+    }
+
+    if (ix->len >= ix->capacity) {
+        i2i_index_own(ix, ix->len < I2I_INDEX_SLOTS ? I2I_INDEX_SLOTS : ix->len * 2);
+    }
+    if ((ix->len + 1) > (ix->mask + 1) / 4 * 3) i2i_index_grow(ix);
+
+    idx = ix->len++;
+    ix->db[idx].key = key;
+    ix->db[idx].value = value;
+    ix->db[ix->len].key = I2I_LAST;
+    ix->db[ix->len].value = 0;
+
+    i2i_index_insert(ix, key, idx);
+    return idx;
+}
+
+int i2i_index_len(i2i_index *ix) {
+    return ix->len;
+}
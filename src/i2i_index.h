@@ -0,0 +1,130 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Hash index for integer 2 integer associative arrays.
+ *
+ * @file     i2i_index.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * An open addressing (robin hood) hash table from key to position in an
+ * i2i array, so lookups no longer scan to the I2I_LAST sentinel.
+ *
+ * The index is either built over an existing array, which is left in
+ * place and must not be changed behind the index's back (call
+ * i2i_index_rebuild() after editing it directly), or created empty and
+ * used as a map of its own through i2i_index_put(). In both cases
+ * ix->db stays a valid I2I_LAST terminated array usable by all i2i_*
+ * functions. When a key occurs more than once the first one is indexed,
+ * same as i2i_findKey().
+ */
+
+#ifndef I2I_INDEX_H
+#define I2I_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include "i2i.h"
+
+// Macros -----------------------------------------------------------------
+
+#define I2I_INDEX_SLOTS 8  // Smallest nr of hash slots, a power of 2
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    I2I_KEY key;
+    int pos;        // Index in db, -1 for an empty slot
+} i2i_slot;
+
+typedef struct {
+    i2i *db;        // Indexed array, I2I_LAST terminated
+    i2i_slot *slots;
+    int mask;       // nr of slots - 1
+    int shift;      // 32 - log2(nr of slots)
+    int len;        // nr of elements in db
+    int capacity;   // Elements db has room for, 0 if db is not owned
+} i2i_index;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create new index.
+ *
+ * @param db array to index, NULL for an empty map owned by the index
+ * @return pointer to index
+ */
+i2i_index *i2i_index_new(i2i *db);
+
+/**
+ * Deallocate index, and db if owned by the index.
+ *
+ * @param ix index to deallocate
+ */
+void i2i_index_free(i2i_index *ix);
+
+/**
+ * Rebuild index after db has been changed directly.
+ *
+ * @param ix index to rebuild
+ */
+void i2i_index_rebuild(i2i_index *ix);
+
+/**
+ * Find index of key in database.
+ *
+ * @param ix index to search
+ * @param key the key to be found
+ * @return -1 if key not found, >=0 index in ix->db
+ */
+int i2i_index_findKey(i2i_index *ix, I2I_KEY key);
+
+/**
+ * Get the value to corresponding key.
+ *
+ * @param ix index to search
+ * @param key key to find
+ * @return value, 0 if key not found
+ */
+I2I_VAL i2i_index_getValue(i2i_index *ix, I2I_KEY key);
+
+/**
+ * Set value of an existing key.
+ *
+ * @param ix index to search
+ * @param key the key whos value to be set
+ * @param value new value
+ */
+void i2i_index_setValue(i2i_index *ix, I2I_KEY key, I2I_VAL value);
+
+/**
+ * Set value of key, appending the key if not present. An array the
+ * index was built over is first copied into one owned by the index,
+ * so ix->db may change.
+ *
+ * @param ix index to update
+ * @param key key, I2I_LAST is not a valid key
+ * @param value new value
+ * @return index of key in ix->db, -1 for an invalid key
+ */
+int i2i_index_put(i2i_index *ix, I2I_KEY key, I2I_VAL value);
+
+/**
+ * Length of database.
+ *
+ * @param ix index to be questioned
+ * @return nr of elements in ix->db
+ */
+int i2i_index_len(i2i_index *ix);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
@@ -14,120 +14,58 @@
 
 #include "def.h"
 #include "i2s.h"
-
+#include "dbinfo.h"
+#include "dbvalue.h"
+#include "dbkeys.h"
 
 // Code -------------------------------------------------------------------
 
-I2S *I2S_new(int size) {
-    I2S *db;
-
-    db = malloc((size + 1) * sizeof(I2S));
-
-    db[size].key = I2S_LAST;
-    db[size].value[0] = '\0';
-
-    return db;
-}
-
-I2S *I2S_copy(I2S *db) {
-    I2S *dst;
-    int len;
-
-    len = I2S_len(db);
-    dst = I2S_new(len);
-    memcpy(dst, db, len * sizeof(I2S));
-
-    return dst;
-}
-
-void I2S_free(I2S *db) {
-    free(db);
-}
-
-int I2S_findKey(I2S *db, int key) {
-    int i = 0;
-
-    while (db[i].key != I2S_LAST) {
-        if (db[i].key == key) {
-            return i;
-        }
-
-        i++;
-    }
-
-    return -1;
-}
-
-int I2S_findValue(I2S *db, char *value) {
-    int i = 0;
-
-    while (db[i].key != I2S_LAST) {
-        if (!strncmp(db[i].value, value, I2S_STRLEN)) {
-            return i;
-        }
-
-        i++;
-    }
-
-    return -1;
+static uint32_t I2S_valueHash(const char *value) {
+    return dbvalue_hash(value, strnlen(value, I2S_STRLEN));
 }
 
-char *I2S_getValue(I2S *db, I2S_KEY key) {
-    int idx = 0;
-
-    idx = I2S_findKey(db, key);
-
-    if (idx != -1) {
-        return db[idx].value;
-    } else {
-        return NULL;
+#define DBT_PREFIX I2S
+#define DBT_TYPE I2S
+#define DBT_KEY I2S_KEY
+#define DBT_VAL char *
+#define DBT_GET char *
+#define DBT_NONE NULL
+#define DBT_IS_LAST(e) ((e)->key == I2S_LAST)
+#define DBT_SET_LAST(e) ((e)->key = I2S_LAST)
+#define DBT_KEY_EQ(e, k) ((e)->key == (k))
+#define DBT_VAL_EQ(e, v) !strncmp((e)->value, (v), I2S_STRLEN)
+#define DBT_KEY_SET(e, k) ((e)->key = (k))
+#define DBT_VAL_SET(e, v) strncpy((e)->value, (v), I2S_STRLEN)
+#define DBT_VAL_HASH(v) I2S_valueHash(v)
+#define DBT_PRINT(e) printf("%8d   %s\n", (e)->key, (e)->value)
+#define DBT_FIND_FROZEN(info, k) dbkeys_find((info)->keys, k)
+#define DBT_FIND_FROZEN_N(info, keys, n, idx) dbkeys_findKeys((info)->keys, keys, n, idx)
+#define DBT_REMOVE_FROZEN(info, e, idx) dbkeys_remove((info)->keys, (e)->key, idx)
+#define DBT_FREEZE(db) I2S_freeze(db)
+#include "dbtable.h"
+
+void I2S_freeze(I2S *db) {
+    dbinfo *info = dbinfo_get(db);
+    dbkeys *k;
+
+    if (info == NULL) {
+        return;
     }
-}
-
-void I2S_setValue(I2S *db, I2S_KEY key, char *value) {
-    int idx = 0;
-
-    idx = I2S_findKey(db, key);
 
-    if (idx != -1) {
-        strncpy(db[idx].value, value, I2S_STRLEN);
+    // Removed elements keep their keys, they are taken out of the index
+    k = dbkeys_new(&db[0].key, sizeof(I2S), info->len);
+    for (int i = 0; (i < info->len) && (info->dead > 0); i++) {
+        if (dbinfo_removed(info, i)) dbkeys_remove(k, db[i].key, i);
     }
+    dbinfo_freeze(info, k);
 }
 
-void I2S_setKeyValue(I2S *db, int idx, I2S_KEY key, char *value) {
-
-    if (isWithin(idx, 0, I2S_len(db) - 1)) {
-        db[idx].key = key;
-        strncpy(db[idx].value, value, I2S_STRLEN);
-    }
-}
-
-
-int I2S_len(I2S *db) {
-    int i = 0;
+void I2S_thaw(I2S *db) {
+    dbinfo *info = dbinfo_get(db);
 
-    while (db[i].key != I2S_LAST) {
-        i++;
+    if (info == NULL) {
+        return;
     }
 
-    return i;
+    dbinfo_thaw(info);
 }
-
-int I2S_last(I2S *db) {
-    return I2S_len(db) - 1;
-}
-
-int I2S_first(I2S *db) {
-    UNUSED(db);
-    return 0;
-}
-
-void I2S_printDb(I2S *db) {
-    int i;
-
-    for (i = 0; i < I2S_len(db); i++) {
-        printf("%8d   %s\n", db[i].key, db[i].value);
-    }
-}
-
-
@@ -19,6 +19,9 @@ extern "C" {
 
 // Includes ---------------------------------------------------------------
 
+#include <stdbool.h>
+#include <stddef.h>
+
 // Macros -----------------------------------------------------------------
 
 #define I2S_STRLEN 32
@@ -58,12 +61,46 @@ I2S *I2S_new(int size);
 I2S *I2S_copy(I2S *db);
 
 /**
- * Deallocate database.
+ * Deallocate database. Tables from I2S_new(), I2S_copy() and I2S_build()
+ * are released with this rather than free(), which would leave their
+ * indexes behind.
  *
  * @param db database to deallocate
  */
 void I2S_free(I2S *db);
 
+/**
+ * Register a table not allocated by the library, e.g. a static table or
+ * one on the stack, so that it can be indexed and I2S_removeKey() can
+ * leave removed elements in place. Tables are known by address,
+ * unregister the table with I2S_unregister() before its storage is
+ * reused or goes out of scope. Registering a table twice does nothing.
+ *
+ * @param db database to register
+ */
+void I2S_register(I2S *db);
+
+/**
+ * Unregister a table registered by I2S_register(). Its indexes are
+ * dropped and elements removed by I2S_removeKey() are compacted away.
+ * Tables from I2S_new() are left to I2S_free().
+ *
+ * @param db database to unregister
+ */
+void I2S_unregister(I2S *db);
+
+/**
+ * Create database from arrays of keys and values, and freeze it (see
+ * I2S_freeze()). One pass over the arrays and one sort of the keys,
+ * instead of a I2S_setKeyValue() per element.
+ *
+ * @param keys key of each element
+ * @param values value of each element
+ * @param len nr of elements
+ * @return pointer to db
+ */
+I2S *I2S_build(I2S_KEY *keys, char **values, int len);
+
 /**
  * Find index of key in database.
  *
@@ -73,6 +110,20 @@ void I2S_free(I2S *db);
  */
 int I2S_findKey(I2S *db, I2S_KEY key);
 
+/**
+ * Find index of each of an array of keys. Searches of a frozen database
+ * are interleaved and prefetch the index. A database that is not frozen
+ * is scanned for each key and not changed, freeze it with I2S_freeze()
+ * first to look up large batches.
+ *
+ * @param db database to search
+ * @param keys keys to be found in database
+ * @param n nr of keys
+ * @param idx index of each key in db, -1 if not found
+ * @return nr of keys found
+ */
+int I2S_findKeys(I2S *db, I2S_KEY *keys, int n, int *idx);
+
 /**
  * Find index of value in database.
  *
@@ -90,6 +141,17 @@ int I2S_findValue(I2S *db, char *value);
  */
 char *I2S_getValue(I2S *db, I2S_KEY key);
 
+/**
+ * Get the values of an array of keys, see I2S_findKeys().
+ *
+ * @param db database to search
+ * @param keys keys to find
+ * @param n nr of keys
+ * @param values value of each key, NULL if not found
+ * @return nr of keys found
+ */
+int I2S_getValues(I2S *db, I2S_KEY *keys, int n, char **values);
+
 /**
  * Set value to corresponding key in database
  * @param db database to set value in
@@ -108,6 +170,100 @@ void I2S_setValue(I2S *db, I2S_KEY key, char *value);
 void I2S_setKeyValue(I2S *db, int idx, I2S_KEY key, char *value);
 
 
+/**
+ * Append element, growing the table. Tables not created by I2S_new()
+ * or I2S_copy() (e.g. static tables) are first copied, so always
+ * continue with the returned table.
+ *
+ * @param db database to append to
+ * @param key new key
+ * @param value new value
+ * @return database, possibly moved
+ */
+I2S *I2S_append(I2S *db, I2S_KEY key, char *value);
+
+/**
+ * Remove element, later elements move down one index.
+ *
+ * @param db database to remove from
+ * @param idx index of element to remove
+ */
+void I2S_remove(I2S *db, int idx);
+
+/**
+ * Remove the first element with key. The element is left in place and
+ * marked removed, see I2S_isRemoved(), no lookup finds it and positions
+ * and indexes stay valid. When more than a quarter of the elements are
+ * removed the database is compacted, see I2S_compact(). In a table that is
+ * not registered, see I2S_register(), later elements move down as by
+ * I2S_remove() instead.
+ *
+ * @param db database to remove from
+ * @param key key of element to remove
+ * @return 0 if removed, -1 if key not found
+ */
+int I2S_removeKey(I2S *db, I2S_KEY key);
+
+/**
+ * Check if an element was removed by I2S_removeKey(). It keeps its key
+ * and value until the database is compacted, code reading the array
+ * directly should skip it.
+ *
+ * @param db database
+ * @param idx index of element
+ * @return true if removed
+ */
+bool I2S_isRemoved(I2S *db, int idx);
+
+/**
+ * Drop elements removed by I2S_removeKey(), later elements move down,
+ * and rebuild the indexes of the database.
+ *
+ * @param db database to compact
+ * @return nr of elements dropped
+ */
+int I2S_compact(I2S *db);
+
+/**
+ * Freeze database for fast key lookup. The keys are copied to an array of
+ * their own, after which I2S_findKey(), I2S_getValue() and I2S_setValue()
+ * scan it 4 or 8 keys at a time, or use binary search for tables of more
+ * than DBKEYS_PACKED elements. Static tables are indexed once registered,
+ * see I2S_register(), the table itself is not reordered. Changing keys
+ * through I2S_setKeyValue(), I2S_append() or I2S_remove() drops the index,
+ * I2S_removeKey() keeps it.
+ *
+ * @param db database to freeze
+ */
+void I2S_freeze(I2S *db);
+
+/**
+ * Drop the index built by I2S_freeze().
+ *
+ * @param db database to thaw
+ */
+void I2S_thaw(I2S *db);
+
+/**
+ * Index values for fast I2S_findValue(). A hash index of the values is
+ * built and kept up to date by I2S_setValue(), I2S_setKeyValue(),
+ * I2S_append() and I2S_remove(), values written to the table directly are
+ * not seen. Static tables must be registered first, see I2S_register(),
+ * else nothing is done. I2S_append() on those returns a copy without
+ * index. Costs 16 to 32 bytes per element.
+ *
+ * @param db database to index
+ * @return bytes used by the index
+ */
+size_t I2S_indexValues(I2S *db);
+
+/**
+ * Drop the index built by I2S_indexValues().
+ *
+ * @param db database
+ */
+void I2S_dropValues(I2S *db);
+
 /**
  * First element in database.
  *
@@ -125,7 +281,8 @@ int I2S_first(I2S *db);
 int I2S_last(I2S *db);
 
 /**
- * Length of database.
+ * Length of database. Tables created by I2S_new() or I2S_copy() keep
+ * their length, others are scanned for the sentinel.
  *
  * @param db database to be questioned
  * @return nr of elements in db
@@ -0,0 +1,254 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Compact integer 2 string associative array.
+ *
+ * @file     i2sc.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "i2sc.h"
+
+// Prototypes -------------------------------------------------------------
+
+static bool I2SC_inHeap(I2SC *db, const char *str);
+static uint32_t I2SC_store(I2SC *db, const char *str, size_t len);
+static uint32_t I2SC_replace(I2SC *db, uint32_t old, const char *str);
+static void I2SC_drop(I2SC *db, uint32_t off);
+static void I2SC_compact(I2SC *db);
+static void I2SC_reserve(I2SC *db, int capacity);
+
+// Code -------------------------------------------------------------------
+
+static bool I2SC_inHeap(I2SC *db, const char *str) {
+    return ((uintptr_t)str - (uintptr_t)db->heap) < db->size;
+}
+
+// Copy len characters of str to the heap. str may point into the heap
+// itself, it is located again if the heap moves.
+static uint32_t I2SC_store(I2SC *db, const char *str, size_t len) {
+    uint32_t off;
+
+    if (len == 0) return 0;
+
+    if (db->used + len + 1 > db->size) {
+        bool own = I2SC_inHeap(db, str);
+        size_t inside = (size_t)((uintptr_t)str - (uintptr_t)db->heap);
+
+        while (db->used + len + 1 > db->size) db->size *= 2;
+        db->heap = (char *)realloc(db->heap, db->size);
+        if (own) str = db->heap + inside;
+    }
+
+    off = db->used;
+    memcpy(db->heap + off, str, len);
+    db->heap[off + len] = '\0';
+    db->used += (uint32_t)len + 1;
+    return off;
+}
+
+// Offset of str in place of the string at old. A string that fits is
+// written over the old one.
+static uint32_t I2SC_replace(I2SC *db, uint32_t old, const char *str) {
+    size_t len = strlen(str);
+    size_t oldlen = strlen(db->heap + old);
+    uint32_t off;
+
+    if ((old != 0) && (len <= oldlen)) {
+        memmove(db->heap + old, str, len + 1);
+        db->garbage += (uint32_t)(oldlen - len);
+        return old;
+    }
+
+    off = I2SC_store(db, str, len);
+    I2SC_drop(db, old);
+    return off;
+}
+
+static void I2SC_drop(I2SC *db, uint32_t off) {
+    if (off != 0) db->garbage += (uint32_t)strlen(db->heap + off) + 1;
+}
+
+// Rebuild the heap from the elements once it is mostly garbage
+static void I2SC_compact(I2SC *db) {
+    char *old = db->heap;
+    I2SC_entry *e;
+
+    if ((db->garbage < I2SC_HEAP) || (db->garbage * 2 < db->used)) return;
+
+    db->size = I2SC_HEAP;
+    while (db->size < db->used - db->garbage) db->size *= 2;
+    db->heap = (char *)malloc(db->size);
+    db->heap[0] = '\0';
+    db->used = 1;
+    db->garbage = 0;
+
+    for (int i = 0; i < db->len; i++) {
+        e = &db->entries[i];
+        e->value = I2SC_store(db, old + e->value, strlen(old + e->value));
+    }
+    free(old);
+}
+
+static void I2SC_reserve(I2SC *db, int capacity) {
+    if (capacity <= db->capacity) return;
+
+    if (capacity < db->capacity * 2) capacity = db->capacity * 2;
+    if (capacity < 8) capacity = 8;
+    db->entries = (I2SC_entry *)realloc(db->entries, capacity * sizeof(I2SC_entry));
+    db->capacity = capacity;
+}
+
+I2SC *I2SC_new(int size) {
+    I2SC *db = (I2SC *)calloc(1, sizeof(I2SC));
+
+    I2SC_reserve(db, Max(size, 1));
+    memset(db->entries, 0, size * sizeof(I2SC_entry));
+    db->len = size;
+
+    db->size = I2SC_HEAP;
+    db->heap = (char *)malloc(db->size);
+    db->heap[0] = '\0';
+    db->used = 1;
+
+    return db;
+}
+
+I2SC *I2SC_fromI2S(I2S *db) {
+    int len = I2S_len(db);
+    I2SC *dst = I2SC_new(len);
+    int n = 0;
+
+    // Removed elements are left out
+    for (int i = 0; i < len; i++) {
+        if (I2S_isRemoved(db, i)) continue;
+
+        dst->entries[n].key = db[i].key;
+        dst->entries[n].value = I2SC_store(dst, db[i].value, strnlen(db[i].value, I2S_STRLEN));
+        n++;
+    }
+    dst->len = n;
+    return dst;
+}
+
+I2SC *I2SC_copy(I2SC *db) {
+    I2SC *dst = I2SC_new(db->len);
+
+    for (int i = 0; i < db->len; i++) {
+        I2SC_setKeyValue(dst, i, I2SC_key(db, i), I2SC_value(db, i));
+    }
+    return dst;
+}
+
+void I2SC_free(I2SC *db) {
+    if (db == NULL) return;
+
+    free(db->entries);
+    free(db->heap);
+    free(db);
+}
+
+int I2SC_findKey(I2SC *db, I2S_KEY key) {
+    for (int i = 0; i < db->len; i++) {
+        if (db->entries[i].key == key) return i;
+    }
+    return -1;
+}
+
+int I2SC_findValue(I2SC *db, const char *value) {
+    for (int i = 0; i < db->len; i++) {
+        if (!strcmp(db->heap + db->entries[i].value, value)) return i;
+    }
+    return -1;
+}
+
+const char *I2SC_getValue(I2SC *db, I2S_KEY key) {
+    int idx = I2SC_findKey(db, key);
+
+    if (idx != -1) {
+        return db->heap + db->entries[idx].value;
+    } else {
+        return NULL;
+    }
+}
+
+void I2SC_setValue(I2SC *db, I2S_KEY key, const char *value) {
+    int idx = I2SC_findKey(db, key);
+
+    if (idx != -1) {
+        db->entries[idx].value = I2SC_replace(db, db->entries[idx].value, value);
+        I2SC_compact(db);
+    }
+}
+
+void I2SC_setKeyValue(I2SC *db, int idx, I2S_KEY key, const char *value) {
+    if ((idx < 0) || (idx >= db->len)) return;
+
+    db->entries[idx].key = key;
+    db->entries[idx].value = I2SC_replace(db, db->entries[idx].value, value);
+    I2SC_compact(db);
+}
+
+int I2SC_append(I2SC *db, I2S_KEY key, const char *value) {
+    I2SC_reserve(db, db->len + 1);
+    db->entries[db->len].key = key;
+    db->entries[db->len].value = 0;
+    db->len++;
+
+    I2SC_setKeyValue(db, db->len - 1, key, value);
+    return db->len - 1;
+}
+
+void I2SC_remove(I2SC *db, int idx) {
+    if ((idx < 0) || (idx >= db->len)) return;
+
+    I2SC_drop(db, db->entries[idx].value);
+    memmove(&db->entries[idx], &db->entries[idx + 1], (db->len - idx - 1) * sizeof(I2SC_entry));
+    db->len--;
+    I2SC_compact(db);
+}
+
+I2S_KEY I2SC_key(I2SC *db, int idx) {
+    return db->entries[idx].key;
+}
+
+const char *I2SC_value(I2SC *db, int idx) {
+    if ((idx < 0) || (idx >= db->len)) return NULL;
+    return db->heap + db->entries[idx].value;
+}
+
+int I2SC_first(I2SC *db) {
+    UNUSED(db);
+    return 0;
+}
+
+int I2SC_last(I2SC *db) {
+    return db->len - 1;
+}
+
+int I2SC_len(I2SC *db) {
+    return db->len;
+}
+
+size_t I2SC_size(I2SC *db) {
+    return sizeof(I2SC) + (size_t)db->capacity * sizeof(I2SC_entry) + db->size;
+}
+
+void I2SC_printDb(I2SC *db) {
+    for (int i = 0; i < db->len; i++) {
+        printf("%8d   %s\n", db->entries[i].key, I2SC_value(db, i));
+    }
+}
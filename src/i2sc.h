@@ -0,0 +1,210 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Compact integer 2 string associative array.
+ *
+ * @file     i2sc.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Same operations as I2S, but values are kept in a shared string heap
+ * and an element holds the key and the offset of its value, 8 bytes
+ * instead of the 36 of an I2S element. Values are not cut at
+ * I2S_STRLEN. The heap works as the one of S2SC, see s2sc.h.
+ */
+
+#ifndef I2SC_H
+#define I2SC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "i2s.h"
+
+// Macros -----------------------------------------------------------------
+
+#define I2SC_HEAP 256  // Smallest heap size in bytes
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    I2S_KEY key;
+    uint32_t value;  // Offset of value in heap
+} I2SC_entry;
+
+typedef struct {
+    I2SC_entry *entries;
+    int len;            // nr of elements
+    int capacity;       // nr of elements entries has room for
+    char *heap;         // Null terminated values, "" at offset 0
+    uint32_t used;      // Bytes of heap in use, garbage included
+    uint32_t size;      // Bytes allocated for heap
+    uint32_t garbage;   // Bytes of strings no longer referenced
+} I2SC;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create new database.
+ *
+ * @param size nr of elements of new db, all with key 0 and empty value
+ * @return pointer to db
+ */
+I2SC *I2SC_new(int size);
+
+/**
+ * Create compact copy of a I2S database.
+ *
+ * @param db database to copy
+ * @return pointer to new db
+ */
+I2SC *I2SC_fromI2S(I2S *db);
+
+/**
+ * Copy database, the copy has no garbage.
+ *
+ * @param db database to copy
+ * @return pointer to new db
+ */
+I2SC *I2SC_copy(I2SC *db);
+
+/**
+ * Deallocate database.
+ *
+ * @param db database to deallocate
+ */
+void I2SC_free(I2SC *db);
+
+/**
+ * Find index of key in database.
+ *
+ * @param db database to search
+ * @param key the key to be found in database
+ * @return -1 if key not found, >=0 index in db
+ */
+int I2SC_findKey(I2SC *db, I2S_KEY key);
+
+/**
+ * Find index of value in database.
+ *
+ * @param db database to search
+ * @param value value to be found in database
+ * @return -1 if value not found, >=0 index in db
+ */
+int I2SC_findValue(I2SC *db, const char *value);
+
+/**
+ * Get the value to corresponding key.
+ *
+ * @param db database to search
+ * @param key key to find
+ * @return value, NULL if key not found
+ */
+const char *I2SC_getValue(I2SC *db, I2S_KEY key);
+
+/**
+ * Set value to corresponding key in database.
+ *
+ * @param db database to set value in
+ * @param key the key whos value to be set
+ * @param value new value
+ */
+void I2SC_setValue(I2SC *db, I2S_KEY key, const char *value);
+
+/**
+ * Set key and value of element.
+ *
+ * @param db database to set key/value in
+ * @param idx index in db to be set
+ * @param key new key
+ * @param value new value
+ */
+void I2SC_setKeyValue(I2SC *db, int idx, I2S_KEY key, const char *value);
+
+/**
+ * Append element.
+ *
+ * @param db database to append to
+ * @param key new key
+ * @param value new value
+ * @return index of new element
+ */
+int I2SC_append(I2SC *db, I2S_KEY key, const char *value);
+
+/**
+ * Remove element, later elements move down one index.
+ *
+ * @param db database to remove from
+ * @param idx index of element to remove
+ */
+void I2SC_remove(I2SC *db, int idx);
+
+/**
+ * Key of element.
+ *
+ * @param db database
+ * @param idx index of element, must be in range
+ * @return key
+ */
+I2S_KEY I2SC_key(I2SC *db, int idx);
+
+/**
+ * Value of element.
+ *
+ * @param db database
+ * @param idx index of element
+ * @return value, NULL if idx is out of range
+ */
+const char *I2SC_value(I2SC *db, int idx);
+
+/**
+ * First element in database.
+ *
+ * @param db database to be questioned
+ * @return index of first element in db
+ */
+int I2SC_first(I2SC *db);
+
+/**
+ * Last element in database.
+ *
+ * @param db database to be questioned
+ * @return index to last element in db, -1 if empty
+ */
+int I2SC_last(I2SC *db);
+
+/**
+ * Length of database.
+ *
+ * @param db database to be questioned
+ * @return nr of elements in db
+ */
+int I2SC_len(I2SC *db);
+
+/**
+ * Memory held by database.
+ *
+ * @param db database to be questioned
+ * @return bytes allocated for elements and heap
+ */
+size_t I2SC_size(I2SC *db);
+
+/**
+ * Print database
+ * @param db database to be printed
+ */
+void I2SC_printDb(I2SC *db);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
@@ -0,0 +1,126 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Arena (bump) allocator.
+ *
+ * @file     marena.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "marena.h"
+
+// Macros -----------------------------------------------------------------
+
+#define MARENA_ROUND(x) (((x) + (MARENA_ALIGN - 1)) & ~(size_t)(MARENA_ALIGN - 1))
+
+// Prototypes -------------------------------------------------------------
+
+static char *marena_end(marena *a);
+static marena_block *marena_add_block(marena *a, size_t size);
+
+// Code -------------------------------------------------------------------
+
+static char *marena_end(marena *a) {
+    return a->current->data + a->current->size;
+}
+
+static marena_block *marena_add_block(marena *a, size_t size) {
+    marena_block *b;
+
+    if (size < a->block_size) size = a->block_size;
+
+    b = (marena_block *)malloc(sizeof(marena_block) + size);
+    b->size = size;
+
+    // Link in after the current block so that reset reuses it next round
+    b->next = a->current->next;
+    a->current->next = b;
+    return b;
+}
+
+marena *marena_new(size_t block_size) {
+    marena *a = (marena *)malloc(sizeof(marena));
+
+    a->block_size = MARENA_ROUND((block_size == 0) ? MARENA_BLOCK : block_size);
+    a->first = (marena_block *)malloc(sizeof(marena_block) + a->block_size);
+    a->first->next = NULL;
+    a->first->size = a->block_size;
+    marena_reset(a);
+    return a;
+}
+
+void marena_free(marena *a) {
+    marena_block *b = a->first;
+
+    while (b != NULL) {
+        marena_block *next = b->next;
+        free(b);
+        b = next;
+    }
+    free(a);
+}
+
+void marena_reset(marena *a) {
+    a->current = a->first;
+    a->pos = a->current->data;
+    a->last = NULL;
+    a->used = 0;
+}
+
+void *marena_alloc(marena *a, size_t size) {
+    size_t rsize = MARENA_ROUND(size);
+    char *ptr;
+
+    if (rsize == 0) rsize = MARENA_ALIGN;
+
+    if (rsize > (size_t)(marena_end(a) - a->pos)) {
+        // Move on to the next kept block if it is large enough
+        if ((a->current->next == NULL) || (a->current->next->size < rsize)) {
+            marena_add_block(a, rsize);
+        }
+        a->current = a->current->next;
+        a->pos = a->current->data;
+    }
+
+    ptr = a->pos;
+    a->pos += rsize;
+    a->last = ptr;
+    a->used += rsize;
+    return ptr;
+}
+
+bool marena_extend(marena *a, void *ptr, size_t size) {
+    char *p = (char *)ptr;
+    size_t rsize = MARENA_ROUND(size);
+
+    if ((p == NULL) || (p != a->last)) return false;
+    if (rsize > (size_t)(marena_end(a) - p)) return false;
+
+    a->used += rsize - (a->pos - p);
+    a->pos = p + rsize;
+    return true;
+}
+
+void *marena_realloc(marena *a, void *ptr, size_t old_size, size_t size) {
+    void *new_ptr;
+
+    if (size <= old_size) return ptr;
+    if (marena_extend(a, ptr, size)) return ptr;
+
+    new_ptr = marena_alloc(a, size);
+    if (ptr != NULL) memcpy(new_ptr, ptr, old_size);
+    return new_ptr;
+}
+
+size_t marena_used(marena *a) {
+    return a->used;
+}
@@ -0,0 +1,124 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Arena (bump) allocator.
+ *
+ * @file     marena.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * An arena hands out memory by bumping a pointer through large blocks
+ * taken from malloc. Single allocations are never freed, instead the whole
+ * arena is reset in one go and its blocks are reused for the next round,
+ * e.g. once per handled request.
+ *
+ * mstr objects can be created in an arena with mstr_new_a(). They grow
+ * inside the arena and mstr_free() on them does nothing, all their memory
+ * is returned by marena_reset() or marena_free().
+ */
+
+#ifndef MARENA_H
+#define MARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Macros -----------------------------------------------------------------
+
+#define MARENA_BLOCK (64 * 1024)  // Default block size
+#define MARENA_ALIGN 16           // Alignment of all allocations
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct marena_block_t {
+    struct marena_block_t *next;
+    size_t size;
+    char data[];
+} marena_block;
+
+typedef struct marena_t {
+    marena_block *first;    // Blocks in the order they are filled
+    marena_block *current;  // Block allocations are taken from
+    char *pos;              // Next free byte in current
+    char *last;             // Start of latest allocation, can be extended
+    size_t block_size;
+    size_t used;            // Bytes handed out since last reset
+} marena;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create a new arena.
+ *
+ * @param block_size size of blocks taken from malloc, 0 for MARENA_BLOCK
+ * @return new arena
+ */
+marena *marena_new(size_t block_size);
+
+/**
+ * Free arena and all memory allocated from it.
+ *
+ * @param a arena
+ */
+void marena_free(marena *a);
+
+/**
+ * Release all allocations at once, the blocks are kept for reuse.
+ *
+ * @param a arena
+ */
+void marena_reset(marena *a);
+
+/**
+ * Allocate memory from arena, aligned to MARENA_ALIGN.
+ *
+ * @param a arena
+ * @param size nr of bytes
+ * @return pointer to memory
+ */
+void *marena_alloc(marena *a, size_t size);
+
+/**
+ * Try to grow an allocation in place, possible when it is the latest one
+ * and its block has room.
+ *
+ * @param a arena
+ * @param ptr allocation to grow
+ * @param size new size of allocation
+ * @return true if ptr now holds size bytes
+ */
+bool marena_extend(marena *a, void *ptr, size_t size);
+
+/**
+ * Resize an allocation, in place if possible otherwise by copying it to a
+ * new allocation. The old memory is not reused until next reset.
+ *
+ * @param a arena
+ * @param ptr allocation to resize, or NULL
+ * @param old_size current size of allocation
+ * @param size new size of allocation
+ * @return pointer to memory
+ */
+void *marena_realloc(marena *a, void *ptr, size_t old_size, size_t size);
+
+/**
+ * Nr of bytes handed out since last reset, including alignment padding.
+ *
+ * @param a arena
+ * @return bytes used
+ */
+size_t marena_used(marena *a);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
@@ -0,0 +1,125 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Gap buffer string, for repeated inserts at nearby positions.
+ *
+ * @file     mgap.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mgap.h"
+
+// Prototypes -------------------------------------------------------------
+
+static void mgap_move_gap(mgap *g, size_t pos);
+static void mgap_reserve(mgap *g, size_t len);
+
+// Code -------------------------------------------------------------------
+
+static void mgap_move_gap(mgap *g, size_t pos) {
+    size_t n;
+
+    if (pos < g->gap_start) {
+        n = g->gap_start - pos;
+        memmove(g->buf + g->gap_end - n, g->buf + pos, n);
+        g->gap_start -= n;
+        g->gap_end -= n;
+    } else if (pos > g->gap_start) {
+        n = pos - g->gap_start;
+        memmove(g->buf + g->gap_start, g->buf + g->gap_end, n);
+        g->gap_start += n;
+        g->gap_end += n;
+    }
+}
+
+static void mgap_reserve(mgap *g, size_t len) {
+    size_t tail;
+    size_t capacity;
+
+    if ((g->gap_end - g->gap_start) >= len) return;
+
+    capacity = g->capacity * 2;
+    if (capacity < (g->capacity + len + MGAP_MIN_GAP))
+        capacity = g->capacity + len + MGAP_MIN_GAP;
+
+    tail = g->capacity - g->gap_end;
+    g->buf = realloc(g->buf, capacity);
+    memmove(g->buf + capacity - tail, g->buf + g->gap_end, tail);
+    g->gap_end = capacity - tail;
+    g->capacity = capacity;
+}
+
+mgap *mgap_new(char *src, size_t capacity) {
+    mgap *g;
+    size_t len = (src != NULL) ? strlen(src) : 0;
+
+    if (capacity < (len + MGAP_MIN_GAP))
+        capacity = len + MGAP_MIN_GAP;
+
+    g = malloc(sizeof(mgap));
+    g->buf = malloc(capacity);
+    g->capacity = capacity;
+    g->gap_start = 0;
+    g->gap_end = capacity;
+
+    if (src != NULL) mgap_insert(g, src, len, 0);
+
+    return g;
+}
+
+mgap *mgap_news(mstr *src) {
+    mgap *g = mgap_new(NULL, src->len + MGAP_MIN_GAP);
+
+    mgap_insert(g, src->str, src->len, 0);
+    return g;
+}
+
+void mgap_free(mgap *g) {
+    free(g->buf);
+    free(g);
+}
+
+size_t mgap_len(mgap *g) {
+    return g->capacity - (g->gap_end - g->gap_start);
+}
+
+char mgap_at(mgap *g, size_t pos) {
+    if (pos < g->gap_start) return g->buf[pos];
+    return g->buf[pos + (g->gap_end - g->gap_start)];
+}
+
+void mgap_insert(mgap *g, char *src, size_t len, size_t pos) {
+    if (pos > mgap_len(g)) pos = mgap_len(g);
+
+    mgap_reserve(g, len);
+    mgap_move_gap(g, pos);
+    memcpy(g->buf + g->gap_start, src, len);
+    g->gap_start += len;
+}
+
+void mgap_delete(mgap *g, size_t pos, size_t len) {
+    size_t text_len = mgap_len(g);
+
+    if (pos >= text_len) return;
+    if (len > (text_len - pos)) len = text_len - pos;
+
+    mgap_move_gap(g, pos);
+    g->gap_end += len;
+}
+
+mstr *mgap_to_mstr(mgap *g) {
+    mstr *s = mstr_newl(mgap_len(g));
+
+    mstr_append_g(s, g->buf, g->gap_start);
+    mstr_append_g(s, g->buf + g->gap_end, g->capacity - g->gap_end);
+    return s;
+}
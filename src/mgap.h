@@ -0,0 +1,119 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Gap buffer string, for repeated inserts at nearby positions.
+ *
+ * @file     mgap.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * The text is kept in one buffer with a hole (the gap) at the position of
+ * the last edit. Inserting or deleting at the gap only touches the gap, so
+ * a series of edits at or near the same place costs O(edit) instead of
+ * moving the whole tail like mstr_insert() does. Moving the gap to a new
+ * position costs the distance moved.
+ */
+
+#ifndef MGAP_H
+#define MGAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stddef.h>
+
+#include "mstr.h"
+
+// Macros -----------------------------------------------------------------
+
+#define MGAP_MIN_GAP 64
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    char *buf;
+    size_t capacity;
+    size_t gap_start;  // first byte of the gap
+    size_t gap_end;    // first byte after the gap
+} mgap;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create new gap buffer.
+ *
+ * @param src initial text, may be NULL
+ * @param capacity initial capacity in bytes
+ * @return pointer to gap buffer
+ */
+mgap *mgap_new(char *src, size_t capacity);
+
+/**
+ * Create new gap buffer from a mstr.
+ *
+ * @param src string to copy
+ * @return pointer to gap buffer
+ */
+mgap *mgap_news(mstr *src);
+
+/**
+ * Deallocate gap buffer.
+ *
+ * @param g gap buffer to deallocate
+ */
+void mgap_free(mgap *g);
+
+/**
+ * Length of text in gap buffer.
+ *
+ * @param g gap buffer to be questioned
+ * @return nr of bytes of text
+ */
+size_t mgap_len(mgap *g);
+
+/**
+ * Character at position.
+ *
+ * @param g gap buffer to be questioned
+ * @param pos position in text
+ * @return character at pos
+ */
+char mgap_at(mgap *g, size_t pos);
+
+/**
+ * Insert text.
+ *
+ * @param g gap buffer to insert into
+ * @param src text to insert
+ * @param len length of text
+ * @param pos position in text, clamped to the text length
+ */
+void mgap_insert(mgap *g, char *src, size_t len, size_t pos);
+
+/**
+ * Delete text.
+ *
+ * @param g gap buffer to delete from
+ * @param pos position of first byte to delete
+ * @param len nr of bytes to delete, clamped to the end of text
+ */
+void mgap_delete(mgap *g, size_t pos, size_t len);
+
+/**
+ * Copy text to a new mstr.
+ *
+ * @param g gap buffer to copy
+ * @return new mstr
+ */
+mstr *mgap_to_mstr(mgap *g);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
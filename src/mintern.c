@@ -0,0 +1,165 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    String interning pool.
+ *
+ * @file     mintern.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mintern.h"
+
+// Typedefs ---------------------------------------------------------------
+
+// Interned copy, the pool hands out pointers to str
+typedef struct {
+    size_t len;
+    char str[];
+} mintern_entry;
+
+// Prototypes -------------------------------------------------------------
+
+static uint64_t mintern_hash(const char *str, size_t len);
+static mintern_slot *mintern_probe(mintern_pool *p, uint64_t hash, const char *str, size_t len);
+static void mintern_grow(mintern_pool *p);
+
+// Code -------------------------------------------------------------------
+
+// FNV-1a
+static uint64_t mintern_hash(const char *str, size_t len) {
+    uint64_t h = 14695981039346656037ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)str[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// Slot holding the string, or the empty slot where it would go
+static mintern_slot *mintern_probe(mintern_pool *p, uint64_t hash, const char *str, size_t len) {
+    size_t i = hash & p->mask;
+    mintern_slot *slot;
+
+    for (;;) {
+        slot = &p->slots[i];
+        if (slot->str == NULL) return slot;
+        if ((slot->hash == hash) && (mintern_len(slot->str) == len) && !memcmp(slot->str, str, len)) {
+            return slot;
+        }
+        i = (i + 1) & p->mask;
+    }
+}
+
+static void mintern_grow(mintern_pool *p) {
+    mintern_slot *old = p->slots;
+    size_t n = p->mask + 1;
+
+    p->mask = (n * 2) - 1;
+    p->slots = (mintern_slot *)calloc(n * 2, sizeof(mintern_slot));
+
+    for (size_t i = 0; i < n; i++) {
+        if (old[i].str == NULL) continue;
+        *mintern_probe(p, old[i].hash, old[i].str, mintern_len(old[i].str)) = old[i];
+    }
+    free(old);
+}
+
+mintern_pool *mintern_new(void) {
+    mintern_pool *p = (mintern_pool *)calloc(1, sizeof(mintern_pool));
+
+    pthread_rwlock_init(&p->lock, NULL);
+    p->arena = marena_new(0);
+    p->slots = (mintern_slot *)calloc(MINTERN_SLOTS, sizeof(mintern_slot));
+    p->mask = MINTERN_SLOTS - 1;
+    return p;
+}
+
+void mintern_free(mintern_pool *p) {
+    pthread_rwlock_destroy(&p->lock);
+    marena_free(p->arena);
+    free(p->slots);
+    free(p);
+}
+
+const char *mintern_find(mintern_pool *p, const char *str, size_t len) {
+    uint64_t hash = mintern_hash(str, len);
+    const char *res;
+
+    pthread_rwlock_rdlock(&p->lock);
+    res = mintern_probe(p, hash, str, len)->str;
+    pthread_rwlock_unlock(&p->lock);
+    return res;
+}
+
+const char *mintern_g(mintern_pool *p, const char *str, size_t len) {
+    uint64_t hash = mintern_hash(str, len);
+    mintern_slot *slot;
+    mintern_entry *e;
+    const char *res;
+
+    __atomic_fetch_add(&p->stats.lookups, 1, __ATOMIC_RELAXED);
+
+    // Most lookups find the string, they only need the shared lock
+    pthread_rwlock_rdlock(&p->lock);
+    res = mintern_probe(p, hash, str, len)->str;
+    pthread_rwlock_unlock(&p->lock);
+
+    if (res == NULL) {
+        // Another thread may have added it between the locks, probe again
+        pthread_rwlock_wrlock(&p->lock);
+        slot = mintern_probe(p, hash, str, len);
+        if (slot->str == NULL) {
+            e = (mintern_entry *)marena_alloc(p->arena, sizeof(mintern_entry) + len + 1);
+            e->len = len;
+            memcpy(e->str, str, len);
+            e->str[len] = '\0';
+            slot->hash = hash;
+            slot->str = e->str;
+            p->stats.strings++;
+            p->stats.bytes += len;
+
+            // Keep load factor below 1/2
+            if ((p->stats.strings * 2) > p->mask) mintern_grow(p);
+            pthread_rwlock_unlock(&p->lock);
+            return e->str;
+        }
+        res = slot->str;
+        pthread_rwlock_unlock(&p->lock);
+    }
+
+    __atomic_fetch_add(&p->stats.hits, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&p->stats.bytes_saved, len, __ATOMIC_RELAXED);
+    return res;
+}
+
+const char *mintern_c(mintern_pool *p, const char *str) {
+    return mintern_g(p, str, strlen(str));
+}
+
+const char *mintern_s(mintern_pool *p, mstr *s) {
+    return mintern_g(p, s->str, s->len);
+}
+
+size_t mintern_len(const char *str) {
+    return ((const mintern_entry *)(str - offsetof(mintern_entry, str)))->len;
+}
+
+void mintern_get_stats(mintern_pool *p, mintern_stats *stats) {
+    pthread_rwlock_rdlock(&p->lock);
+    stats->strings = p->stats.strings;
+    stats->bytes = p->stats.bytes;
+    pthread_rwlock_unlock(&p->lock);
+    stats->lookups = __atomic_load_n(&p->stats.lookups, __ATOMIC_RELAXED);
+    stats->hits = __atomic_load_n(&p->stats.hits, __ATOMIC_RELAXED);
+    stats->bytes_saved = __atomic_load_n(&p->stats.bytes_saved, __ATOMIC_RELAXED);
+}
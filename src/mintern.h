@@ -0,0 +1,144 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    String interning pool.
+ *
+ * @file     mintern.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * A pool keeps one copy of every distinct string handed to it and returns
+ * the same pointer for equal contents, so interned strings are compared
+ * with == and repeated strings take memory only once. The pointers stay
+ * valid until the pool is freed, the copies live in an arena (marena.h)
+ * and are null terminated.
+ *
+ * Lookups of strings already in the pool share a read lock and may run
+ * from any number of threads, adding a new string takes the lock
+ * exclusively. Link with -lpthread.
+ */
+
+#ifndef MINTERN_H
+#define MINTERN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mstr.h"
+#include "marena.h"
+
+// Macros -----------------------------------------------------------------
+
+#define MINTERN_SLOTS 1024  // Initial nr of hash slots, a power of 2
+
+#define mintern(POOL, SRC) _Generic((SRC), \
+    char *: mintern_c,                     \
+    mstr *: mintern_s)(POOL, SRC)
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    uint64_t hash;
+    const char *str;  // NULL for an empty slot
+} mintern_slot;
+
+typedef struct {
+    size_t lookups;     // Calls to intern a string
+    size_t hits;        // Lookups that found the string already interned
+    size_t strings;     // Distinct strings in pool
+    size_t bytes;       // Bytes of distinct strings, without terminators
+    size_t bytes_saved; // Bytes that would have been copied by the hits
+} mintern_stats;
+
+typedef struct {
+    pthread_rwlock_t lock;
+    marena *arena;
+    mintern_slot *slots;
+    size_t mask;        // nr of slots - 1
+    mintern_stats stats;
+} mintern_pool;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create new pool.
+ *
+ * @return pointer to pool
+ */
+mintern_pool *mintern_new(void);
+
+/**
+ * Free pool and all strings interned in it.
+ *
+ * @param p pool
+ */
+void mintern_free(mintern_pool *p);
+
+/**
+ * Intern a buffer.
+ *
+ * @param p pool
+ * @param str characters, need not be null terminated
+ * @param len nr of characters
+ * @return the pool's copy of the string
+ */
+const char *mintern_g(mintern_pool *p, const char *str, size_t len);
+
+/**
+ * Intern a null terminated string.
+ *
+ * @param p pool
+ * @param str string
+ * @return the pool's copy of the string
+ */
+const char *mintern_c(mintern_pool *p, const char *str);
+
+/**
+ * Intern the contents of a mstr.
+ *
+ * @param p pool
+ * @param s string
+ * @return the pool's copy of the string
+ */
+const char *mintern_s(mintern_pool *p, mstr *s);
+
+/**
+ * Look up a string without adding it.
+ *
+ * @param p pool
+ * @param str characters
+ * @param len nr of characters
+ * @return the pool's copy, NULL if not interned
+ */
+const char *mintern_find(mintern_pool *p, const char *str, size_t len);
+
+/**
+ * Length of an interned string.
+ *
+ * @param str string returned by the pool
+ * @return nr of characters
+ */
+size_t mintern_len(const char *str);
+
+/**
+ * Counters of pool usage.
+ *
+ * @param p pool
+ * @param stats filled in with a snapshot of the counters
+ */
+void mintern_get_stats(mintern_pool *p, mintern_stats *stats);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
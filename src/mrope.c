@@ -0,0 +1,301 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Rope string, for edits at random positions in large texts.
+ *
+ * @file     mrope.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mrope.h"
+
+// Prototypes -------------------------------------------------------------
+
+static size_t mrope_size(mrope_node *t);
+static void mrope_update(mrope_node *t);
+static mrope_node *mrope_node_new(char *src, size_t len, uint32_t prio);
+static uint32_t mrope_prio(mrope *r);
+static mrope_node *mrope_merge(mrope_node *a, mrope_node *b);
+static void mrope_split(mrope_node *t, size_t pos, mrope_node **left, mrope_node **right);
+static mrope_node *mrope_find(mrope_node *t, size_t *pos, bool end, size_t delta);
+static mrope_node *mrope_join(mrope_node *left, mrope_node *right);
+static mrope_node *mrope_build(mrope *r, char *src, size_t len, size_t fill);
+static void mrope_free_node(mrope_node *t);
+static void mrope_append_node(mrope_node *t, mstr *dst);
+static size_t mrope_collect(mrope_node *t, size_t pos, struct iovec *iov, size_t n, size_t max);
+
+// Code -------------------------------------------------------------------
+
+static size_t mrope_size(mrope_node *t) {
+    return (t != NULL) ? t->size : 0;
+}
+
+static void mrope_update(mrope_node *t) {
+    t->size = mrope_size(t->left) + t->len + mrope_size(t->right);
+}
+
+static uint32_t mrope_prio(mrope *r) {
+    // xorshift32
+    r->seed ^= r->seed << 13;
+    r->seed ^= r->seed >> 17;
+    r->seed ^= r->seed << 5;
+    return r->seed;
+}
+
+static mrope_node *mrope_node_new(char *src, size_t len, uint32_t prio) {
+    mrope_node *n = (mrope_node *)malloc(sizeof(mrope_node));
+
+    assert(len <= MROPE_CHUNK);
+    n->left = NULL;
+    n->right = NULL;
+    n->prio = prio;
+    n->len = (uint32_t)len;
+    n->size = len;
+    memcpy(n->data, src, len);
+    return n;
+}
+
+static mrope_node *mrope_merge(mrope_node *a, mrope_node *b) {
+    if (a == NULL) return b;
+    if (b == NULL) return a;
+
+    if (a->prio > b->prio) {
+        a->right = mrope_merge(a->right, b);
+        mrope_update(a);
+        return a;
+    }
+    b->left = mrope_merge(a, b->left);
+    mrope_update(b);
+    return b;
+}
+
+// Split t so that left holds the first pos bytes and right the rest, a
+// chunk containing pos is cut in two.
+static void mrope_split(mrope_node *t, size_t pos, mrope_node **left, mrope_node **right) {
+    size_t lsize;
+    mrope_node *n;
+
+    if (t == NULL) {
+        *left = NULL;
+        *right = NULL;
+        return;
+    }
+
+    lsize = mrope_size(t->left);
+    if (pos <= lsize) {
+        mrope_split(t->left, pos, left, &t->left);
+        mrope_update(t);
+        *right = t;
+    } else if (pos >= (lsize + t->len)) {
+        mrope_split(t->right, pos - lsize - t->len, &t->right, right);
+        mrope_update(t);
+        *left = t;
+    } else {
+        // The tail of the chunk takes over the right subtree and the
+        // priority, so heap order holds on both sides.
+        pos -= lsize;
+        n = mrope_node_new(t->data + pos, t->len - pos, t->prio);
+        n->right = t->right;
+        mrope_update(n);
+        t->len = (uint32_t)pos;
+        t->right = NULL;
+        mrope_update(t);
+        *left = t;
+        *right = n;
+    }
+}
+
+static mrope_node *mrope_build(mrope *r, char *src, size_t len, size_t fill) {
+    mrope_node *t = NULL;
+    size_t n;
+
+    while (len > 0) {
+        n = (len < fill) ? len : fill;
+        t = mrope_merge(t, mrope_node_new(src, n, mrope_prio(r)));
+        src += n;
+        len -= n;
+    }
+    return t;
+}
+
+static void mrope_free_node(mrope_node *t) {
+    if (t == NULL) return;
+
+    mrope_free_node(t->left);
+    mrope_free_node(t->right);
+    free(t);
+}
+
+mrope *mrope_new(char *src) {
+    mrope *r = (mrope *)malloc(sizeof(mrope));
+
+    r->root = NULL;
+    r->seed = 2463534242u;
+    if (src != NULL) r->root = mrope_build(r, src, strlen(src), MROPE_FILL);
+    return r;
+}
+
+mrope *mrope_news(mstr *src) {
+    mrope *r = mrope_new(NULL);
+
+    r->root = mrope_build(r, src->str, src->len, MROPE_FILL);
+    return r;
+}
+
+void mrope_free(mrope *r) {
+    mrope_free_node(r->root);
+    free(r);
+}
+
+size_t mrope_len(mrope *r) {
+    return mrope_size(r->root);
+}
+
+// Find the chunk holding pos and make pos relative to it, adding delta to
+// the size of every node on the way. With end set a position between two
+// chunks belongs to the end of the first one.
+static mrope_node *mrope_find(mrope_node *t, size_t *pos, bool end, size_t delta) {
+    size_t p = *pos;
+    size_t lsize;
+
+    while (t != NULL) {
+        lsize = mrope_size(t->left);
+        t->size += delta;
+        if ((p < lsize) || (end && (p == lsize) && (t->left != NULL))) {
+            t = t->left;
+        } else if ((p < (lsize + t->len)) || (end && (p == (lsize + t->len)))) {
+            *pos = p - lsize;
+            return t;
+        } else {
+            p -= lsize + t->len;
+            t = t->right;
+        }
+    }
+    return NULL;
+}
+
+// Merge two trees, joining the chunks on either side of the seam when they
+// fit in one so that edits do not leave a trail of small chunks.
+static mrope_node *mrope_join(mrope_node *left, mrope_node *right) {
+    mrope_node *last, *first, *t;
+
+    if ((left == NULL) || (right == NULL)) return mrope_merge(left, right);
+
+    for (last = left; last->right != NULL; last = last->right);
+    for (first = right; first->left != NULL; first = first->left);
+    if ((last->len + first->len) > MROPE_CHUNK) return mrope_merge(left, right);
+
+    mrope_split(right, first->len, &first, &right);
+    memcpy(last->data + last->len, first->data, first->len);
+    for (t = left; t != NULL; t = t->right) t->size += first->len;
+    last->len += first->len;
+    free(first);
+
+    return mrope_merge(left, right);
+}
+
+char mrope_at(mrope *r, size_t pos) {
+    mrope_node *t;
+
+    assert(pos < mrope_len(r));
+    t = mrope_find(r->root, &pos, false, 0);
+    return t->data[pos];
+}
+
+void mrope_insert(mrope *r, char *src, size_t len, size_t pos) {
+    mrope_node *left, *right, *t;
+    size_t p = pos;
+
+    assert(pos <= mrope_len(r));
+    if (len == 0) return;
+
+    // Small inserts into a chunk with room are done in place, only the
+    // sizes on the path down need updating.
+    t = mrope_find(r->root, &p, true, 0);
+    if ((t != NULL) && ((t->len + len) <= MROPE_CHUNK)) {
+        mrope_find(r->root, &pos, true, len);
+        memmove(t->data + p + len, t->data + p, t->len - p);
+        memcpy(t->data + p, src, len);
+        t->len += (uint32_t)len;
+        return;
+    }
+
+    mrope_split(r->root, pos, &left, &right);
+    r->root = mrope_join(mrope_join(left, mrope_build(r, src, len, MROPE_CHUNK)), right);
+}
+
+void mrope_delete(mrope *r, size_t pos, size_t len) {
+    mrope_node *left, *mid, *right, *t;
+    size_t size = mrope_len(r);
+    size_t p = pos;
+
+    if (pos >= size) return;
+    if (len > (size - pos)) len = size - pos;
+    if (len == 0) return;
+
+    // Deletes inside one chunk that leave something of it are done in place
+    t = mrope_find(r->root, &p, false, 0);
+    if ((p + len) <= t->len && (len < t->len)) {
+        mrope_find(r->root, &pos, false, 0 - len);
+        memmove(t->data + p, t->data + p + len, t->len - p - len);
+        t->len -= (uint32_t)len;
+        return;
+    }
+
+    mrope_split(r->root, pos, &left, &mid);
+    mrope_split(mid, len, &mid, &right);
+    mrope_free_node(mid);
+    r->root = mrope_join(left, right);
+}
+
+static void mrope_append_node(mrope_node *t, mstr *dst) {
+    if (t == NULL) return;
+
+    mrope_append_node(t->left, dst);
+    mstr_append_g(dst, t->data, t->len);
+    mrope_append_node(t->right, dst);
+}
+
+mstr *mrope_to_mstr(mrope *r) {
+    mstr *s = mstr_newl(mrope_len(r));
+
+    mrope_append_node(r->root, s);
+    return s;
+}
+
+static size_t mrope_collect(mrope_node *t, size_t pos, struct iovec *iov, size_t n, size_t max) {
+    size_t lsize;
+
+    if ((t == NULL) || (n >= max)) return n;
+
+    lsize = mrope_size(t->left);
+    if (pos < lsize) n = mrope_collect(t->left, pos, iov, n, max);
+
+    if ((n < max) && (pos < (lsize + t->len))) {
+        size_t off = (pos > lsize) ? pos - lsize : 0;
+        iov[n].iov_base = t->data + off;
+        iov[n].iov_len = t->len - off;
+        n++;
+    }
+
+    pos = (pos > (lsize + t->len)) ? pos - lsize - t->len : 0;
+    return mrope_collect(t->right, pos, iov, n, max);
+}
+
+size_t mrope_iovec(mrope *r, size_t *pos, struct iovec *iov, size_t max) {
+    size_t n = mrope_collect(r->root, *pos, iov, 0, max);
+
+    for (size_t i = 0; i < n; i++) *pos += iov[i].iov_len;
+    return n;
+}
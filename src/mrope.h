@@ -0,0 +1,143 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Rope string, for edits at random positions in large texts.
+ *
+ * @file     mrope.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * The text is stored in chunks of at most MROPE_CHUNK bytes kept in a
+ * balanced binary tree (a treap ordered by position), every node knowing
+ * the size of its subtree. Finding a position, inserting and deleting cost
+ * O(log n) in the nr of chunks plus at most one chunk of copying, compared
+ * to moving the whole tail in a mstr.
+ *
+ * The text is not contiguous, use mrope_to_mstr() to flatten it or
+ * mrope_iovec() to hand the chunks to writev() without copying.
+ */
+
+#ifndef MROPE_H
+#define MROPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include "mstr.h"
+
+// Macros -----------------------------------------------------------------
+
+#define MROPE_CHUNK 1024  // Max bytes in one chunk
+#define MROPE_FILL 768    // Bytes per chunk when building from a text
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct mrope_node_t {
+    struct mrope_node_t *left;
+    struct mrope_node_t *right;
+    size_t size;      // bytes in this subtree
+    uint32_t prio;    // heap priority, a parent never has a lower one
+    uint32_t len;     // bytes in data
+    char data[MROPE_CHUNK];
+} mrope_node;
+
+typedef struct {
+    mrope_node *root;
+    uint32_t seed;    // state of priority generator
+} mrope;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create new rope.
+ *
+ * @param src initial text, may be NULL
+ * @return pointer to rope
+ */
+mrope *mrope_new(char *src);
+
+/**
+ * Create new rope from a mstr.
+ *
+ * @param src string to copy
+ * @return pointer to rope
+ */
+mrope *mrope_news(mstr *src);
+
+/**
+ * Free rope.
+ *
+ * @param r rope
+ */
+void mrope_free(mrope *r);
+
+/**
+ * Length of text.
+ *
+ * @param r rope
+ * @return nr of bytes
+ */
+size_t mrope_len(mrope *r);
+
+/**
+ * Character at position.
+ *
+ * @param r rope
+ * @param pos position, must be < mrope_len()
+ * @return character
+ */
+char mrope_at(mrope *r, size_t pos);
+
+/**
+ * Insert text.
+ *
+ * @param r rope
+ * @param src text to insert
+ * @param len nr of bytes to insert
+ * @param pos position to insert at, must be <= mrope_len()
+ */
+void mrope_insert(mrope *r, char *src, size_t len, size_t pos);
+
+/**
+ * Delete text, clamped to the end of the rope.
+ *
+ * @param r rope
+ * @param pos first byte to delete
+ * @param len nr of bytes to delete
+ */
+void mrope_delete(mrope *r, size_t pos, size_t len);
+
+/**
+ * Copy text to a new mstr.
+ *
+ * @param r rope
+ * @return new mstr
+ */
+mstr *mrope_to_mstr(mrope *r);
+
+/**
+ * Describe chunks for writev() without copying. Call repeatedly until it
+ * returns 0 to walk the whole text.
+ *
+ * @param r rope
+ * @param pos position to start at, advanced past the chunks returned
+ * @param iov array to fill
+ * @param max nr of entries in iov
+ * @return nr of entries filled
+ */
+size_t mrope_iovec(mrope *r, size_t *pos, struct iovec *iov, size_t max);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
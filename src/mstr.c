@@ -22,26 +22,34 @@
 #include <assert.h>
 #include <stdint.h>
 
+#include "def_simd.h"
 #include "mstr.h"
 
-void mstr_move(mstr* dst, int pos, int moves);
-void mstr_move(mstr* dst, int pos, int moves) {
-    int pos_x = ((pos >= 0) ? pos : ((int)dst->len + pos));
+_Static_assert(offsetof(mstr_sso, sso) == sizeof(mstr),
+               "mstr_sso storage must follow the mstr header");
+
+// Inline storage, directly after the header
+char* mstr_buf(mstr* s);
+char* mstr_buf(mstr* s) { return (char*)(s + 1); }
+
+void mstr_move(mstr* dst, size_t pos, size_t moves);
+void mstr_move(mstr* dst, size_t pos, size_t moves) {
     // move existing text forward
-    for (int i = dst->len - 1; i >= pos_x; i--) {
-        dst->str[i + moves] = dst->str[i];
-    }
+    memmove(dst->str + pos + moves, dst->str + pos, dst->len - pos);
     dst->len += moves;
     dst->str[dst->len] = '\0';
 }
 
-void mstr_copy(mstr* dst, char* src, int pos, size_t len);
-void mstr_copy(mstr* dst, char* src, int pos, size_t len) {
-    int pos_x = ((pos >= 0) ? pos : ((int)dst->len + pos - 1));
+void mstr_copy(mstr* dst, char* src, size_t pos, size_t len);
+void mstr_copy(mstr* dst, char* src, size_t pos, size_t len) {
     // copy new text from src
-    for (size_t i = 0; i < len; i++) {
-        dst->str[i + pos_x] = src[i];
-    }
+    memcpy(dst->str + pos, src, len);
+}
+
+bool mstr_overlaps(mstr* s, char* p);
+bool mstr_overlaps(mstr* s, char* p) {
+    return ((uintptr_t)p >= (uintptr_t)s->str) &&
+           ((uintptr_t)p < (uintptr_t)(s->str + s->capacity));
 }
 
 void mstr_clear(mstr* s) {
@@ -49,36 +57,82 @@ void mstr_clear(mstr* s) {
     s->str[0] = '\0';
 }
 
-void mstr_allocate_capacity(mstr* dst, size_t required_capacity);
-void mstr_allocate_capacity(mstr* dst, size_t required_capacity) {
-    char* new_str;
+size_t mstr_calc_capacity(size_t required_capacity);
+size_t mstr_calc_capacity(size_t required_capacity) {
     size_t new_capacity;
 
     new_capacity = ((required_capacity / MSTR_BLOCK) + 1) * MSTR_BLOCK;
     if ((new_capacity - required_capacity) <= MSTR_EXTRA)
         new_capacity += MSTR_BLOCK;
 
+    return new_capacity;
+}
+
+size_t mstr_grow_capacity(size_t capacity, size_t required_capacity);
+size_t mstr_grow_capacity(size_t capacity, size_t required_capacity) {
+    size_t step;
+
+    step = (capacity * MSTR_GROWTH_NUM) / MSTR_GROWTH_DEN - capacity;
+    if (step > MSTR_GROWTH_MAX) step = MSTR_GROWTH_MAX;
+
+    if (required_capacity > capacity + step) return required_capacity;
+    return capacity + step;
+}
+
+bool mstr_is_inline(mstr* s) { return s->str == mstr_buf(s); }
+
+// Free characters stored in a separate heap buffer
+void mstr_free_str(mstr* s);
+void mstr_free_str(mstr* s) {
+    if (!mstr_is_inline(s) && (s->arena == NULL)) free(s->str);
+}
+
+void mstr_allocate_capacity(mstr* dst, size_t required_capacity);
+void mstr_allocate_capacity(mstr* dst, size_t required_capacity) {
+    char* new_str;
+    size_t new_capacity;
+
+    new_capacity = mstr_calc_capacity(required_capacity);
+
     if (new_capacity <= dst->capacity) return;
 
     // printf("Current capacity: %3lu  Required capacity: %3lu  New capacity:
     // %lu\n", dst->capacity, required_capacity, new_capacity);
-    dst->capacity = new_capacity;
 
-    new_str = (char*)malloc(new_capacity);
-    if (dst->str == NULL) {
-        dst->str = new_str;
-        return;
+    if (dst->arena != NULL) {
+        if (mstr_is_inline(dst)) {
+            // The characters follow the header, if it is the latest arena
+            // allocation the block can grow where it is.
+            if (marena_extend(dst->arena, dst, sizeof(mstr) + new_capacity)) {
+                dst->capacity = new_capacity;
+                return;
+            }
+            new_str = (char*)marena_alloc(dst->arena, new_capacity);
+            memcpy(new_str, dst->str, dst->len + 1);
+        } else {
+            new_str = (char*)marena_realloc(dst->arena, dst->str, dst->capacity, new_capacity);
+        }
+    } else if (mstr_is_inline(dst)) {
+        // Inline storage cannot grow without moving the mstr itself, move
+        // the characters out to a heap buffer.
+        new_str = (char*)malloc(new_capacity);
+        memcpy(new_str, dst->str, dst->len + 1);
+    } else {
+        new_str = (char*)realloc(dst->str, new_capacity);
     }
 
-    strncpy(new_str, dst->str, dst->len);
-    free(dst->str);
     dst->str = new_str;
+    dst->capacity = new_capacity;
 }
 
 void mstr_assert_capacity(mstr* mst, size_t required_capacity);
 void mstr_assert_capacity(mstr* mst, size_t required_capacity) {
-    if (((int)mst->capacity - (int)required_capacity) < MSTR_EXTRA) {
-        mstr_allocate_capacity(mst, required_capacity);
+    // Inline storage on the heap is used up to the terminator before the
+    // characters move out, growth slack only matters for heap buffers
+    if (mstr_is_inline(mst) && (mst->arena == NULL) && (mst->capacity > required_capacity)) return;
+
+    if (mst->capacity < (required_capacity + MSTR_EXTRA)) {
+        mstr_allocate_capacity(mst, mstr_grow_capacity(mst->capacity, required_capacity));
     }
     // printf("Assert: %s\n", mst->str);
     // printf("Capacity: %3lu   Required capacity: %lu\n", mst->capacity,
@@ -86,13 +140,31 @@ void mstr_assert_capacity(mstr* mst, size_t required_capacity) {
     assert(mst->capacity >= (required_capacity + MSTR_EXTRA));
 }
 
+void mstr_reserve(mstr* s, size_t capacity) {
+    mstr_allocate_capacity(s, capacity);
+}
+
+void mstr_shrink_to_fit(mstr* s) {
+    size_t capacity;
+
+    if (mstr_is_inline(s) || (s->arena != NULL)) return;
+
+    capacity = mstr_calc_capacity(s->len);
+    if (capacity >= s->capacity) return;
+
+    s->str = (char*)realloc(s->str, capacity);
+    s->capacity = capacity;
+}
+
 mstr* mstr_new_g(size_t required_capacity, char* src) {
-    mstr* mst = (mstr*)malloc(sizeof(mstr));
+    size_t capacity = mstr_calc_capacity(required_capacity);
+    mstr* mst = (mstr*)malloc(sizeof(mstr) + capacity);
 
-    mst->str = NULL;
-    mst->capacity = 0;
+    mst->str = mstr_buf(mst);
+    mst->capacity = capacity;
     mst->len = 0;
-    mstr_allocate_capacity(mst, required_capacity);
+    mst->arena = NULL;
+    mst->str[0] = '\0';
 
     if (src == NULL) return mst;
 
@@ -100,15 +172,47 @@ mstr* mstr_new_g(size_t required_capacity, char* src) {
     return mst;
 }
 
+mstr* mstr_new_a(marena* a, size_t required_capacity, char* src) {
+    size_t capacity = mstr_calc_capacity(required_capacity);
+    mstr* mst = (mstr*)marena_alloc(a, sizeof(mstr) + capacity);
+
+    mst->str = mstr_buf(mst);
+    mst->capacity = capacity;
+    mst->len = 0;
+    mst->arena = a;
+    mst->str[0] = '\0';
+
+    if (src != NULL) mstr_append(mst, src);
+    return mst;
+}
+
 mstr* mstr_newc(char* src) { return mstr_new_g(strlen(src), src); }
 
 mstr* mstr_news(mstr* src) { return mstr_new_g(src->len, src->str); }
 
 mstr* mstr_newl(size_t size) { return mstr_new_g(size, NULL); }
 
-void mstr_append_g(mstr* dst, char* src, size_t src_len) {
-    mstr_assert_capacity(dst, dst->len + src_len);
+mstr* mstr_init(mstr_sso* sso, char* src) {
+    mstr* mst = &sso->s;
+
+    mst->str = mstr_buf(mst);
+    mst->capacity = MSTR_SSO;
+    mst->len = 0;
+    mst->arena = NULL;
+    mst->str[0] = '\0';
 
+    if (src != NULL) mstr_append(mst, src);
+    return mst;
+}
+
+void mstr_release(mstr* s) {
+    mstr_free_str(s);
+    s->str = mstr_buf(s);
+    s->capacity = 0;
+    s->len = 0;
+}
+
+void mstr_append_g(mstr* dst, char* src, size_t src_len) {
     mstr_insert_g(dst, src, src_len, dst->len);
 }
 
@@ -121,9 +225,7 @@ void mstr_append_s(mstr* mst, mstr* astr) {
 }
 
 void mstr_prepend_g(mstr* dst, char* src, size_t len) {
-    mstr_assert_capacity(dst, dst->len + len);
-
-    mstr_insert(dst, src, 0);
+    mstr_insert_g(dst, src, len, 0);
 }
 
 void mstr_prepend_c(mstr* dst, char* src) {
@@ -135,13 +237,24 @@ void mstr_prepend_s(mstr* dst, mstr* src) {
 }
 
 void mstr_insert_g(mstr* dst, char* src, size_t len, int pos) {
-    if (dst->capacity <= (dst->len + len)) {
-        mstr_allocate_capacity(dst, dst->len + len);
+    size_t pos_x = ((pos >= 0) ? (size_t)pos : (dst->len + pos));
+    char* tmp = NULL;
+
+    // Inserting a part of dst into itself, the source would be moved by
+    // the reallocation or the move so take a copy first.
+    if (mstr_overlaps(dst, src)) {
+        tmp = (char*)malloc(len);
+        memcpy(tmp, src, len);
+        src = tmp;
     }
-    assert(dst->capacity > (dst->len + len - pos));
 
-    mstr_move(dst, pos, len);
-    mstr_copy(dst, src, pos, len);
+    mstr_assert_capacity(dst, dst->len + len);
+    assert(pos_x <= dst->len);
+
+    mstr_move(dst, pos_x, len);
+    mstr_copy(dst, src, pos_x, len);
+
+    free(tmp);
 }
 
 void mstr_insert_c(mstr* dst, char* src, int pos) {
@@ -152,98 +265,1086 @@ void mstr_insert_s(mstr* dst, mstr* src, int pos) {
     mstr_insert_g(dst, src->str, src->len, pos);
 }
 
-// int mstr_find(mstr *s, char *x)
-// {
-// }
-
-// void mstr_replace(mstr* s, char* old, char* new) {
-    // char *x;
-    // int pos;
-    //  x = strstr(s->str, old);
-    //  pos = (int)x - (int)s;
-    //  printf("x = %d\n", pos);
-// }
-
 void mstr_free(mstr* s) {
-    free(s->str);
+    if (s->arena != NULL) return;  // Released with the arena
+
+    mstr_release(s);
     free(s);
 }
 
-bool mstr_instr(char ch, char* str);
-bool mstr_instr(char ch, char* str) {
-    for (size_t i = 0; i < strlen(str); i++) {
-        if (ch == str[i]) return true;
+void mstr_charset_init(mstr_charset* cs, char* chars) {
+    memset(cs->bits, 0, sizeof(cs->bits));
+
+    for (; *chars != '\0'; chars++) {
+        unsigned char c = (unsigned char)*chars;
+        cs->bits[c >> 3] |= (uint8_t)(1 << (c & 7));
     }
-    return false;
 }
 
-void mstr_rstrip(mstr* s, char* st) {
-    size_t anchor;
-    anchor = 0;
+void mstr_rstrip_set(mstr* s, mstr_charset* cs) {
+    size_t anchor = 0;
 
-    for (size_t i = 0; i < s->len; i++) {
-        if (mstr_instr(s->str[i], st))
-            anchor++;
-        else
-            break;
-    }
+    while ((anchor < s->len) && mstr_charset_has(cs, s->str[anchor])) anchor++;
 
-    for (size_t i = 0; i < s->len; i++) s->str[i] = s->str[i + anchor];
+    if (anchor == 0) return;
 
     s->len -= anchor;
+    memmove(s->str, s->str + anchor, s->len + 1);
 }
 
-void mstr_lstrip(mstr* s, char* st) {
-    for (int i = s->len - 1; i > 0; i--) {
-        if (mstr_instr(s->str[i], st))
-            s->len--;
-        else
-            break;
-    }
+void mstr_lstrip_set(mstr* s, mstr_charset* cs) {
+    while ((s->len > 0) && mstr_charset_has(cs, s->str[s->len - 1])) s->len--;
+
     s->str[s->len] = '\0';
 }
 
+void mstr_strip_set(mstr* s, mstr_charset* cs) {
+    mstr_rstrip_set(s, cs);
+    mstr_lstrip_set(s, cs);
+}
+
+void mstr_rstrip(mstr* s, char* st) {
+    mstr_charset cs;
+
+    mstr_charset_init(&cs, st);
+    mstr_rstrip_set(s, &cs);
+}
+
+void mstr_lstrip(mstr* s, char* st) {
+    mstr_charset cs;
+
+    mstr_charset_init(&cs, st);
+    mstr_lstrip_set(s, &cs);
+}
+
 void mstr_strip(mstr* s, char* st) {
-    mstr_rstrip(s, st);
-    mstr_lstrip(s, st);
+    mstr_charset cs;
+
+    mstr_charset_init(&cs, st);
+    mstr_strip_set(s, &cs);
 }
 
 size_t mstr_len(mstr* s) { return s->len; }
 
-bool mstr_is_alpha(mstr* s) {
-    if (s->len == 0) return false;
+// ASCII fast paths -------------------------------------------------------
+//
+// Classification and case conversion check 16 (SSE2) or 32 (AVX2) bytes per
+// iteration using ASCII ranges. Bytes >= 0x80 are left to the locale aware
+// ctype functions, so results are identical to the plain per byte loops.
+// UTF-8 validation and counting are selected with the same levels.
 
-    for (size_t i = 0; i < s->len; i++) {
-        if (!isalpha(s->str[i])) return false;
+#ifdef DEF_SIMD_X86
+#define MSTR_SIMD_X86
+#endif
+
+enum { MSTR_CLASS_ALPHA, MSTR_CLASS_DIGIT, MSTR_CLASS_ALNUM, MSTR_CLASS_SPACE };
+
+typedef size_t (*mstr_span_fn)(const unsigned char* p, size_t len, int cls);
+typedef void (*mstr_case_fn)(unsigned char* p, size_t len, bool upper);
+typedef const char* (*mstr_search_fn)(const char* h, size_t hlen, const char* n, size_t nlen);
+
+typedef size_t (*mstr_ascii_fn)(const unsigned char* p, size_t len);
+typedef size_t (*mstr_utf8_count_fn)(const unsigned char* p, size_t len);
+typedef bool (*mstr_utf8_valid_fn)(const unsigned char* p, size_t len);
+typedef size_t (*mstr_utf8_cols_fn)(const unsigned char* p, size_t len);
+
+static size_t mstr_span_scalar(const unsigned char* p, size_t len, int cls);
+static void mstr_case_scalar(unsigned char* p, size_t len, bool upper);
+static const char* mstr_search_scalar(const char* h, size_t hlen, const char* n, size_t nlen);
+static size_t mstr_ascii_scalar(const unsigned char* p, size_t len);
+static size_t mstr_utf8_count_scalar(const unsigned char* p, size_t len);
+static bool mstr_utf8_valid_scalar(const unsigned char* p, size_t len);
+static size_t mstr_utf8_cols_scalar(const unsigned char* p, size_t len);
+
+// Scalar until mstr_simd_set() runs at load time
+static int mstr_simd = MSTR_SIMD_SCALAR;
+static mstr_span_fn mstr_span = mstr_span_scalar;
+static mstr_case_fn mstr_case = mstr_case_scalar;
+static mstr_search_fn mstr_search = mstr_search_scalar;
+static mstr_ascii_fn mstr_ascii = mstr_ascii_scalar;
+static mstr_utf8_count_fn mstr_utf8_count = mstr_utf8_count_scalar;
+static mstr_utf8_valid_fn mstr_utf8_check = mstr_utf8_valid_scalar;
+static mstr_utf8_cols_fn mstr_utf8_cols = mstr_utf8_cols_scalar;
+
+static inline bool mstr_ascii_in(unsigned char c, int cls) {
+    bool alpha = (unsigned char)((c | 0x20) - 'a') < 26;
+    bool digit = (unsigned char)(c - '0') < 10;
+
+    switch (cls) {
+        case MSTR_CLASS_ALPHA: return alpha;
+        case MSTR_CLASS_DIGIT: return digit;
+        case MSTR_CLASS_ALNUM: return alpha || digit;
+        default: return (c == ' ') || ((unsigned char)(c - '\t') < 5);
     }
-    return true;
 }
 
-bool mstr_is_numeric(mstr* s) {
-    if (s->len == 0) return false;
+static bool mstr_ctype_in(unsigned char c, int cls) {
+    switch (cls) {
+        case MSTR_CLASS_ALPHA: return isalpha(c);
+        case MSTR_CLASS_DIGIT: return isdigit(c);
+        case MSTR_CLASS_ALNUM: return isalnum(c);
+        default: return isspace(c);
+    }
+}
+
+static size_t mstr_span_scalar(const unsigned char* p, size_t len, int cls) {
+    size_t i = 0;
 
-    for (size_t i = 0; i < s->len; i++) {
-        if (!isdigit(s->str[i])) return false;
+    while ((i < len) && mstr_ascii_in(p[i], cls)) i++;
+    return i;
+}
+
+static void mstr_case_ctype(unsigned char* p, size_t len, bool upper) {
+    for (size_t i = 0; i < len; i++) {
+        p[i] = upper ? toupper(p[i]) : tolower(p[i]);
     }
-    return true;
 }
 
-bool mstr_is_alnum(mstr* s) {
-    if (s->len == 0) return false;
+static void mstr_case_scalar(unsigned char* p, size_t len, bool upper) {
+    unsigned char first = upper ? 'a' : 'A';
+
+    for (size_t i = 0; i < len; i++) {
+        if (p[i] & 0x80)
+            mstr_case_ctype(p + i, 1, upper);
+        else if ((unsigned char)(p[i] - first) < 26)
+            p[i] ^= 0x20;
+    }
+}
+
+// Search for needle (nlen >= 2), first byte candidates found by memchr
+static const char* mstr_search_scalar(const char* h, size_t hlen, const char* n, size_t nlen) {
+    const char* end = h + hlen - nlen + 1;
+    const char* p = h;
+
+    while ((p < end) && ((p = memchr(p, n[0], end - p)) != NULL)) {
+        if ((p[nlen - 1] == n[nlen - 1]) && !memcmp(p + 1, n + 1, nlen - 2)) return p;
+        p++;
+    }
+    return NULL;
+}
+
+// Length of the valid UTF-8 sequence starting with the non ASCII byte at
+// p, 0 if it is not valid. Overlong forms, surrogates and code points
+// above U+10FFFF are rejected.
+static size_t mstr_utf8_seq(const unsigned char* p, size_t len) {
+    unsigned char c = p[0];
+
+    if (c < 0xC2) return 0;
+    if (c < 0xE0) return ((len >= 2) && ((p[1] & 0xC0) == 0x80)) ? 2 : 0;
+
+    if (c < 0xF0) {
+        if ((len < 3) || ((p[1] & 0xC0) != 0x80) || ((p[2] & 0xC0) != 0x80)) return 0;
+        if ((c == 0xE0) && (p[1] < 0xA0)) return 0;
+        if ((c == 0xED) && (p[1] > 0x9F)) return 0;
+        return 3;
+    }
+
+    if (c < 0xF5) {
+        if ((len < 4) || ((p[1] & 0xC0) != 0x80) || ((p[2] & 0xC0) != 0x80) || ((p[3] & 0xC0) != 0x80)) return 0;
+        if ((c == 0xF0) && (p[1] < 0x90)) return 0;
+        if ((c == 0xF4) && (p[1] > 0x8F)) return 0;
+        return 4;
+    }
+    return 0;
+}
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} mstr_range;
+
+// Combining marks and format characters, zero columns
+static const mstr_range mstr_width_zero[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF},
+    {0x05C1, 0x05C2}, {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A},
+    {0x064B, 0x065F}, {0x0670, 0x0670}, {0x06D6, 0x06DC}, {0x06DF, 0x06E4},
+    {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0E31, 0x0E31}, {0x0E34, 0x0E3A},
+    {0x0E47, 0x0E4E}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F},
+    {0x202A, 0x202E}, {0x2060, 0x2064}, {0x20D0, 0x20FF}, {0xFE00, 0xFE0F},
+    {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0xE0100, 0xE01EF}};
+
+// East Asian wide and fullwidth characters and emoji, two columns
+static const mstr_range mstr_width_wide[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC},
+    {0x23F0, 0x23F0}, {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615},
+    {0x2648, 0x2653}, {0x267F, 0x267F}, {0x2693, 0x2693}, {0x26A1, 0x26A1},
+    {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5}, {0x26CE, 0x26CE},
+    {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+    {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B},
+    {0x2728, 0x2728}, {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755},
+    {0x2757, 0x2757}, {0x2795, 0x2797}, {0x27B0, 0x27B0}, {0x27BF, 0x27BF},
+    {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55}, {0x2E80, 0x303E},
+    {0x3041, 0x4DBF}, {0x4E00, 0xA4CF}, {0xA960, 0xA97F}, {0xAC00, 0xD7A3},
+    {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F}, {0xFF00, 0xFF60},
+    {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4}, {0x17000, 0x18CFF}, {0x1B000, 0x1B2FF},
+    {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A},
+    {0x1F200, 0x1F251}, {0x1F300, 0x1F64F}, {0x1F680, 0x1F6FF}, {0x1F7E0, 0x1F7EB},
+    {0x1F90C, 0x1F9FF}, {0x1FA70, 0x1FAFF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}};
+
+bool mstr_in_ranges(const mstr_range* r, size_t n, uint32_t cp);
+bool mstr_in_ranges(const mstr_range* r, size_t n, uint32_t cp) {
+    size_t lo = 0;
+    size_t hi = n;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (cp < r[mid].first) {
+            hi = mid;
+        } else if (cp > r[mid].last) {
+            lo = mid + 1;
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+int mstr_cp_width(uint32_t cp);
+int mstr_cp_width(uint32_t cp) {
+    if (cp < 0x0300) return 1;
+    // CJK ideographs and Hangul syllables, the common wide ones
+    if (((cp >= 0x4E00) && (cp <= 0x9FFF)) || ((cp >= 0xAC00) && (cp <= 0xD7A3))) return 2;
+    if (mstr_in_ranges(mstr_width_zero, sizeof(mstr_width_zero) / sizeof(mstr_range), cp)) return 0;
+    if (mstr_in_ranges(mstr_width_wide, sizeof(mstr_width_wide) / sizeof(mstr_range), cp)) return 2;
+    return 1;
+}
+
+// Columns of the characters starting at *pos before end, continuation
+// bytes take none. *pos is left after the last character, which may end
+// past end.
+static size_t mstr_utf8_cols_chars(const unsigned char* p, size_t len, size_t* pos, size_t end) {
+    size_t width = 0;
+    size_t i = *pos;
+    size_t n;
+    uint32_t cp;
+
+    while (i < end) {
+        if (p[i] < 0x80) {
+            width++;
+            i++;
+            continue;
+        }
+        if (p[i] < 0xC0) {
+            i++;
+            continue;
+        }
+
+        // Sequence length from the lead byte only, the input is assumed
+        // to be valid
+        n = (p[i] < 0xE0) ? 2 : (p[i] < 0xF0) ? 3 : 4;
+        if (n > (len - i)) n = len - i;
+        cp = p[i] & (0x7F >> n);
+        for (size_t k = 1; k < n; k++) cp = (cp << 6) | (p[i + k] & 0x3F);
+        width += mstr_cp_width(cp);
+        i += n;
+    }
+    *pos = i;
+    return width;
+}
+
+// ASCII runs with the selected kernel, other characters one by one
+static size_t mstr_utf8_cols_scalar(const unsigned char* p, size_t len) {
+    size_t width = 0;
+    size_t i = 0;
+    size_t n;
+
+    while (i < len) {
+        if (p[i] < 0x80) {
+            n = mstr_ascii(p + i, len - i);
+            width += n;
+            i += n;
+        } else {
+            width += mstr_utf8_cols_chars(p, len, &i, i + 1);
+        }
+    }
+    return width;
+}
+
+static size_t mstr_ascii_byte(const unsigned char* p, size_t len) {
+    size_t i = 0;
+
+    while ((i < len) && !(p[i] & 0x80)) i++;
+    return i;
+}
+
+// Eight bytes at a time in a 64 bit word
+static size_t mstr_ascii_scalar(const unsigned char* p, size_t len) {
+    size_t i = 0;
+    uint64_t w;
+
+    for (; (i + 8) <= len; i += 8) {
+        memcpy(&w, p + i, 8);
+        if (w & 0x8080808080808080ULL) break;
+    }
+    return i + mstr_ascii_byte(p + i, len - i);
+}
+
+static size_t mstr_utf8_count_byte(const unsigned char* p, size_t len) {
+    size_t n = 0;
+
+    for (size_t i = 0; i < len; i++) n += ((p[i] & 0xC0) != 0x80);
+    return n;
+}
+
+// Continuation bytes 10xxxxxx have bit 7 set and bit 6 clear
+static size_t mstr_utf8_count_scalar(const unsigned char* p, size_t len) {
+    size_t n = 0;
+    size_t i = 0;
+    uint64_t w;
+
+    // One bit per continuation byte at the bottom of each byte, summed by
+    // multiplication into the top byte
+    for (; (i + 8) <= len; i += 8) {
+        memcpy(&w, p + i, 8);
+        n += 8 - ((((w >> 7) & ~(w >> 6) & 0x0101010101010101ULL) * 0x0101010101010101ULL) >> 56);
+    }
+    return n + mstr_utf8_count_byte(p + i, len - i);
+}
+
+// Skip ASCII with the selected kernel, check multibyte sequences one by one
+static bool mstr_utf8_valid_scalar(const unsigned char* p, size_t len) {
+    size_t i = 0;
+    size_t n;
+
+    for (;;) {
+        i += mstr_ascii(p + i, len - i);
+        if (i == len) return true;
+        if ((n = mstr_utf8_seq(p + i, len - i)) == 0) return false;
+        i += n;
+    }
+}
+
+#ifdef MSTR_SIMD_X86
+
+// Mask of bytes within [lo, hi], signed compare on values biased by 0x80
+__attribute__((target("sse2"))) static inline __m128i mstr_range_sse2(__m128i x, char lo, char hi) {
+    __m128i biased = _mm_add_epi8(x, _mm_set1_epi8((char)(0x80 - lo)));
+    return _mm_cmplt_epi8(biased, _mm_set1_epi8((char)(0x80 + hi - lo + 1)));
+}
+
+__attribute__((target("sse2"))) static inline __m128i mstr_class_sse2(__m128i x, int cls) {
+    __m128i alpha = mstr_range_sse2(_mm_or_si128(x, _mm_set1_epi8(0x20)), 'a', 'z');
+    __m128i digit = mstr_range_sse2(x, '0', '9');
+
+    switch (cls) {
+        case MSTR_CLASS_ALPHA: return alpha;
+        case MSTR_CLASS_DIGIT: return digit;
+        case MSTR_CLASS_ALNUM: return _mm_or_si128(alpha, digit);
+        default: return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), mstr_range_sse2(x, '\t', '\r'));
+    }
+}
+
+__attribute__((target("avx2"))) static inline __m256i mstr_range_avx2(__m256i x, char lo, char hi) {
+    __m256i biased = _mm256_add_epi8(x, _mm256_set1_epi8((char)(0x80 - lo)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(0x80 + hi - lo + 1)), biased);
+}
+
+__attribute__((target("avx2"))) static inline __m256i mstr_class_avx2(__m256i x, int cls) {
+    __m256i alpha = mstr_range_avx2(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i digit = mstr_range_avx2(x, '0', '9');
+
+    switch (cls) {
+        case MSTR_CLASS_ALPHA: return alpha;
+        case MSTR_CLASS_DIGIT: return digit;
+        case MSTR_CLASS_ALNUM: return _mm256_or_si256(alpha, digit);
+        default: return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), mstr_range_avx2(x, '\t', '\r'));
+    }
+}
+
+__attribute__((target("sse2"))) static size_t mstr_span_sse2(const unsigned char* p, size_t len, int cls) {
+    size_t i = 0;
 
-    for (size_t i = 0; i < s->len; i++) {
-        if (!isalnum(s->str[i])) return false;
+    for (; (i + 16) <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+        unsigned int m = (unsigned int)_mm_movemask_epi8(mstr_class_sse2(x, cls));
+
+        if (m != 0xFFFF) return i + __builtin_ctz(~m);
+    }
+    return i + mstr_span_scalar(p + i, len - i, cls);
+}
+
+__attribute__((target("sse2"))) static void mstr_case_sse2(unsigned char* p, size_t len, bool upper) {
+    char first = upper ? 'a' : 'A';
+    size_t i = 0;
+
+    for (; (i + 16) <= len; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+
+        if (_mm_movemask_epi8(x)) {
+            mstr_case_scalar(p + i, 16, upper);
+            continue;
+        }
+        x = _mm_xor_si128(x, _mm_and_si128(mstr_range_sse2(x, first, first + 25), _mm_set1_epi8(0x20)));
+        _mm_storeu_si128((__m128i*)(p + i), x);
+    }
+    mstr_case_scalar(p + i, len - i, upper);
+}
+
+__attribute__((target("avx2"))) static size_t mstr_span_avx2(const unsigned char* p, size_t len, int cls) {
+    size_t i = 0;
+
+    for (; (i + 32) <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+        unsigned int m = (unsigned int)_mm256_movemask_epi8(mstr_class_avx2(x, cls));
+
+        if (m != 0xFFFFFFFF) return i + __builtin_ctz(~m);
+    }
+    // Leave AVX state before running legacy SSE code on the tail
+    _mm256_zeroupper();
+    return i + mstr_span_sse2(p + i, len - i, cls);
+}
+
+__attribute__((target("avx2"))) static void mstr_case_avx2(unsigned char* p, size_t len, bool upper) {
+    char first = upper ? 'a' : 'A';
+    size_t i = 0;
+
+    for (; (i + 32) <= len; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+
+        if (_mm256_movemask_epi8(x)) {
+            mstr_case_scalar(p + i, 32, upper);
+            continue;
+        }
+        x = _mm256_xor_si256(x, _mm256_and_si256(mstr_range_avx2(x, first, first + 25), _mm256_set1_epi8(0x20)));
+        _mm256_storeu_si256((__m256i*)(p + i), x);
+    }
+    _mm256_zeroupper();
+    mstr_case_sse2(p + i, len - i, upper);
+}
+
+// Search for needle (nlen >= 2) by comparing a block of possible start
+// positions against the first and the last byte of the needle at once,
+// only positions matching both are verified with memcmp.
+__attribute__((target("sse2"))) static const char* mstr_search_sse2(const char* h, size_t hlen, const char* n, size_t nlen) {
+    __m128i first = _mm_set1_epi8(n[0]);
+    __m128i last = _mm_set1_epi8(n[nlen - 1]);
+    size_t i = 0;
+
+    for (; (i + nlen - 1 + 16) <= hlen; i += 16) {
+        __m128i bf = _mm_loadu_si128((const __m128i*)(h + i));
+        __m128i bl = _mm_loadu_si128((const __m128i*)(h + i + nlen - 1));
+        unsigned int m = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(bf, first), _mm_cmpeq_epi8(bl, last)));
+
+        while (m) {
+            size_t pos = i + __builtin_ctz(m);
+            if (!memcmp(h + pos + 1, n + 1, nlen - 2)) return h + pos;
+            m &= m - 1;
+        }
+    }
+    if (i + nlen > hlen) return NULL;
+    return mstr_search_scalar(h + i, hlen - i, n, nlen);
+}
+
+__attribute__((target("avx2"))) static const char* mstr_search_avx2(const char* h, size_t hlen, const char* n, size_t nlen) {
+    __m256i first = _mm256_set1_epi8(n[0]);
+    __m256i last = _mm256_set1_epi8(n[nlen - 1]);
+    size_t i = 0;
+
+    for (; (i + nlen - 1 + 32) <= hlen; i += 32) {
+        __m256i bf = _mm256_loadu_si256((const __m256i*)(h + i));
+        __m256i bl = _mm256_loadu_si256((const __m256i*)(h + i + nlen - 1));
+        unsigned int m = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(bf, first), _mm256_cmpeq_epi8(bl, last)));
+
+        while (m) {
+            size_t pos = i + __builtin_ctz(m);
+            if (!memcmp(h + pos + 1, n + 1, nlen - 2)) {
+                _mm256_zeroupper();
+                return h + pos;
+            }
+            m &= m - 1;
+        }
+    }
+    _mm256_zeroupper();
+    if (i + nlen > hlen) return NULL;
+    return mstr_search_scalar(h + i, hlen - i, n, nlen);
+}
+
+__attribute__((target("sse2"))) static size_t mstr_ascii_sse2(const unsigned char* p, size_t len) {
+    size_t i = 0;
+
+    for (; (i + 16) <= len; i += 16) {
+        unsigned int m = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(p + i)));
+        if (m) return i + __builtin_ctz(m);
+    }
+    return i + mstr_ascii_byte(p + i, len - i);
+}
+
+// Bytes not in 0x80..0xBF found by signed compare, counted in byte lanes
+// for up to 255 blocks and then summed with psadbw
+__attribute__((target("sse2"))) static size_t mstr_utf8_count_sse2(const unsigned char* p, size_t len) {
+    size_t n = 0;
+    size_t i = 0;
+
+    while ((i + 16) <= len) {
+        __m128i acc = _mm_setzero_si128();
+        for (int k = 0; (k < 255) && ((i + 16) <= len); k++, i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+            acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(x, _mm_set1_epi8(-65)));
+        }
+        acc = _mm_sad_epu8(acc, _mm_setzero_si128());
+        n += (size_t)_mm_cvtsi128_si32(acc) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 8));
+    }
+    return n + mstr_utf8_count_byte(p + i, len - i);
+}
+
+__attribute__((target("avx2"))) static size_t mstr_ascii_avx2(const unsigned char* p, size_t len) {
+    size_t i = 0;
+
+    for (; (i + 32) <= len; i += 32) {
+        unsigned int m = _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(p + i)));
+        if (m) {
+            _mm256_zeroupper();
+            return i + __builtin_ctz(m);
+        }
+    }
+    _mm256_zeroupper();
+    return i + mstr_ascii_sse2(p + i, len - i);
+}
+
+__attribute__((target("avx2"))) static size_t mstr_utf8_count_avx2(const unsigned char* p, size_t len) {
+    size_t n = 0;
+    size_t i = 0;
+
+    while ((i + 32) <= len) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int k = 0; (k < 255) && ((i + 32) <= len); k++, i += 32) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+            acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(x, _mm256_set1_epi8(-65)));
+        }
+        acc = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+        n += (size_t)_mm256_extract_epi64(acc, 0) + (size_t)_mm256_extract_epi64(acc, 1) +
+             (size_t)_mm256_extract_epi64(acc, 2) + (size_t)_mm256_extract_epi64(acc, 3);
+    }
+    _mm256_zeroupper();
+    return n + mstr_utf8_count_sse2(p + i, len - i);
+}
+
+// UTF-8 validation by table lookups on byte pairs (Keiser & Lemire,
+// "Validating UTF-8 In Less Than One Instruction Per Byte"). Each pair of
+// consecutive bytes is classified by three 16 entry tables indexed by the
+// high and low nibble of the first byte and the high nibble of the second,
+// an error bit left set by all three marks an invalid pair. Third and
+// fourth bytes of a sequence are checked with saturated subtractions.
+#define MSTR_U8_TOO_SHORT  (1 << 0)  // Lead byte not followed by continuation
+#define MSTR_U8_TOO_LONG   (1 << 1)  // ASCII followed by continuation
+#define MSTR_U8_OVERLONG_3 (1 << 2)
+#define MSTR_U8_TOO_LARGE  (1 << 3)
+#define MSTR_U8_SURROGATE  (1 << 4)
+#define MSTR_U8_OVERLONG_2 (1 << 5)
+#define MSTR_U8_TOO_LARGE_1000 (1 << 6)
+#define MSTR_U8_OVERLONG_4 (1 << 6)
+#define MSTR_U8_TWO_CONTS  (1 << 7)  // Two continuation bytes
+#define MSTR_U8_CARRY (MSTR_U8_TOO_SHORT | MSTR_U8_TOO_LONG | MSTR_U8_TWO_CONTS)
+
+#define MSTR_TABLE_AVX2(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+// Input shifted right by N bytes with the end of the previous block in front
+#define MSTR_PREV_AVX2(IN, PREV, N) \
+    _mm256_alignr_epi8((IN), _mm256_permute2x128_si256((PREV), (IN), 0x21), 16 - (N))
+
+__attribute__((target("avx2"))) static bool mstr_utf8_valid_avx2(const unsigned char* p, size_t len) {
+    const __m256i byte_1_high = MSTR_TABLE_AVX2(
+        MSTR_U8_TOO_LONG, MSTR_U8_TOO_LONG, MSTR_U8_TOO_LONG, MSTR_U8_TOO_LONG,
+        MSTR_U8_TOO_LONG, MSTR_U8_TOO_LONG, MSTR_U8_TOO_LONG, MSTR_U8_TOO_LONG,
+        MSTR_U8_TWO_CONTS, MSTR_U8_TWO_CONTS, MSTR_U8_TWO_CONTS, MSTR_U8_TWO_CONTS,
+        MSTR_U8_TOO_SHORT | MSTR_U8_OVERLONG_2,
+        MSTR_U8_TOO_SHORT,
+        MSTR_U8_TOO_SHORT | MSTR_U8_OVERLONG_3 | MSTR_U8_SURROGATE,
+        MSTR_U8_TOO_SHORT | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000 | MSTR_U8_OVERLONG_4);
+    const __m256i byte_1_low = MSTR_TABLE_AVX2(
+        MSTR_U8_CARRY | MSTR_U8_OVERLONG_3 | MSTR_U8_OVERLONG_2 | MSTR_U8_OVERLONG_4,
+        MSTR_U8_CARRY | MSTR_U8_OVERLONG_2,
+        MSTR_U8_CARRY,
+        MSTR_U8_CARRY,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000 | MSTR_U8_SURROGATE,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000,
+        MSTR_U8_CARRY | MSTR_U8_TOO_LARGE | MSTR_U8_TOO_LARGE_1000);
+    const __m256i byte_2_high = MSTR_TABLE_AVX2(
+        MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT,
+        MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT,
+        MSTR_U8_TOO_LONG | MSTR_U8_OVERLONG_2 | MSTR_U8_TWO_CONTS | MSTR_U8_OVERLONG_3 | MSTR_U8_TOO_LARGE_1000 | MSTR_U8_OVERLONG_4,
+        MSTR_U8_TOO_LONG | MSTR_U8_OVERLONG_2 | MSTR_U8_TWO_CONTS | MSTR_U8_OVERLONG_3 | MSTR_U8_TOO_LARGE,
+        MSTR_U8_TOO_LONG | MSTR_U8_OVERLONG_2 | MSTR_U8_TWO_CONTS | MSTR_U8_SURROGATE | MSTR_U8_TOO_LARGE,
+        MSTR_U8_TOO_LONG | MSTR_U8_OVERLONG_2 | MSTR_U8_TWO_CONTS | MSTR_U8_SURROGATE | MSTR_U8_TOO_LARGE,
+        MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT, MSTR_U8_TOO_SHORT);
+    // A lead byte in the last 1, 2 or 3 positions continues in next block
+    const __m256i max_value = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i prev = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    __m256i error = _mm256_setzero_si256();
+    unsigned char tail[32];
+    bool valid;
+
+    for (size_t i = 0; i < len; i += 32) {
+        __m256i in;
+
+        if ((i + 32) <= len) {
+            in = _mm256_loadu_si256((const __m256i*)(p + i));
+        } else {
+            // Pad the last block with ASCII
+            memset(tail, 0, sizeof(tail));
+            memcpy(tail, p + i, len - i);
+            in = _mm256_loadu_si256((const __m256i*)tail);
+        }
+
+        if (_mm256_movemask_epi8(in) == 0) {
+            error = _mm256_or_si256(error, incomplete);
+        } else {
+            __m256i prev1 = MSTR_PREV_AVX2(in, prev, 1);
+            __m256i prev2 = MSTR_PREV_AVX2(in, prev, 2);
+            __m256i prev3 = MSTR_PREV_AVX2(in, prev, 3);
+            __m256i special = _mm256_and_si256(
+                _mm256_and_si256(
+                    _mm256_shuffle_epi8(byte_1_high, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+                    _mm256_shuffle_epi8(byte_1_low, _mm256_and_si256(prev1, nibble))),
+                _mm256_shuffle_epi8(byte_2_high, _mm256_and_si256(_mm256_srli_epi16(in, 4), nibble)));
+            // Bytes that must be the 2nd or 3rd continuation of a sequence
+            __m256i must23 = _mm256_or_si256(_mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)),
+                                             _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80)));
+            __m256i must23_80 = _mm256_and_si256(must23, _mm256_set1_epi8(0x80));
+
+            error = _mm256_or_si256(error, _mm256_xor_si256(must23_80, special));
+            incomplete = _mm256_subs_epu8(in, max_value);
+        }
+        prev = in;
     }
-    return true;
+    error = _mm256_or_si256(error, incomplete);
+    valid = _mm256_testz_si256(error, error);
+    _mm256_zeroupper();
+    return valid;
+}
+
+// Columns 32 bytes at a time for blocks where each byte is ASCII, a
+// continuation, a lead of U+0080..U+02FF (one column), a lead of
+// U+4000..U+9FFF except U+4DC0..U+4DFF (CJK ideographs) or a lead of
+// U+AC00..U+D77F (Hangul syllables), both two columns. Other blocks are
+// done per character.
+// Unsigned byte compares
+#define MSTR_GE_AVX2(X, V) _mm256_cmpeq_epi8(_mm256_max_epu8((X), _mm256_set1_epi8(V)), (X))
+#define MSTR_LE_AVX2(X, V) _mm256_cmpeq_epi8(_mm256_min_epu8((X), _mm256_set1_epi8(V)), (X))
+
+__attribute__((target("avx2"))) static size_t mstr_utf8_cols_avx2(const unsigned char* p, size_t len) {
+    __m256i acc = _mm256_setzero_si256();
+    size_t width = 0;
+    size_t i = 0;
+    int blocks = 0;
+
+    // One byte of look ahead for the second byte of a lead
+    while ((i + 33) <= len) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+
+        if (_mm256_movemask_epi8(x) == 0) {
+            width += 32;
+            i += 32;
+            continue;
+        }
+
+        __m256i next = _mm256_loadu_si256((const __m256i*)(p + i + 1));
+        __m256i ge_cc = MSTR_GE_AVX2(x, 0xCC);
+        __m256i wide = _mm256_or_si256(
+            _mm256_and_si256(MSTR_GE_AVX2(x, 0xE4), MSTR_LE_AVX2(x, 0xE9)),
+            _mm256_or_si256(
+                _mm256_and_si256(MSTR_GE_AVX2(x, 0xEB), MSTR_LE_AVX2(x, 0xEC)),
+                _mm256_or_si256(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(0xEA)), MSTR_GE_AVX2(next, 0xB0)),
+                    _mm256_and_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(0xED)), MSTR_LE_AVX2(next, 0x9D)))));
+        __m256i yijing = _mm256_and_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(0xE4)),
+                                          _mm256_cmpeq_epi8(next, _mm256_set1_epi8(0xB7)));
+        __m256i hard = _mm256_or_si256(_mm256_andnot_si256(wide, ge_cc), yijing);
+
+        if (!_mm256_testz_si256(hard, hard)) {
+            width += mstr_utf8_cols_chars(p, len, &i, i + 32);
+            continue;
+        }
+
+        // Every non continuation byte counts one, wide leads one more.
+        // Byte lanes hold at most 2 per block, flush before they overflow.
+        acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(x, _mm256_set1_epi8(-65)));
+        acc = _mm256_sub_epi8(acc, wide);
+        i += 32;
+        if (++blocks == 127) {
+            acc = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+            width += (size_t)_mm256_extract_epi64(acc, 0) + (size_t)_mm256_extract_epi64(acc, 1) +
+                     (size_t)_mm256_extract_epi64(acc, 2) + (size_t)_mm256_extract_epi64(acc, 3);
+            acc = _mm256_setzero_si256();
+            blocks = 0;
+        }
+    }
+    acc = _mm256_sad_epu8(acc, _mm256_setzero_si256());
+    width += (size_t)_mm256_extract_epi64(acc, 0) + (size_t)_mm256_extract_epi64(acc, 1) +
+             (size_t)_mm256_extract_epi64(acc, 2) + (size_t)_mm256_extract_epi64(acc, 3);
+    _mm256_zeroupper();
+
+    return width + mstr_utf8_cols_chars(p, len, &i, len);
 }
 
-bool mstr_is_space(mstr* s) {
+#endif
+
+int mstr_simd_set(int level) {
+    int supported = MSTR_SIMD_SCALAR + def_simd_supported();
+
+    if ((level < 0) || (level > supported)) level = supported;
+
+    switch (level) {
+#ifdef MSTR_SIMD_X86
+        case MSTR_SIMD_AVX2:
+            mstr_span = mstr_span_avx2;
+            mstr_case = mstr_case_avx2;
+            mstr_search = mstr_search_avx2;
+            mstr_ascii = mstr_ascii_avx2;
+            mstr_utf8_count = mstr_utf8_count_avx2;
+            mstr_utf8_check = mstr_utf8_valid_avx2;
+            mstr_utf8_cols = mstr_utf8_cols_avx2;
+            break;
+        case MSTR_SIMD_SSE2:
+            mstr_span = mstr_span_sse2;
+            mstr_case = mstr_case_sse2;
+            mstr_search = mstr_search_sse2;
+            mstr_ascii = mstr_ascii_sse2;
+            mstr_utf8_count = mstr_utf8_count_sse2;
+            mstr_utf8_check = mstr_utf8_valid_scalar;
+            mstr_utf8_cols = mstr_utf8_cols_scalar;
+            break;
+#endif
+        case MSTR_SIMD_SCALAR:
+            mstr_span = mstr_span_scalar;
+            mstr_case = mstr_case_scalar;
+            mstr_search = mstr_search_scalar;
+            mstr_ascii = mstr_ascii_scalar;
+            mstr_utf8_count = mstr_utf8_count_scalar;
+            mstr_utf8_check = mstr_utf8_valid_scalar;
+            mstr_utf8_cols = mstr_utf8_cols_scalar;
+            break;
+        default:
+            mstr_span = NULL;
+            mstr_case = mstr_case_ctype;
+            mstr_search = mstr_search_scalar;
+            mstr_ascii = mstr_ascii_byte;
+            mstr_utf8_count = mstr_utf8_count_byte;
+            mstr_utf8_check = mstr_utf8_valid_scalar;
+            mstr_utf8_cols = mstr_utf8_cols_scalar;
+            break;
+    }
+
+    mstr_simd = level;
+    return level;
+}
+
+DEF_SIMD_INIT(mstr_simd_set)
+
+int mstr_simd_level(void) {
+    return mstr_simd;
+}
+
+bool mstr_is_class(mstr* s, int cls);
+bool mstr_is_class(mstr* s, int cls) {
+    const unsigned char* p = (const unsigned char*)s->str;
+    size_t i = 0;
+
     if (s->len == 0) return false;
 
-    for (size_t i = 0; i < s->len; i++) {
-        if (!isspace(s->str[i])) return false;
+    if (mstr_simd_level() == MSTR_SIMD_NONE) {
+        for (i = 0; i < s->len; i++) {
+            if (!mstr_ctype_in(p[i], cls)) return false;
+        }
+        return true;
+    }
+
+    for (;;) {
+        i += mstr_span(p + i, s->len - i, cls);
+        if (i == s->len) return true;
+        // An ASCII byte outside the class or a byte the locale must decide
+        if (!(p[i] & 0x80) || !mstr_ctype_in(p[i], cls)) return false;
+        i++;
     }
-    return true;
+}
+
+bool mstr_is_alpha(mstr* s) { return mstr_is_class(s, MSTR_CLASS_ALPHA); }
+
+bool mstr_is_numeric(mstr* s) { return mstr_is_class(s, MSTR_CLASS_DIGIT); }
+
+bool mstr_is_alnum(mstr* s) { return mstr_is_class(s, MSTR_CLASS_ALNUM); }
+
+bool mstr_is_space(mstr* s) { return mstr_is_class(s, MSTR_CLASS_SPACE); }
+
+// UTF-8 ------------------------------------------------------------------
+
+bool mstr_utf8_valid(mstr* s) {
+    return mstr_utf8_check((const unsigned char*)s->str, s->len);
+}
+
+size_t mstr_utf8_len(mstr* s) {
+    return mstr_utf8_count((const unsigned char*)s->str, s->len);
+}
+
+size_t mstr_utf8_width(mstr* s) {
+    return mstr_utf8_cols((const unsigned char*)s->str, s->len);
+}
+
+// Search and replace ----------------------------------------------------
+
+int mstr_find_g(mstr* s, char* needle, size_t len, size_t start) {
+    const char* p;
+
+    if ((start > s->len) || (len > (s->len - start))) return -1;
+    if (len == 0) return (int)start;
+
+    if (len == 1) {
+        p = memchr(s->str + start, needle[0], s->len - start);
+    } else {
+        p = mstr_search(s->str + start, s->len - start, needle, len);
+    }
+
+    return (p != NULL) ? (int)(p - s->str) : -1;
+}
+
+int mstr_find(mstr* s, char* needle) {
+    return mstr_find_g(s, needle, strlen(needle), 0);
+}
+
+size_t mstr_find_all(mstr* s, char* needle, int* pos, size_t max) {
+    size_t len = strlen(needle);
+    size_t count = 0;
+    int idx;
+
+    if (len == 0) return 0;
+
+    for (idx = mstr_find_g(s, needle, len, 0); idx >= 0; idx = mstr_find_g(s, needle, len, idx + len)) {
+        if ((pos != NULL) && (count < max)) pos[count] = idx;
+        count++;
+    }
+    return count;
+}
+
+size_t mstr_replace(mstr* s, char* old, char* rep) {
+    size_t old_len = strlen(old);
+    size_t rep_len = strlen(rep);
+    size_t count, new_len, src, dst;
+    char* out;
+    int idx;
+
+    count = mstr_find_all(s, old, NULL, 0);
+    if (count == 0) return 0;
+
+    new_len = s->len - (count * old_len) + (count * rep_len);
+
+    // A result that is not longer can be written over the source from left
+    // to right, otherwise it is built in a new buffer of the final size.
+    if (rep_len <= old_len) {
+        out = s->str;
+    } else if (s->arena != NULL) {
+        out = (char*)marena_alloc(s->arena, mstr_calc_capacity(new_len));
+    } else {
+        out = (char*)malloc(mstr_calc_capacity(new_len));
+    }
+
+    src = 0;
+    dst = 0;
+    for (idx = mstr_find_g(s, old, old_len, 0); idx >= 0; idx = mstr_find_g(s, old, old_len, src)) {
+        memmove(out + dst, s->str + src, idx - src);
+        dst += idx - src;
+        memcpy(out + dst, rep, rep_len);
+        dst += rep_len;
+        src = idx + old_len;
+    }
+    memmove(out + dst, s->str + src, s->len - src);
+    out[new_len] = '\0';
+
+    if (out != s->str) {
+        mstr_free_str(s);
+        s->str = out;
+        s->capacity = mstr_calc_capacity(new_len);
+    }
+    s->len = new_len;
+
+    return count;
+}
+
+// Formatting ------------------------------------------------------------
+
+// Two ASCII digits for every value 0..99
+static const char mstr_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t mstr_pow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL};
+
+#define MSTR_FIXED_MAX_DECIMALS 18
+
+// Write decimal digits of v to out, zero padded to at least width digits,
+// and return the nr of digits written. out needs room for 20 digits or
+// width whichever is larger.
+size_t mstr_utoa(char* out, uint64_t v, int width);
+size_t mstr_utoa(char* out, uint64_t v, int width) {
+    char tmp[20];
+    char* p = tmp + sizeof(tmp);
+    size_t n, pad;
+
+    while (v >= 100) {
+        p -= 2;
+        memcpy(p, &mstr_digit_pairs[(v % 100) * 2], 2);
+        v /= 100;
+    }
+    if (v >= 10) {
+        p -= 2;
+        memcpy(p, &mstr_digit_pairs[v * 2], 2);
+    } else {
+        *--p = (char)('0' + v);
+    }
+
+    n = tmp + sizeof(tmp) - p;
+    pad = (width > 0 && (size_t)width > n) ? (size_t)width - n : 0;
+    memset(out, '0', pad);
+    memcpy(out + pad, p, n);
+    return pad + n;
+}
+
+// Make room for len more characters and return where they go
+char* mstr_tail(mstr* dst, size_t len);
+char* mstr_tail(mstr* dst, size_t len) {
+    mstr_assert_capacity(dst, dst->len + len);
+    return dst->str + dst->len;
+}
+
+void mstr_vappendf(mstr* dst, const char* fmt, va_list ap) {
+    char tmp[MSTR_FORMAT];
+    size_t capacity;
+    va_list retry;
+    char* out;
+    int n;
+
+    // Arguments may point into dst, which is left alone until they have
+    // been read. Short results go through the stack, longer ones are
+    // formatted again into a new buffer while the old one is intact.
+    va_copy(retry, ap);
+    n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    if ((n >= 0) && ((size_t)n < sizeof(tmp))) {
+        memcpy(mstr_tail(dst, n), tmp, n + 1);
+        dst->len += n;
+    } else if (n >= 0) {
+        capacity = mstr_calc_capacity(mstr_grow_capacity(dst->capacity, dst->len + n));
+        out = (dst->arena != NULL) ? (char*)marena_alloc(dst->arena, capacity) : (char*)malloc(capacity);
+        memcpy(out, dst->str, dst->len);
+        vsnprintf(out + dst->len, n + 1, fmt, retry);
+        mstr_free_str(dst);
+        dst->str = out;
+        dst->capacity = capacity;
+        dst->len += n;
+    }
+    va_end(retry);
+}
+
+void mstr_appendf(mstr* dst, const char* fmt, ...) {
+    va_list ap;
+
+    va_start(ap, fmt);
+    mstr_vappendf(dst, fmt, ap);
+    va_end(ap);
+}
+
+void mstr_append_uint(mstr* dst, uint64_t v) {
+    dst->len += mstr_utoa(mstr_tail(dst, 20), v, 0);
+    dst->str[dst->len] = '\0';
+}
+
+void mstr_append_int(mstr* dst, int64_t v) {
+    char* p = mstr_tail(dst, 21);
+    uint64_t u = (uint64_t)v;
+
+    if (v < 0) {
+        *p++ = '-';
+        u = 0 - u;
+        dst->len++;
+    }
+    dst->len += mstr_utoa(p, u, 0);
+    dst->str[dst->len] = '\0';
+}
+
+void mstr_append_hex(mstr* dst, uint64_t v, int width) {
+    static const char digits[] = "0123456789abcdef";
+    char tmp[16];
+    int n = 0;
+    char* p;
+
+    do {
+        tmp[n++] = digits[v & 0xf];
+        v >>= 4;
+    } while (v != 0);
+    if (width > n) {
+        p = mstr_tail(dst, width);
+        memset(p, '0', width - n);
+        p += width - n;
+        dst->len += width - n;
+    } else {
+        p = mstr_tail(dst, n);
+    }
+
+    dst->len += n;
+    while (n > 0) *p++ = tmp[--n];
+    dst->str[dst->len] = '\0';
+}
+
+void mstr_append_fixed(mstr* dst, double v, int decimals) {
+    double scaled, frac;
+    uint64_t u, ip, fp;
+    char* p;
+
+    if (decimals < 0) decimals = 0;
+
+    scaled = ((v < 0) ? -v : v) * (double)mstr_pow10[(decimals > MSTR_FIXED_MAX_DECIMALS) ? 0 : decimals];
+
+    // NaN, infinity and values that do not fit in 64 bits once scaled are
+    // left to printf.
+    if ((decimals > MSTR_FIXED_MAX_DECIMALS) || !(scaled < 18446744073709549568.0)) {
+        mstr_appendf(dst, "%.*f", decimals, v);
+        return;
+    }
+
+    // Round to nearest, ties to even like printf
+    u = (uint64_t)scaled;
+    frac = scaled - (double)u;
+    if ((frac > 0.5) || ((frac == 0.5) && (u & 1))) u++;
+
+    ip = u / mstr_pow10[decimals];
+    fp = u % mstr_pow10[decimals];
+
+    p = mstr_tail(dst, 22 + decimals);
+    if ((v < 0) && (u != 0)) {
+        *p++ = '-';
+        dst->len++;
+    }
+    p += mstr_utoa(p, ip, 0);
+    if (decimals > 0) {
+        *p++ = '.';
+        p += mstr_utoa(p, fp, decimals);
+    }
+    dst->len = p - dst->str;
+    *p = '\0';
 }
 
 bool mstr_is_empty(mstr* s) {
@@ -265,15 +1366,11 @@ bool mstr_is_null_terminated(mstr* str) {
 }
 
 void mstr_upper(mstr* s) {
-    for (size_t i = 0; i < s->len; i++) {
-        s->str[i] = toupper(s->str[i]);
-    }
+    mstr_case((unsigned char*)s->str, s->len, true);
 }
 
 void mstr_lower(mstr* s) {
-    for (size_t i = 0; i < s->len; i++) {
-        s->str[i] = tolower(s->str[i]);
-    }
+    mstr_case((unsigned char*)s->str, s->len, false);
 }
 
 void mstr_print(mstr* s) {
@@ -10,8 +10,20 @@
  *
  *---------------------------------------------------------------------------
  *
- * @todo
- * Convert mstr_new to a one malloc function by moving *str to last pos in struct
+ * A mstr is allocated as one block, the header followed by the character
+ * storage. str points into the block until the string outgrows it, then
+ * the characters are moved to a separate heap buffer that is grown with
+ * realloc.
+ *
+ * Short strings can also live without any heap allocation in a mstr_sso,
+ * which embeds MSTR_SSO bytes of storage directly after the header, room
+ * for MSTR_SSO - 1 characters and the terminator. It is set up with
+ * mstr_init() and released with mstr_release().
+ *
+ * A mstr created with mstr_new_a() lives in an arena, see marena.h. Both
+ * header and characters are carved from the arena, growing extends the
+ * block in place when possible, and the memory is released by resetting
+ * the arena rather than by mstr_free().
  */
 
 #pragma once
@@ -19,20 +31,67 @@
 #define MSTR_SIZE 1024
 #define MSTR_BLOCK 8
 #define MSTR_EXTRA 4
+#define MSTR_SSO 24
+#define MSTR_FORMAT 256  // Longest mstr_appendf() result formatted on the stack
+
+// Growth policy, a growing string gets its capacity multiplied by
+// MSTR_GROWTH_NUM / MSTR_GROWTH_DEN but never by more than MSTR_GROWTH_MAX
+// bytes in one step.
+#ifndef MSTR_GROWTH_NUM
+#define MSTR_GROWTH_NUM 2
+#endif
+#ifndef MSTR_GROWTH_DEN
+#define MSTR_GROWTH_DEN 1
+#endif
+#ifndef MSTR_GROWTH_MAX
+#define MSTR_GROWTH_MAX (64 * 1024 * 1024)
+#endif
+
+// Implementations of classification and case conversion, the best one
+// supported by the CPU is selected when the program is loaded. Selecting
+// another with mstr_simd_set() must not race with other threads.
+#define MSTR_SIMD_NONE   0  // Per byte ctype functions
+#define MSTR_SIMD_SCALAR 1  // Per byte ASCII ranges
+#define MSTR_SIMD_SSE2   2  // 16 bytes per iteration
+#define MSTR_SIMD_AVX2   3  // 32 bytes per iteration
 
+#include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "marena.h"
 
 #ifdef __cplusplus
 extern "C"
 #endif
 
 
+// The inline storage of a mstr is the memory directly after the header,
+// allocated together with it. str points there until the string grows.
 typedef struct mstr_t {
-    char *str;
+    char *str;        // Points to inline storage or to a heap buffer when grown
     size_t capacity;
     size_t len;
+    marena *arena;    // Arena holding the string, NULL when on the heap
 } mstr;
 
+// Set of characters, one bit per byte value. Build once with
+// mstr_charset_init() and reuse it for any number of strip operations.
+typedef struct mstr_charset_t {
+    uint8_t bits[32];
+} mstr_charset;
+
+static inline bool mstr_charset_has(const mstr_charset *cs, char ch) {
+    unsigned char c = (unsigned char)ch;
+    return (cs->bits[c >> 3] >> (c & 7)) & 1;
+}
+
+typedef struct mstr_sso_t {
+    mstr s;
+    char sso[MSTR_SSO]; // Inline storage when the mstr is not heap allocated
+} mstr_sso;
+
 #define mstr_new(SRC) _Generic((SRC), \
     char *: mstr_newc,                \
     int: mstr_newl,                   \
@@ -42,8 +101,15 @@ mstr *mstr_new_g(size_t required_capacity, char *src);
 mstr *mstr_newc(char *str);
 mstr *mstr_news(mstr *mstr);
 mstr *mstr_newl(size_t size);
+mstr *mstr_new_a(marena *a, size_t required_capacity, char *src);
+
+mstr *mstr_init(mstr_sso *sso, char *src);
+void mstr_release(mstr *s);
+bool mstr_is_inline(mstr *s);
 
 void mstr_clear(mstr *s);
+void mstr_reserve(mstr *s, size_t capacity);
+void mstr_shrink_to_fit(mstr *s);
 
 #define mstr_append(DST, SRC) _Generic((SRC), \
     char *: mstr_append_c,                    \
@@ -72,11 +138,33 @@ void mstr_insert_s(mstr *dst, mstr *src, int pos);
 
 void mstr_free(mstr *mstr);
 
-// void mstr_replace(mstr *s, char *old, char *new);
+// Formatted append. mstr_appendf() formats on the stack, or into a new
+// buffer of the final size for long results, so arguments may point into
+// dst itself, e.g. mstr_appendf(s, "%s", s->str). The numeric appends do not depend on the
+// locale and are several times faster than printf. mstr_append_fixed()
+// rounds the value scaled by 10^decimals, which can differ from printf in
+// the last digit when the scaling is inexact, and does not print a sign
+// for values that round to zero.
+void mstr_appendf(mstr *dst, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+void mstr_vappendf(mstr *dst, const char *fmt, va_list ap);
+void mstr_append_int(mstr *dst, int64_t v);
+void mstr_append_uint(mstr *dst, uint64_t v);
+void mstr_append_hex(mstr *dst, uint64_t v, int width);
+void mstr_append_fixed(mstr *dst, double v, int decimals);
+
+int mstr_find_g(mstr *s, char *needle, size_t len, size_t start);
+int mstr_find(mstr *s, char *needle);
+size_t mstr_find_all(mstr *s, char *needle, int *pos, size_t max);
+size_t mstr_replace(mstr *s, char *old, char *rep);
+
+void mstr_charset_init(mstr_charset *cs, char *chars);
 
 void mstr_rstrip(mstr *s, char *st);
 void mstr_lstrip(mstr *s, char *st);
 void mstr_strip(mstr *s, char *st);
+void mstr_rstrip_set(mstr *s, mstr_charset *cs);
+void mstr_lstrip_set(mstr *s, mstr_charset *cs);
+void mstr_strip_set(mstr *s, mstr_charset *cs);
 
 size_t mstr_len(mstr *s);
 
@@ -90,6 +178,17 @@ bool mstr_startwidth(mstr *s, char *start);
 void mstr_upper(mstr *s);
 void mstr_lower(mstr *s);
 
+// UTF-8. mstr_utf8_len() counts code points and mstr_utf8_width() the
+// terminal columns they take, wide East Asian characters and emoji take
+// two, combining marks none and everything else one. Both assume valid
+// UTF-8, check with mstr_utf8_valid() first if in doubt.
+bool mstr_utf8_valid(mstr *s);
+size_t mstr_utf8_len(mstr *s);
+size_t mstr_utf8_width(mstr *s);
+
+int mstr_simd_level(void);
+int mstr_simd_set(int level);
+
 void mstr_print(mstr *s);
 
 #ifdef __cplusplus
@@ -0,0 +1,134 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Non-owning string views over mstr and raw buffers.
+ *
+ * @file     mview.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <string.h>
+
+#include "mview.h"
+
+// Code -------------------------------------------------------------------
+
+mview mview_g(const char *ptr, size_t len) {
+    mview v = {ptr, len};
+    return v;
+}
+
+mview mview_c(const char *str) {
+    return mview_g(str, strlen(str));
+}
+
+mview mview_s(mstr *s) {
+    return mview_g(s->str, s->len);
+}
+
+mview mview_sub(mview v, size_t pos, size_t len) {
+    if (pos > v.len) pos = v.len;
+    if (len > (v.len - pos)) len = v.len - pos;
+
+    return mview_g(v.ptr + pos, len);
+}
+
+bool mview_split(mview *rest, char delim, mview *field) {
+    const char *p;
+
+    if (rest->ptr == NULL) return false;
+
+    p = memchr(rest->ptr, delim, rest->len);
+    if (p == NULL) {
+        *field = *rest;
+        rest->ptr = NULL;
+        rest->len = 0;
+        return true;
+    }
+
+    *field = mview_g(rest->ptr, p - rest->ptr);
+    rest->len -= field->len + 1;
+    rest->ptr = p + 1;
+    return true;
+}
+
+bool mview_tokenize(mview *rest, mstr_charset *delims, mview *token) {
+    size_t i = 0;
+
+    *rest = mview_trim_start(*rest, delims);
+    if (rest->len == 0) return false;
+
+    while ((i < rest->len) && !mstr_charset_has(delims, rest->ptr[i])) i++;
+
+    *token = mview_g(rest->ptr, i);
+    rest->ptr += i;
+    rest->len -= i;
+    return true;
+}
+
+mview mview_trim_start(mview v, mstr_charset *cs) {
+    while ((v.len > 0) && mstr_charset_has(cs, v.ptr[0])) {
+        v.ptr++;
+        v.len--;
+    }
+    return v;
+}
+
+mview mview_trim_end(mview v, mstr_charset *cs) {
+    while ((v.len > 0) && mstr_charset_has(cs, v.ptr[v.len - 1])) v.len--;
+    return v;
+}
+
+mview mview_trim(mview v, mstr_charset *cs) {
+    return mview_trim_end(mview_trim_start(v, cs), cs);
+}
+
+int mview_cmp(mview a, mview b) {
+    size_t len = (a.len < b.len) ? a.len : b.len;
+    int res = (len > 0) ? memcmp(a.ptr, b.ptr, len) : 0;
+
+    if (res != 0) return res;
+    if (a.len == b.len) return 0;
+    return (a.len < b.len) ? -1 : 1;
+}
+
+bool mview_eq(mview a, mview b) {
+    if (a.len != b.len) return false;
+    if (a.len == 0) return true;
+    return memcmp(a.ptr, b.ptr, a.len) == 0;
+}
+
+bool mview_eq_c(mview v, const char *str) {
+    return mview_eq(v, mview_c(str));
+}
+
+bool mview_startswith(mview v, mview prefix) {
+    if (prefix.len > v.len) return false;
+    if (prefix.len == 0) return true;
+    return memcmp(v.ptr, prefix.ptr, prefix.len) == 0;
+}
+
+int mview_find_c(mview v, char ch) {
+    const char *p;
+
+    if (v.len == 0) return -1;
+    p = memchr(v.ptr, ch, v.len);
+    return (p != NULL) ? (int)(p - v.ptr) : -1;
+}
+
+mstr *mview_to_mstr(mview v) {
+    mstr *s = mstr_newl(v.len);
+
+    mview_append(s, v);
+    return s;
+}
+
+void mview_append(mstr *dst, mview v) {
+    mstr_append_g(dst, (char *)v.ptr, v.len);
+}
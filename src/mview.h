@@ -0,0 +1,197 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Non-owning string views over mstr and raw buffers.
+ *
+ * @file     mview.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * A mview is a pointer and a length referring to characters owned by
+ * someone else, a mstr, a C string or any buffer. Views are passed by
+ * value and never allocate, so splitting, trimming and comparing text
+ * does not copy it. A view is only valid as long as the text it refers to
+ * is not modified or freed, growing a mstr may move its characters.
+ * Views are not null terminated.
+ */
+
+#ifndef MVIEW_H
+#define MVIEW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "mstr.h"
+
+// Macros -----------------------------------------------------------------
+
+#define mview_new(SRC) _Generic((SRC), \
+    char *: mview_c,                   \
+    mstr *: mview_s)(SRC)
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    const char *ptr;
+    size_t len;
+} mview;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * View of a buffer.
+ *
+ * @param ptr first character
+ * @param len nr of characters
+ * @return view
+ */
+mview mview_g(const char *ptr, size_t len);
+
+/**
+ * View of a null terminated string.
+ *
+ * @param str string
+ * @return view
+ */
+mview mview_c(const char *str);
+
+/**
+ * View of the current contents of a mstr.
+ *
+ * @param s string
+ * @return view
+ */
+mview mview_s(mstr *s);
+
+/**
+ * Part of a view, position and length are clamped to the view.
+ *
+ * @param v view
+ * @param pos first character
+ * @param len nr of characters
+ * @return view
+ */
+mview mview_sub(mview v, size_t pos, size_t len);
+
+/**
+ * Split off the next field separated by delim. Consecutive delimiters
+ * give empty fields, like strsep().
+ *
+ * @param rest text left to split, advanced past the field and delimiter
+ * @param delim field delimiter
+ * @param field the field found
+ * @return false when rest is exhausted
+ */
+bool mview_split(mview *rest, char delim, mview *field);
+
+/**
+ * Split off the next token, skipping any run of delimiters.
+ *
+ * @param rest text left to tokenize, advanced past the token
+ * @param delims set of delimiters
+ * @param token the token found
+ * @return false when no token is left
+ */
+bool mview_tokenize(mview *rest, mstr_charset *delims, mview *token);
+
+/**
+ * Remove characters in set from both ends.
+ *
+ * @param v view
+ * @param cs set of characters to remove
+ * @return trimmed view
+ */
+mview mview_trim(mview v, mstr_charset *cs);
+
+/**
+ * Remove characters in set from the start.
+ *
+ * @param v view
+ * @param cs set of characters to remove
+ * @return trimmed view
+ */
+mview mview_trim_start(mview v, mstr_charset *cs);
+
+/**
+ * Remove characters in set from the end.
+ *
+ * @param v view
+ * @param cs set of characters to remove
+ * @return trimmed view
+ */
+mview mview_trim_end(mview v, mstr_charset *cs);
+
+/**
+ * Compare two views bytewise, a shorter view sorts first on a common prefix.
+ *
+ * @param a first view
+ * @param b second view
+ * @return <0, 0 or >0 like strcmp
+ */
+int mview_cmp(mview a, mview b);
+
+/**
+ * Check if two views have the same contents.
+ *
+ * @param a first view
+ * @param b second view
+ * @return true if equal
+ */
+bool mview_eq(mview a, mview b);
+
+/**
+ * Check if view equals a null terminated string.
+ *
+ * @param v view
+ * @param str string
+ * @return true if equal
+ */
+bool mview_eq_c(mview v, const char *str);
+
+/**
+ * Check if view starts with prefix.
+ *
+ * @param v view
+ * @param prefix prefix
+ * @return true if v starts with prefix
+ */
+bool mview_startswith(mview v, mview prefix);
+
+/**
+ * Find first occurrence of a character.
+ *
+ * @param v view
+ * @param ch character to find
+ * @return -1 if not found, >=0 position in view
+ */
+int mview_find_c(mview v, char ch);
+
+/**
+ * Copy view to a new mstr.
+ *
+ * @param v view
+ * @return new mstr
+ */
+mstr *mview_to_mstr(mview v);
+
+/**
+ * Append view to a mstr.
+ *
+ * @param dst string to append to
+ * @param v view
+ */
+void mview_append(mstr *dst, mview v);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
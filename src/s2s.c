@@ -14,127 +14,254 @@
 
 #include "def.h"
 #include "s2s.h"
+#include "dbinfo.h"
+#include "dbvalue.h"
 
+// Macros -----------------------------------------------------------------
 
-// Code -------------------------------------------------------------------
+#define S2S_BATCH 16  // Binary searches run side by side by S2S_searchKeys()
+
+// Typedefs ---------------------------------------------------------------
 
-S2S *S2S_new(int size) {
-    S2S *db;
+// Entry of the key index of a frozen table. The 8 characters following
+// the prefix all keys share, as a big endian number, order the same way
+// as strncmp and mostly settle a comparison without touching the table.
+typedef struct {
+    uint64_t prefix;
+    const char *tail;   // Key after the shared prefix
+    int pos;
+    int max;            // Characters of tail within S2S_STRLEN
+} S2S_sorted;
 
-    db = malloc((size + 1) * sizeof(S2S));
+typedef struct {
+    char stem[S2S_STRLEN];  // A key starting with the shared prefix
+    int skip;               // Length of the shared prefix
+    int len;                // nr of keys, removed elements are left out
+    S2S_sorted keys[];
+} S2S_index;
 
-    db[size].key[0] = '\0';
-    db[size].value[0] = '\0';
+// Code -------------------------------------------------------------------
 
-    return db;
+static uint32_t S2S_valueHash(const char *value) {
+    return dbvalue_hash(value, strnlen(value, S2S_STRLEN));
 }
 
-S2S *S2S_copy(S2S *db) {
-    S2S *dst;
-    int len;
+static uint64_t S2S_prefix(const char *key, int max) {
+    uint64_t p = 0;
+    int i;
 
-    len = S2S_len(db);
-    dst = S2S_new(len);
-    memcpy(dst, db, len * sizeof(S2S));
+    for (i = 0; (i < 8) && (i < max) && key[i]; i++) {
+        p = (p << 8) | (unsigned char)key[i];
+    }
+    return (i == 0) ? 0 : p << (8 * (8 - i));
+}
 
-    return dst;
+// Compare index entry with key tail, keys equal in the prefix and longer
+// than it continue with strncmp. Removing an element overwrites the
+// start of its key only, the part read here is left as it was.
+static int S2S_sortedKeyCmp(const S2S_sorted *x, uint64_t prefix, const char *tail) {
+    if (x->prefix != prefix) {
+        return (x->prefix < prefix) ? -1 : 1;
+    }
+    if (((prefix & 0xff) == 0) || (x->max <= 8)) {
+        return 0;
+    }
+    return strncmp(x->tail + 8, tail + 8, x->max - 8);
 }
 
-void S2S_free(S2S *db) {
-    free(db);
+// Order by key, equal keys by position so the first one is found
+static int S2S_sortedCmp(const void *a, const void *b) {
+    const S2S_sorted *x = a;
+    const S2S_sorted *y = b;
+    int c;
+
+    c = S2S_sortedKeyCmp(x, y->prefix, y->tail);
+    return c ? c : x->pos - y->pos;
 }
 
-int S2S_findKey(S2S *db, char *key) {
-    int i = 0;
+// First index entry not below key tail
+static inline S2S_sorted *S2S_lower(S2S_index *ix, uint64_t prefix, const char *tail) {
+    S2S_sorted *base = ix->keys;
+    int n = ix->len;
+    int half;
 
-    while (strncmp(db[i].key, S2S_LAST, 6)) {
-        //    DEBUGPRINT("%d\n",i);
-        if (!strncmp(db[i].key, key, S2S_STRLEN)) {
-            //         DEBUGPRINT("%d\n",i);
-            return i;
-        }
+    if (n == 0) {
+        return base;
+    }
 
-        i++;
+    while (n > 1) {
+        half = n / 2;
+        base = (S2S_sortedKeyCmp(&base[half], prefix, tail) < 0) ? &base[half] : base;
+        n -= half;
     }
+    return base + (S2S_sortedKeyCmp(base, prefix, tail) < 0);
+}
 
+// Position of the first entry from e equal to key tail and not removed
+static inline int S2S_live(S2S_index *ix, S2S_sorted *e, uint64_t prefix, const char *tail) {
+    for (; (e < ix->keys + ix->len) && !S2S_sortedKeyCmp(e, prefix, tail); e++) {
+        if (e->pos >= 0) return e->pos;
+    }
     return -1;
 }
 
-int S2S_findValue(S2S *db, char *value) {
-    int i = 0;
+static int S2S_search(S2S_index *ix, const char *key) {
+    uint64_t prefix;
 
-    //      while (db[i].key != S2S_LAST) {
-    while (strncmp(db[i].key, S2S_LAST, 6)) {
-        if (!strncmp(db[i].value, value, S2S_STRLEN)) {
-            return i;
-        }
-
-        i++;
+    if (strncmp(key, ix->stem, ix->skip)) {
+        return -1;
     }
 
-    return -1;
+    key += ix->skip;
+    prefix = S2S_prefix(key, S2S_STRLEN - ix->skip);
+    return S2S_live(ix, S2S_lower(ix, prefix, key), prefix, key);
 }
 
-char *S2S_getValue(S2S *db, char *key) {
-    int idx = 0;
+// Mark the entry of the element at pos removed
+static void S2S_unindex(S2S_index *ix, const char *key, int pos) {
+    uint64_t prefix;
+    S2S_sorted *e;
 
-    idx = S2S_findKey(db, key);
+    if (strncmp(key, ix->stem, ix->skip)) {
+        return;
+    }
 
-    if (idx != -1) {
-        return db[idx].value;
-    } else {
-        return NULL;
+    key += ix->skip;
+    prefix = S2S_prefix(key, S2S_STRLEN - ix->skip);
+    for (e = S2S_lower(ix, prefix, key); (e < ix->keys + ix->len) && !S2S_sortedKeyCmp(e, prefix, key); e++) {
+        if (e->pos == pos) {
+            e->pos = -1;
+            return;
+        }
     }
 }
 
-void S2S_setValue(S2S *db, char *key, char *value) {
-    int idx = 0;
+// Lower bounds of up to S2S_BATCH keys, one step of each search in turn
+// with the index entries the next step may compare prefetched, see
+// dbkeys_findKeys()
+static void S2S_searchBatch(S2S_index *ix, char **keys, int n, int *pos) {
+    S2S_sorted *base[S2S_BATCH];
+    const char *tail[S2S_BATCH];
+    uint64_t prefix[S2S_BATCH];
+    int m = ix->len;
+    int half;
+    int next;
+
+    for (int i = 0; i < n; i++) {
+        base[i] = ix->keys;
+        tail[i] = keys[i] + ix->skip;
+        prefix[i] = strncmp(keys[i], ix->stem, ix->skip) ? 0 : S2S_prefix(tail[i], S2S_STRLEN - ix->skip);
+    }
 
-    idx = S2S_findKey(db, key);
+    while (m > 1) {
+        half = m / 2;
+        next = (m - half) / 2;
+        for (int i = 0; i < n; i++) {
+            base[i] = (S2S_sortedKeyCmp(&base[i][half], prefix[i], tail[i]) < 0) ? &base[i][half] : base[i];
+            __builtin_prefetch(&base[i][next]);
+            __builtin_prefetch(&base[i][half + next]);
+        }
+        m -= half;
+    }
 
-    if (idx != -1) {
-        strncpy(db[idx].value, value, S2S_STRLEN);
+    for (int i = 0; i < n; i++) {
+        if (strncmp(keys[i], ix->stem, ix->skip)) {
+            pos[i] = -1;
+        } else {
+            base[i] += (S2S_sortedKeyCmp(base[i], prefix[i], tail[i]) < 0);
+            pos[i] = S2S_live(ix, base[i], prefix[i], tail[i]);
+        }
     }
 }
 
-void S2S_setKeyValue(S2S *db, int idx, char *key, char *value) {
+static int S2S_searchKeys(S2S_index *ix, char **keys, int n, int *pos) {
+    int found = 0;
 
-    if (isWithin(idx, 0, S2S_len(db) - 1)) {
-        strncpy(db[idx].key, key, S2S_STRLEN);
-        strncpy(db[idx].value, value, S2S_STRLEN);
+    if (ix->len == 0) {
+        for (int i = 0; i < n; i++) pos[i] = -1;
+        return 0;
     }
-}
 
+    for (int i = 0; i < n; i += S2S_BATCH) {
+        S2S_searchBatch(ix, keys + i, (n - i < S2S_BATCH) ? n - i : S2S_BATCH, pos + i);
+    }
+    for (int i = 0; i < n; i++) found += (pos[i] >= 0);
+    return found;
+}
 
-int S2S_len(S2S *db) {
-    int i = 0;
+#define DBT_PREFIX S2S
+#define DBT_TYPE S2S
+#define DBT_KEY char *
+#define DBT_VAL char *
+#define DBT_GET char *
+#define DBT_NONE NULL
+#define DBT_IS_LAST(e) !strncmp((e)->key, S2S_LAST, 6)
+#define DBT_SET_LAST(e) strcpy((e)->key, S2S_LAST)
+#define DBT_KEY_EQ(e, k) !strncmp((e)->key, (k), S2S_STRLEN)
+#define DBT_VAL_EQ(e, v) !strncmp((e)->value, (v), S2S_STRLEN)
+#define DBT_KEY_SET(e, k) strncpy((e)->key, (k), S2S_STRLEN)
+#define DBT_VAL_SET(e, v) strncpy((e)->value, (v), S2S_STRLEN)
+#define DBT_VAL_HASH(v) S2S_valueHash(v)
+#define DBT_PRINT(e) printf("%20s   %s\n", (e)->key, (e)->value)
+#define DBT_FIND_FROZEN(info, k) S2S_search((info)->keys, k)
+#define DBT_FIND_FROZEN_N(info, keys, n, idx) S2S_searchKeys((info)->keys, keys, n, idx)
+#define DBT_REMOVE_FROZEN(info, e, idx) S2S_unindex((info)->keys, (e)->key, idx)
+#define DBT_FREEZE(db) S2S_freeze(db)
+#include "dbtable.h"
+
+void S2S_freeze(S2S *db) {
+    dbinfo *info = dbinfo_get(db);
+    const char *stem = NULL;
+    S2S_sorted *e;
+    S2S_index *ix;
+    int skip = 0;
+    int len;
+    int j;
 
-    while (strncmp(db[i].key, S2S_LAST, 6)) {
-        i++;
+    if (info == NULL) {
+        return;
     }
+    dbinfo_thaw(info);
+    len = info->len;
 
-    //    while (db[i].key != S2S_LAST) {
-    //        i++;
-    //    }
+    // Removed elements are left out of the index and the shared prefix
+    for (int i = 0; i < len; i++) {
+        if (dbinfo_removed(info, i)) continue;
 
-    return i;
-}
+        if (stem == NULL) {
+            stem = db[i].key;
+            skip = strnlen(stem, S2S_STRLEN);
+        }
+        for (j = 0; (j < skip) && (db[i].key[j] == stem[j]); j++) {
+        }
+        skip = j;
+    }
 
-int S2S_last(S2S *db) {
-    return S2S_len(db) - 1;
-}
+    ix = malloc(sizeof(S2S_index) + (len + 1) * sizeof(S2S_sorted));
+    memset(ix->stem, 0, S2S_STRLEN);
+    if (stem != NULL) memcpy(ix->stem, stem, S2S_STRLEN);
+    ix->skip = skip;
+    ix->len = 0;
+    for (int i = 0; i < len; i++) {
+        if (dbinfo_removed(info, i)) continue;
+
+        e = &ix->keys[ix->len++];
+        e->tail = db[i].key + skip;
+        e->max = S2S_STRLEN - skip;
+        e->prefix = S2S_prefix(e->tail, e->max);
+        e->pos = i;
+    }
+    qsort(ix->keys, ix->len, sizeof(S2S_sorted), S2S_sortedCmp);
 
-int S2S_first(S2S *db) {
-    UNUSED(db);
-    return 0;
+    dbinfo_freeze(info, ix);
 }
 
-void S2S_printDb(S2S *db) {
-    int i;
+void S2S_thaw(S2S *db) {
+    dbinfo *info = dbinfo_get(db);
 
-    for (i = 0; i < S2S_len(db); i++) {
-        printf("%20s   %s\n", db[i].key, db[i].value);
+    if (info == NULL) {
+        return;
     }
-}
-
 
+    dbinfo_thaw(info);
+}
@@ -19,6 +19,9 @@ extern "C" {
 
 // Includes ---------------------------------------------------------------
 
+#include <stdbool.h>
+#include <stddef.h>
+
 // Macros -----------------------------------------------------------------
 
 #define S2S_STRLEN 32
@@ -54,12 +57,46 @@ S2S *S2S_new(int size);
 S2S *S2S_copy(S2S *db);
 
 /**
- * Deallocate database.
+ * Deallocate database. Tables from S2S_new(), S2S_copy() and S2S_build()
+ * are released with this rather than free(), which would leave their
+ * indexes behind.
  *
  * @param db database to deallocate
  */
 void S2S_free(S2S *db);
 
+/**
+ * Register a table not allocated by the library, e.g. a static table or
+ * one on the stack, so that it can be indexed and S2S_removeKey() can
+ * leave removed elements in place. Tables are known by address,
+ * unregister the table with S2S_unregister() before its storage is
+ * reused or goes out of scope. Registering a table twice does nothing.
+ *
+ * @param db database to register
+ */
+void S2S_register(S2S *db);
+
+/**
+ * Unregister a table registered by S2S_register(). Its indexes are
+ * dropped and elements removed by S2S_removeKey() are compacted away.
+ * Tables from S2S_new() are left to S2S_free().
+ *
+ * @param db database to unregister
+ */
+void S2S_unregister(S2S *db);
+
+/**
+ * Create database from arrays of keys and values, and freeze it (see
+ * S2S_freeze()). One pass over the arrays and one sort of the keys,
+ * instead of a S2S_setKeyValue() per element.
+ *
+ * @param keys key of each element
+ * @param values value of each element
+ * @param len nr of elements
+ * @return pointer to db
+ */
+S2S *S2S_build(char **keys, char **values, int len);
+
 /**
  * Find index of key in database.
  *
@@ -69,6 +106,20 @@ void S2S_free(S2S *db);
  */
 int S2S_findKey(S2S *db, char *key);
 
+/**
+ * Find index of each of an array of keys. Searches of a frozen database
+ * are interleaved and prefetch the index. A database that is not frozen
+ * is scanned for each key and not changed, freeze it with S2S_freeze()
+ * first to look up large batches.
+ *
+ * @param db database to search
+ * @param keys keys to be found in database
+ * @param n nr of keys
+ * @param idx index of each key in db, -1 if not found
+ * @return nr of keys found
+ */
+int S2S_findKeys(S2S *db, char **keys, int n, int *idx);
+
 /**
  * Find index of value in database.
  *
@@ -86,6 +137,17 @@ int S2S_findValue(S2S *db, char *value);
  */
 char *S2S_getValue(S2S *db, char *key);
 
+/**
+ * Get the values of an array of keys, see S2S_findKeys().
+ *
+ * @param db database to search
+ * @param keys keys to find
+ * @param n nr of keys
+ * @param values value of each key, NULL if not found
+ * @return nr of keys found
+ */
+int S2S_getValues(S2S *db, char **keys, int n, char **values);
+
 /**
  * Set value to corresponding key in database
  * @param db database to set value in
@@ -104,6 +166,99 @@ void S2S_setValue(S2S *db, char *key, char *value);
 void S2S_setKeyValue(S2S *db, int idx, char *key, char *value);
 
 
+/**
+ * Append element, growing the table. Tables not created by S2S_new()
+ * or S2S_copy() (e.g. static tables) are first copied, so always
+ * continue with the returned table.
+ *
+ * @param db database to append to
+ * @param key new key
+ * @param value new value
+ * @return database, possibly moved
+ */
+S2S *S2S_append(S2S *db, char *key, char *value);
+
+/**
+ * Remove element, later elements move down one index.
+ *
+ * @param db database to remove from
+ * @param idx index of element to remove
+ */
+void S2S_remove(S2S *db, int idx);
+
+/**
+ * Remove the first element with key. The element is left in place and
+ * marked removed, see S2S_isRemoved(), no lookup finds it and positions
+ * and indexes stay valid. When more than a quarter of the elements are
+ * removed the database is compacted, see S2S_compact(). In a table that is
+ * not registered, see S2S_register(), later elements move down as by
+ * S2S_remove() instead.
+ *
+ * @param db database to remove from
+ * @param key key of element to remove
+ * @return 0 if removed, -1 if key not found
+ */
+int S2S_removeKey(S2S *db, char *key);
+
+/**
+ * Check if an element was removed by S2S_removeKey(). It keeps its key
+ * and value until the database is compacted, code reading the array
+ * directly should skip it.
+ *
+ * @param db database
+ * @param idx index of element
+ * @return true if removed
+ */
+bool S2S_isRemoved(S2S *db, int idx);
+
+/**
+ * Drop elements removed by S2S_removeKey(), later elements move down,
+ * and rebuild the indexes of the database.
+ *
+ * @param db database to compact
+ * @return nr of elements dropped
+ */
+int S2S_compact(S2S *db);
+
+/**
+ * Freeze database for fast key lookup. A side index of the keys in sorted
+ * order is built, after which S2S_findKey(), S2S_getValue() and
+ * S2S_setValue() use binary search. Static tables are indexed once
+ * registered, see S2S_register(), the table itself is not reordered.
+ * Changing keys through S2S_setKeyValue(), S2S_append() or S2S_remove()
+ * drops the index, S2S_removeKey() keeps it.
+ *
+ * @param db database to freeze
+ */
+void S2S_freeze(S2S *db);
+
+/**
+ * Drop the index built by S2S_freeze().
+ *
+ * @param db database to thaw
+ */
+void S2S_thaw(S2S *db);
+
+/**
+ * Index values for fast S2S_findValue(). A hash index of the values is
+ * built and kept up to date by S2S_setValue(), S2S_setKeyValue(),
+ * S2S_append() and S2S_remove(), values written to the table directly are
+ * not seen. Static tables must be registered first, see S2S_register(),
+ * else nothing is done. S2S_append() on those returns a copy without
+ * index. Costs 16 to 32 bytes per element.
+ *
+ * @param db database to index
+ * @return bytes used by the index
+ */
+size_t S2S_indexValues(S2S *db);
+
+/**
+ * Drop the index built by S2S_indexValues().
+ *
+ * @param db database
+ */
+void S2S_dropValues(S2S *db);
+
 /**
  * First element in database.
  *
@@ -121,7 +276,8 @@ int S2S_first(S2S *db);
 int S2S_last(S2S *db);
 
 /**
- * Length of database.
+ * Length of database. Tables created by S2S_new() or S2S_copy() keep
+ * their length, others are scanned for the sentinel.
  *
  * @param db database to be questioned
  * @return nr of elements in db
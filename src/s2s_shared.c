@@ -0,0 +1,200 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    S2S table shared between threads, read mostly.
+ *
+ * @file     s2s_shared.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Reader records are kept in a list shared by all shared tables. A
+ * thread claims a record on its first read and gives it back when it
+ * exits, records are never freed. Each record fills a cache line of its
+ * own so readers on different cores do not disturb each other.
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "s2s_shared.h"
+
+// Macros -----------------------------------------------------------------
+
+#define S2S_SHARED_LINE 64  // Cache line size
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct s2s_reader {
+    S2S *hazard[S2S_SHARED_NEST];  // Tables being read, NULL when unused
+    int depth;                     // nr of open read sections
+    int used;                      // Claimed by a thread
+    struct s2s_reader *next;
+} __attribute__((aligned(S2S_SHARED_LINE))) s2s_reader;
+
+// Prototypes -------------------------------------------------------------
+
+static void s2s_shared_init(void);
+static void s2s_shared_exit(void *rec);
+static s2s_reader *s2s_shared_self(void);
+static void s2s_shared_swap(s2s_shared *sh, S2S *db);
+
+// Variables --------------------------------------------------------------
+
+static s2s_reader *readers;
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+static pthread_key_t exitKey;  // Gives the record back when the thread exits
+static __thread s2s_reader *self;
+
+// Code -------------------------------------------------------------------
+
+static void s2s_shared_init(void) {
+    pthread_key_create(&exitKey, s2s_shared_exit);
+}
+
+static void s2s_shared_exit(void *rec) {
+    __atomic_store_n(&((s2s_reader *)rec)->used, 0, __ATOMIC_RELEASE);
+}
+
+// Record of calling thread, a free one is reused before a new is added
+static s2s_reader *s2s_shared_self(void) {
+    s2s_reader *r;
+    int unused;
+
+    if (self != NULL) return self;
+
+    pthread_once(&once, s2s_shared_init);
+
+    for (r = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); r != NULL; r = r->next) {
+        unused = 0;
+        if (__atomic_compare_exchange_n(&r->used, &unused, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) break;
+    }
+
+    if (r == NULL) {
+        r = (s2s_reader *)aligned_alloc(S2S_SHARED_LINE, sizeof(s2s_reader));
+        memset(r, 0, sizeof(s2s_reader));
+        r->used = 1;
+        r->next = __atomic_load_n(&readers, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&readers, &r->next, r, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+
+    pthread_setspecific(exitKey, r);
+    self = r;
+    return r;
+}
+
+// Publish db and free the replaced table once no reader holds it.
+// Writer lock held.
+static void s2s_shared_swap(s2s_shared *sh, S2S *db) {
+    S2S *old;
+
+    S2S_freeze(db);
+    old = __atomic_exchange_n(&sh->db, db, __ATOMIC_SEQ_CST);
+    sh->version++;
+
+    for (s2s_reader *r = __atomic_load_n(&readers, __ATOMIC_ACQUIRE); r != NULL; r = r->next) {
+        for (int i = 0; i < S2S_SHARED_NEST; i++) {
+            while (__atomic_load_n(&r->hazard[i], __ATOMIC_SEQ_CST) == old) sched_yield();
+        }
+    }
+
+    S2S_free(old);
+}
+
+s2s_shared *s2s_shared_new(S2S *db) {
+    s2s_shared *sh = (s2s_shared *)calloc(1, sizeof(s2s_shared));
+
+    pthread_mutex_init(&sh->lock, NULL);
+    sh->db = S2S_copy(db);
+    S2S_freeze(sh->db);
+
+    return sh;
+}
+
+void s2s_shared_free(s2s_shared *sh) {
+    if (sh == NULL) return;
+
+    S2S_free(sh->db);
+    pthread_mutex_destroy(&sh->lock);
+    free(sh);
+}
+
+S2S *s2s_shared_read(s2s_shared *sh) {
+    s2s_reader *r = s2s_shared_self();
+    S2S **hp;
+    S2S *db;
+
+    if (r->depth == S2S_SHARED_NEST) {
+        return NULL;
+    }
+    hp = &r->hazard[r->depth++];
+
+    // Announce the table, then check it is still current. A writer that
+    // replaced it meanwhile may not have seen the announcement.
+    do {
+        db = __atomic_load_n(&sh->db, __ATOMIC_ACQUIRE);
+        __atomic_store_n(hp, db, __ATOMIC_SEQ_CST);
+    } while (__atomic_load_n(&sh->db, __ATOMIC_SEQ_CST) != db);
+
+    return db;
+}
+
+void s2s_shared_done(s2s_shared *sh) {
+    s2s_reader *r = self;
+
+    (void)sh;
+    __atomic_store_n(&r->hazard[--r->depth], NULL, __ATOMIC_RELEASE);
+}
+
+bool s2s_shared_getValue(s2s_shared *sh, const char *key, char *value, size_t size) {
+    S2S *db = s2s_shared_read(sh);
+    size_t len;
+    int idx;
+
+    if (db == NULL) {
+        return false;
+    }
+
+    idx = S2S_findKey(db, (char *)key);
+    if ((idx >= 0) && (size > 0)) {
+        len = strnlen(db[idx].value, S2S_STRLEN);
+        len = (len < size) ? len : size - 1;
+        memcpy(value, db[idx].value, len);
+        value[len] = '\0';
+    }
+    s2s_shared_done(sh);
+
+    return idx >= 0;
+}
+
+S2S *s2s_shared_copy(s2s_shared *sh) {
+    S2S *db;
+
+    pthread_mutex_lock(&sh->lock);
+    db = S2S_copy(sh->db);
+    pthread_mutex_unlock(&sh->lock);
+
+    return db;
+}
+
+void s2s_shared_publish(s2s_shared *sh, S2S *db) {
+    pthread_mutex_lock(&sh->lock);
+    s2s_shared_swap(sh, db);
+    pthread_mutex_unlock(&sh->lock);
+}
+
+void s2s_shared_setValue(s2s_shared *sh, const char *key, const char *value) {
+    S2S *db;
+
+    pthread_mutex_lock(&sh->lock);
+    db = S2S_copy(sh->db);
+    S2S_setValue(db, (char *)key, (char *)value);
+    s2s_shared_swap(sh, db);
+    pthread_mutex_unlock(&sh->lock);
+}
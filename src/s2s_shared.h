@@ -0,0 +1,135 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    S2S table shared between threads, read mostly.
+ *
+ * @file     s2s_shared.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Readers never lock and never write to memory shared with other
+ * readers. A writer does not change the table readers see, it publishes
+ * a new table that replaces it as a whole:
+ *
+ *   db = s2s_shared_copy(sh);            (writer)
+ *   S2S_setValue(db, "level", "debug");
+ *   s2s_shared_publish(sh, db);
+ *
+ *   db = s2s_shared_read(sh);            (readers)
+ *   ... S2S_getValue(db, key) ...
+ *   s2s_shared_done(sh);
+ *
+ * Each thread announces the table it reads in a record of its own, a
+ * hazard pointer. The writer frees the replaced table once no record
+ * holds it, so publishing waits for readers still using it. Readers
+ * must keep their read sections short and not call s2s_shared_publish()
+ * inside one. Sections may be nested up to S2S_SHARED_NEST deep, a read
+ * beyond that fails. Link with -lpthread.
+ */
+
+#ifndef S2S_SHARED_H
+#define S2S_SHARED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "s2s.h"
+
+// Macros -----------------------------------------------------------------
+
+#define S2S_SHARED_NEST 4  // Read sections a thread may have open at once
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    S2S *db;                // Current table, frozen
+    pthread_mutex_t lock;   // Serializes writers
+    unsigned long version;  // nr of tables published
+} s2s_shared;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create a shared table.
+ *
+ * @param db first contents, copied
+ * @return pointer to shared table
+ */
+s2s_shared *s2s_shared_new(S2S *db);
+
+/**
+ * Deallocate shared table. No thread may still be reading it.
+ *
+ * @param sh shared table
+ */
+void s2s_shared_free(s2s_shared *sh);
+
+/**
+ * Start reading. The table returned stays valid and unchanged until
+ * s2s_shared_done(), it must not be modified.
+ *
+ * @param sh shared table
+ * @return current table, NULL if the thread already has S2S_SHARED_NEST
+ *         sections open, no section is started then
+ */
+S2S *s2s_shared_read(s2s_shared *sh);
+
+/**
+ * End reading started by the latest s2s_shared_read() of the thread.
+ *
+ * @param sh shared table
+ */
+void s2s_shared_done(s2s_shared *sh);
+
+/**
+ * Copy value of key out of the current table.
+ *
+ * @param sh shared table
+ * @param key key to find
+ * @param value buffer for value
+ * @param size size of buffer
+ * @return true if key was found
+ */
+bool s2s_shared_getValue(s2s_shared *sh, const char *key, char *value, size_t size);
+
+/**
+ * Private copy of the current table for a writer to change and publish.
+ *
+ * @param sh shared table
+ * @return copy, owned by the caller until published
+ */
+S2S *s2s_shared_copy(s2s_shared *sh);
+
+/**
+ * Replace the current table. db is frozen and taken over by the shared
+ * table. Returns once no reader uses the replaced table anymore, which
+ * is then freed.
+ *
+ * @param sh shared table
+ * @param db new table, from S2S_new(), S2S_copy() or s2s_shared_copy()
+ */
+void s2s_shared_publish(s2s_shared *sh, S2S *db);
+
+/**
+ * Set value of one key and publish the result.
+ *
+ * @param sh shared table
+ * @param key the key whos value to be set
+ * @param value new value
+ */
+void s2s_shared_setValue(s2s_shared *sh, const char *key, const char *value);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif
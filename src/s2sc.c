@@ -0,0 +1,289 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Compact string 2 string associative array.
+ *
+ * @file     s2sc.c
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ */
+
+// Includes ---------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "def.h"
+#include "s2sc.h"
+
+// Prototypes -------------------------------------------------------------
+
+static uint32_t S2SC_hash(const char *str);
+static bool S2SC_inHeap(S2SC *db, const char *str);
+static uint32_t S2SC_store(S2SC *db, const char *str, size_t len);
+static uint32_t S2SC_replace(S2SC *db, uint32_t old, const char *str);
+static void S2SC_drop(S2SC *db, uint32_t off);
+static void S2SC_compact(S2SC *db);
+static void S2SC_reserve(S2SC *db, int capacity);
+
+// Code -------------------------------------------------------------------
+
+// FNV-1a, 32 bit
+static uint32_t S2SC_hash(const char *str) {
+    uint32_t h = 2166136261u;
+
+    while (*str) {
+        h ^= (unsigned char)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool S2SC_inHeap(S2SC *db, const char *str) {
+    return ((uintptr_t)str - (uintptr_t)db->heap) < db->size;
+}
+
+// Copy len characters of str to the heap. str may point into the heap
+// itself, it is located again if the heap moves.
+static uint32_t S2SC_store(S2SC *db, const char *str, size_t len) {
+    uint32_t off;
+
+    if (len == 0) return 0;
+
+    if (db->used + len + 1 > db->size) {
+        bool own = S2SC_inHeap(db, str);
+        size_t inside = (size_t)((uintptr_t)str - (uintptr_t)db->heap);
+
+        while (db->used + len + 1 > db->size) db->size *= 2;
+        db->heap = (char *)realloc(db->heap, db->size);
+        if (own) str = db->heap + inside;
+    }
+
+    off = db->used;
+    memcpy(db->heap + off, str, len);
+    db->heap[off + len] = '\0';
+    db->used += (uint32_t)len + 1;
+    return off;
+}
+
+// Offset of str in place of the string at old. A string that fits is
+// written over the old one.
+static uint32_t S2SC_replace(S2SC *db, uint32_t old, const char *str) {
+    size_t len = strlen(str);
+    size_t oldlen = strlen(db->heap + old);
+    uint32_t off;
+
+    if ((old != 0) && (len <= oldlen)) {
+        memmove(db->heap + old, str, len + 1);
+        db->garbage += (uint32_t)(oldlen - len);
+        return old;
+    }
+
+    off = S2SC_store(db, str, len);
+    S2SC_drop(db, old);
+    return off;
+}
+
+static void S2SC_drop(S2SC *db, uint32_t off) {
+    if (off != 0) db->garbage += (uint32_t)strlen(db->heap + off) + 1;
+}
+
+// Rebuild the heap from the elements once it is mostly garbage
+static void S2SC_compact(S2SC *db) {
+    char *old = db->heap;
+    S2SC_entry *e;
+
+    if ((db->garbage < S2SC_HEAP) || (db->garbage * 2 < db->used)) return;
+
+    db->size = S2SC_HEAP;
+    while (db->size < db->used - db->garbage) db->size *= 2;
+    db->heap = (char *)malloc(db->size);
+    db->heap[0] = '\0';
+    db->used = 1;
+    db->garbage = 0;
+
+    for (int i = 0; i < db->len; i++) {
+        e = &db->entries[i];
+        e->key = S2SC_store(db, old + e->key, strlen(old + e->key));
+        e->value = S2SC_store(db, old + e->value, strlen(old + e->value));
+    }
+    free(old);
+}
+
+static void S2SC_reserve(S2SC *db, int capacity) {
+    if (capacity <= db->capacity) return;
+
+    if (capacity < db->capacity * 2) capacity = db->capacity * 2;
+    if (capacity < 8) capacity = 8;
+    db->entries = (S2SC_entry *)realloc(db->entries, capacity * sizeof(S2SC_entry));
+    db->capacity = capacity;
+}
+
+S2SC *S2SC_new(int size) {
+    S2SC *db = (S2SC *)calloc(1, sizeof(S2SC));
+
+    S2SC_reserve(db, Max(size, 1));
+    memset(db->entries, 0, size * sizeof(S2SC_entry));
+    db->len = size;
+
+    db->size = S2SC_HEAP;
+    db->heap = (char *)malloc(db->size);
+    db->heap[0] = '\0';
+    db->used = 1;
+
+    for (int i = 0; i < size; i++) db->entries[i].hash = S2SC_hash("");
+
+    return db;
+}
+
+S2SC *S2SC_fromS2S(S2S *db) {
+    int len = S2S_len(db);
+    S2SC *dst = S2SC_new(len);
+    S2SC_entry *e;
+    int n = 0;
+
+    // Removed elements are left out
+    for (int i = 0; i < len; i++) {
+        if (S2S_isRemoved(db, i)) continue;
+
+        e = &dst->entries[n++];
+        e->key = S2SC_store(dst, db[i].key, strnlen(db[i].key, S2S_STRLEN));
+        e->value = S2SC_store(dst, db[i].value, strnlen(db[i].value, S2S_STRLEN));
+        e->hash = S2SC_hash(dst->heap + e->key);
+    }
+    dst->len = n;
+    return dst;
+}
+
+S2SC *S2SC_copy(S2SC *db) {
+    S2SC *dst = S2SC_new(db->len);
+
+    for (int i = 0; i < db->len; i++) {
+        S2SC_setKeyValue(dst, i, S2SC_key(db, i), S2SC_value(db, i));
+    }
+    return dst;
+}
+
+void S2SC_free(S2SC *db) {
+    if (db == NULL) return;
+
+    free(db->entries);
+    free(db->heap);
+    free(db);
+}
+
+int S2SC_findKey(S2SC *db, const char *key) {
+    uint32_t h = S2SC_hash(key);
+
+    for (int i = 0; i < db->len; i++) {
+        if ((db->entries[i].hash == h) && !strcmp(db->heap + db->entries[i].key, key)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int S2SC_findValue(S2SC *db, const char *value) {
+    for (int i = 0; i < db->len; i++) {
+        if (!strcmp(db->heap + db->entries[i].value, value)) return i;
+    }
+    return -1;
+}
+
+const char *S2SC_getValue(S2SC *db, const char *key) {
+    int idx = S2SC_findKey(db, key);
+
+    if (idx != -1) {
+        return db->heap + db->entries[idx].value;
+    } else {
+        return NULL;
+    }
+}
+
+void S2SC_setValue(S2SC *db, const char *key, const char *value) {
+    int idx = S2SC_findKey(db, key);
+
+    if (idx != -1) {
+        db->entries[idx].value = S2SC_replace(db, db->entries[idx].value, value);
+        S2SC_compact(db);
+    }
+}
+
+void S2SC_setKeyValue(S2SC *db, int idx, const char *key, const char *value) {
+    char *tmp = NULL;
+    S2SC_entry *e;
+
+    if ((idx < 0) || (idx >= db->len)) return;
+
+    // Setting the key may move or overwrite a value taken from the heap
+    if (S2SC_inHeap(db, value)) value = tmp = strdup(value);
+
+    e = &db->entries[idx];
+    e->key = S2SC_replace(db, e->key, key);
+    e->value = S2SC_replace(db, e->value, value);
+    e->hash = S2SC_hash(db->heap + e->key);
+    S2SC_compact(db);
+    free(tmp);
+}
+
+int S2SC_append(S2SC *db, const char *key, const char *value) {
+    S2SC_entry *e;
+
+    S2SC_reserve(db, db->len + 1);
+    e = &db->entries[db->len];
+    e->key = 0;
+    e->value = 0;
+    db->len++;
+
+    S2SC_setKeyValue(db, db->len - 1, key, value);
+    return db->len - 1;
+}
+
+void S2SC_remove(S2SC *db, int idx) {
+    if ((idx < 0) || (idx >= db->len)) return;
+
+    S2SC_drop(db, db->entries[idx].key);
+    S2SC_drop(db, db->entries[idx].value);
+    memmove(&db->entries[idx], &db->entries[idx + 1], (db->len - idx - 1) * sizeof(S2SC_entry));
+    db->len--;
+    S2SC_compact(db);
+}
+
+const char *S2SC_key(S2SC *db, int idx) {
+    if ((idx < 0) || (idx >= db->len)) return NULL;
+    return db->heap + db->entries[idx].key;
+}
+
+const char *S2SC_value(S2SC *db, int idx) {
+    if ((idx < 0) || (idx >= db->len)) return NULL;
+    return db->heap + db->entries[idx].value;
+}
+
+int S2SC_first(S2SC *db) {
+    UNUSED(db);
+    return 0;
+}
+
+int S2SC_last(S2SC *db) {
+    return db->len - 1;
+}
+
+int S2SC_len(S2SC *db) {
+    return db->len;
+}
+
+size_t S2SC_size(S2SC *db) {
+    return sizeof(S2SC) + (size_t)db->capacity * sizeof(S2SC_entry) + db->size;
+}
+
+void S2SC_printDb(S2SC *db) {
+    for (int i = 0; i < db->len; i++) {
+        printf("%20s   %s\n", S2SC_key(db, i), S2SC_value(db, i));
+    }
+}
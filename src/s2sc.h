@@ -0,0 +1,217 @@
+/**
+ *---------------------------------------------------------------------------
+ * @brief    Compact string 2 string associative array.
+ *
+ * @file     s2sc.h
+ * @author   Peter Malmberg <peter.malmberg@gmail.com>
+ * @version  0.01
+ * @date     2026-10-18
+ * @license  MIT
+ *
+ *---------------------------------------------------------------------------
+ *
+ * Same operations as S2S, but keys and values are kept in one shared
+ * string heap and an element holds their offsets. An element is 12
+ * bytes instead of the 64 of an S2S element and strings are not cut at
+ * S2S_STRLEN. Each element also carries a hash of its key, so a key scan
+ * reads the heap only for elements whose hash matches.
+ *
+ * Strings replaced or removed leave garbage in the heap, it is reclaimed
+ * by rebuilding the heap once it is more than half garbage. Strings
+ * returned by S2SC_getValue(), S2SC_key() and S2SC_value() point into
+ * the heap and stay valid until the table is changed.
+ */
+
+#ifndef S2SC_H
+#define S2SC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Includes ---------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "s2s.h"
+
+// Macros -----------------------------------------------------------------
+
+#define S2SC_HEAP 256  // Smallest heap size in bytes
+
+// Typedefs ---------------------------------------------------------------
+
+typedef struct {
+    uint32_t hash;   // Hash of key
+    uint32_t key;    // Offset of key in heap
+    uint32_t value;  // Offset of value in heap
+} S2SC_entry;
+
+typedef struct {
+    S2SC_entry *entries;
+    int len;            // nr of elements
+    int capacity;       // nr of elements entries has room for
+    char *heap;         // Null terminated keys and values, "" at offset 0
+    uint32_t used;      // Bytes of heap in use, garbage included
+    uint32_t size;      // Bytes allocated for heap
+    uint32_t garbage;   // Bytes of strings no longer referenced
+} S2SC;
+
+// Prototypes -------------------------------------------------------------
+
+/**
+ * Create new database.
+ *
+ * @param size nr of elements of new db, all with empty key and value
+ * @return pointer to db
+ */
+S2SC *S2SC_new(int size);
+
+/**
+ * Create compact copy of a S2S database.
+ *
+ * @param db database to copy
+ * @return pointer to new db
+ */
+S2SC *S2SC_fromS2S(S2S *db);
+
+/**
+ * Copy database, the copy has no garbage.
+ *
+ * @param db database to copy
+ * @return pointer to new db
+ */
+S2SC *S2SC_copy(S2SC *db);
+
+/**
+ * Deallocate database.
+ *
+ * @param db database to deallocate
+ */
+void S2SC_free(S2SC *db);
+
+/**
+ * Find index of key in database.
+ *
+ * @param db database to search
+ * @param key the key to be found in database
+ * @return -1 if key not found, >=0 index in db
+ */
+int S2SC_findKey(S2SC *db, const char *key);
+
+/**
+ * Find index of value in database.
+ *
+ * @param db database to search
+ * @param value value to be found in database
+ * @return -1 if value not found, >=0 index in db
+ */
+int S2SC_findValue(S2SC *db, const char *value);
+
+/**
+ * Get the value to corresponding key.
+ *
+ * @param db database to search
+ * @param key key to find
+ * @return value, NULL if key not found
+ */
+const char *S2SC_getValue(S2SC *db, const char *key);
+
+/**
+ * Set value to corresponding key in database.
+ *
+ * @param db database to set value in
+ * @param key the key whos value to be set
+ * @param value new value
+ */
+void S2SC_setValue(S2SC *db, const char *key, const char *value);
+
+/**
+ * Set key and value of element.
+ *
+ * @param db database to set key/value in
+ * @param idx index in db to be set
+ * @param key new key
+ * @param value new value
+ */
+void S2SC_setKeyValue(S2SC *db, int idx, const char *key, const char *value);
+
+/**
+ * Append element.
+ *
+ * @param db database to append to
+ * @param key new key
+ * @param value new value
+ * @return index of new element
+ */
+int S2SC_append(S2SC *db, const char *key, const char *value);
+
+/**
+ * Remove element, later elements move down one index.
+ *
+ * @param db database to remove from
+ * @param idx index of element to remove
+ */
+void S2SC_remove(S2SC *db, int idx);
+
+/**
+ * Key of element.
+ *
+ * @param db database
+ * @param idx index of element
+ * @return key, NULL if idx is out of range
+ */
+const char *S2SC_key(S2SC *db, int idx);
+
+/**
+ * Value of element.
+ *
+ * @param db database
+ * @param idx index of element
+ * @return value, NULL if idx is out of range
+ */
+const char *S2SC_value(S2SC *db, int idx);
+
+/**
+ * First element in database.
+ *
+ * @param db database to be questioned
+ * @return index of first element in db
+ */
+int S2SC_first(S2SC *db);
+
+/**
+ * Last element in database.
+ *
+ * @param db database to be questioned
+ * @return index to last element in db, -1 if empty
+ */
+int S2SC_last(S2SC *db);
+
+/**
+ * Length of database.
+ *
+ * @param db database to be questioned
+ * @return nr of elements in db
+ */
+int S2SC_len(S2SC *db);
+
+/**
+ * Memory held by database.
+ *
+ * @param db database to be questioned
+ * @return bytes allocated for elements and heap
+ */
+size_t S2SC_size(S2SC *db);
+
+/**
+ * Print database
+ * @param db database to be printed
+ */
+void S2SC_printDb(S2SC *db);
+
+#ifdef __cplusplus
+} //end brace for extern "C"
+#endif
+#endif